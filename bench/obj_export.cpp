@@ -0,0 +1,227 @@
+#include <aecl/scene/obj/export.hpp>
+#include <aecl/sink.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "../src/io/text_buffer.hpp"
+
+using namespace aecl::scene;
+
+// Counts the bytes instead of storing them, so only formatting is timed
+class CountingSink final : public aecl::ISink
+{
+public:
+    size_t size = 0;
+
+    bool write(const void *, size_t bytes) override
+    {
+        size += bytes;
+        return true;
+    }
+};
+
+// Grid of quads in the XZ plane with shared corners
+static umbf::Object create_grid(u32 cells)
+{
+    umbf::Object object;
+    object.name = "grid";
+    auto mesh = acul::make_shared<umbf::mesh::Mesh>();
+    auto &model = mesh->model;
+    const u32 side = cells + 1;
+    model.vertices.resize(side * side);
+    for (u32 z = 0; z < side; ++z)
+        for (u32 x = 0; x < side; ++x)
+        {
+            f32 u = static_cast<f32>(x) / cells, v = static_cast<f32>(z) / cells;
+            model.vertices[z * side + x] = {{u * 100.0f, 0.0f, v * 100.0f}, {u, v}, {0, 1, 0}};
+        }
+    model.faces.resize(cells * cells);
+    model.indices.reserve(cells * cells * 6);
+    for (u32 z = 0; z < cells; ++z)
+        for (u32 x = 0; x < cells; ++x)
+        {
+            const u32 a = z * side + x, b = a + 1, c = a + side + 1, d = a + side;
+            auto &face = model.faces[z * cells + x];
+            face.vertices = {{a, a}, {b, b}, {c, c}, {d, d}};
+            face.normal = {0, 1, 0};
+            face.first_vertex = static_cast<u32>(model.indices.size());
+            face.count = 6;
+            model.indices.insert(model.indices.end(), {a, b, c, a, c, d});
+        }
+    model.group_count = side * side;
+    model.aabb = {{0, 0, 0}, {100, 0, 100}};
+    object.meta.push_back(mesh);
+    return object;
+}
+
+// Upper bound of the size of one " v/vt/vn" face reference
+constexpr size_t max_face_ref_size = 34;
+
+using aecl::io::TextBuffer;
+using aecl::io::write_uint;
+
+// Face reference with the flags tested on every call, as the exporter wrote them before its kernels
+static char *write_face_ref(char *it, u32 pos, u32 id, MeshExportFlags flags)
+{
+    *it++ = ' ';
+    it = write_uint(it, pos + 1);
+    if (flags & MeshExportFlagBits::export_uv)
+    {
+        *it++ = '/';
+        it = write_uint(it, id + 1);
+    }
+    if (flags & MeshExportFlagBits::export_normals)
+    {
+        if (!(flags & MeshExportFlagBits::export_uv)) *it++ = '/';
+        *it++ = '/';
+        it = write_uint(it, id + 1);
+    }
+    return it;
+}
+
+// Face reference with the flags resolved at compile time, as in the exporter kernels
+template <bool uv, bool normals>
+static char *write_face_ref(char *it, u32 pos, u32 id)
+{
+    *it++ = ' ';
+    it = write_uint(it, pos + 1);
+    if constexpr (uv)
+    {
+        *it++ = '/';
+        it = write_uint(it, id + 1);
+    }
+    if constexpr (normals)
+    {
+        if constexpr (!uv) *it++ = '/';
+        *it++ = '/';
+        it = write_uint(it, id + 1);
+    }
+    return it;
+}
+
+/**
+ * Writes the polygon face lines of a model. WriteRef formats one reference. The vt/vn indices are the vertex
+ * indices: both variants share everything but the reference formatting.
+ **/
+template <typename WriteRef>
+static void write_faces(const umbf::mesh::Model &m, bool flip, TextBuffer &block, WriteRef &&write_ref)
+{
+    for (auto &face : m.faces)
+    {
+        auto &refs = face.vertices;
+        const size_t count = refs.size();
+        char *dst = block.ensure(count * max_face_ref_size + 2);
+        char *it = dst;
+        *it++ = 'f';
+        for (size_t v = 0; v < count; ++v)
+        {
+            auto &ref = refs[flip ? count - 1 - v : v];
+            it = write_ref(it, ref.group, ref.vertex);
+        }
+        *it++ = '\n';
+        block.commit(it - dst);
+    }
+}
+
+template <bool uv, bool normals>
+static void write_faces_specialized(const umbf::mesh::Model &m, bool flip, TextBuffer &block)
+{
+    write_faces(m, flip, block, [](char *it, u32 pos, u32 id) { return write_face_ref<uv, normals>(it, pos, id); });
+}
+
+static void write_faces_specialized(const umbf::mesh::Model &m, MeshExportFlags flags, bool flip, TextBuffer &block)
+{
+    const bool uv = flags & MeshExportFlagBits::export_uv, normals = flags & MeshExportFlagBits::export_normals;
+    if (uv && normals) write_faces_specialized<true, true>(m, flip, block);
+    else if (uv) write_faces_specialized<true, false>(m, flip, block);
+    else if (normals) write_faces_specialized<false, true>(m, flip, block);
+    else write_faces_specialized<false, false>(m, flip, block);
+}
+
+// Best of several runs formatting the faces of the grid on one thread, in milliseconds
+static double time_faces(const umbf::Object &grid, MeshExportFlags flags, bool specialize, int runs,
+                         std::string &text)
+{
+    auto &model = static_cast<const umbf::mesh::Mesh &>(*grid.meta.front()).model;
+    const bool flip = flags & MeshExportFlagBits::transform_reverse_x;
+    double best = 0;
+    for (int r = 0; r < runs; ++r)
+    {
+        TextBuffer block;
+        auto start = std::chrono::steady_clock::now();
+        if (specialize) write_faces_specialized(model, flags, flip, block);
+        else
+            write_faces(model, flip, block,
+                        [flags](char *it, u32 pos, u32 id) { return write_face_ref(it, pos, id, flags); });
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = r == 0 ? ms : std::min(best, ms);
+        text.assign(block.data(), block.size());
+    }
+    return best;
+}
+
+// Best of several exports, in milliseconds
+static double time_export(const umbf::Object &grid, MeshExportFlags flags, int runs, size_t &size)
+{
+    double best = 0;
+    for (int r = 0; r < runs; ++r)
+    {
+        obj::Exporter exporter("bench.obj");
+        exporter.material_flags = MaterialExportFlags::none;
+        exporter.mesh_flags = flags;
+        exporter.objects.push_back(grid);
+        CountingSink sink;
+        auto start = std::chrono::steady_clock::now();
+        if (!exporter.save(sink).success())
+        {
+            fprintf(stderr, "Export failed: %s\n", exporter.error().c_str());
+            exit(EXIT_FAILURE);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = r == 0 ? ms : std::min(best, ms);
+        size = sink.size;
+    }
+    return best;
+}
+
+int main(int argc, char **argv)
+{
+    const u32 cells = argc > 1 ? static_cast<u32>(atoi(argv[1])) : 1000;
+    const int runs = argc > 2 ? atoi(argv[2]) : 5;
+    auto grid = create_grid(cells);
+    printf("OBJ face kernels, %u faces, best of %d runs\n", cells * cells, runs);
+    printf("Face lines formatted on one thread with runtime flag tests and with specialized references,\n"
+           "then the whole export through the exporter on all threads\n");
+    printf("%-24s %12s %12s %8s %12s %10s\n", "flags", "generic ms", "special ms", "speedup", "export ms", "MiB");
+
+    struct Case
+    {
+        const char *name;
+        u32 flags;
+    };
+    const Case cases[] = {
+        {"positions", MeshExportFlagBits::none},
+        {"uv+normals", MeshExportFlagBits::export_uv | MeshExportFlagBits::export_normals},
+        {"uv+normals mirrored", MeshExportFlagBits::export_uv | MeshExportFlagBits::export_normals |
+                                    MeshExportFlagBits::transform_reverse_x},
+        {"uv", MeshExportFlagBits::export_uv}};
+    for (auto &c : cases)
+    {
+        MeshExportFlags flags(c.flags);
+        std::string generic_text, special_text;
+        double generic = time_faces(grid, flags, false, runs, generic_text);
+        double special = time_faces(grid, flags, true, runs, special_text);
+        if (generic_text != special_text)
+        {
+            fprintf(stderr, "%s: the face lines differ\n", c.name);
+            return EXIT_FAILURE;
+        }
+        size_t export_size = 0;
+        double whole = time_export(grid, flags, runs, export_size);
+        printf("%-24s %12.2f %12.2f %7.2fx %12.2f %10.1f\n", c.name, generic, special, generic / special, whole,
+               export_size / (1024.0 * 1024.0));
+    }
+    return EXIT_SUCCESS;
+}
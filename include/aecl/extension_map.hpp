@@ -0,0 +1,86 @@
+#pragma once
+
+#include <acul/scalars.hpp>
+#include <acul/string/string_view.hpp>
+
+namespace aecl
+{
+    constexpr char to_lower_ascii(char c) { return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c; }
+
+    // Case-insensitive comparison of two file extensions
+    constexpr bool equal_extension(acul::string_view lhs, acul::string_view rhs)
+    {
+        if (lhs.size() != rhs.size()) return false;
+        for (size_t i = 0; i < lhs.size(); ++i)
+            if (to_lower_ascii(lhs[i]) != to_lower_ascii(rhs[i])) return false;
+        return true;
+    }
+
+    // Seeded FNV-1a hash of the lower case extension
+    constexpr u32 hash_extension(acul::string_view extension, u32 seed)
+    {
+        u32 hash = 2166136261u ^ (seed * 0x9E3779B9u);
+        for (size_t i = 0; i < extension.size(); ++i)
+            hash = (hash ^ static_cast<u8>(to_lower_ascii(extension[i]))) * 16777619u;
+        return hash ^ (hash >> 15);
+    }
+
+    template <typename T>
+    struct ExtensionEntry
+    {
+        acul::string_view extension; // With the leading dot
+        T value;
+    };
+
+    /**
+     * @brief Compile-time perfect hash map from file extensions to values
+     *
+     * The constructor searches for a hash seed that puts every key into its own slot, so a lookup hashes the
+     * extension once and compares it against a single key. Extensions are matched case-insensitively.
+     * Built as a constexpr object the search runs entirely at compile time.
+     **/
+    template <typename T, size_t N, size_t Slots = 128>
+    class ExtensionMap
+    {
+        static_assert((Slots & (Slots - 1)) == 0, "Slots must be a power of two");
+        static_assert(Slots >= N * 4, "Too few slots for the seed search to converge quickly");
+
+    public:
+        constexpr ExtensionMap(const ExtensionEntry<T> (&entries)[N])
+        {
+            for (u32 seed = 0;; ++seed)
+                if (try_seed(entries, seed))
+                {
+                    _seed = seed;
+                    return;
+                }
+        }
+
+        // Get the value of the extension or fallback if it is not in the map
+        constexpr T find(acul::string_view extension, T fallback) const
+        {
+            const size_t slot = hash_extension(extension, _seed) & (Slots - 1);
+            return _used[slot] && equal_extension(_keys[slot], extension) ? _values[slot] : fallback;
+        }
+
+    private:
+        acul::string_view _keys[Slots]{};
+        T _values[Slots]{};
+        bool _used[Slots]{};
+        u32 _seed = 0;
+
+        constexpr bool try_seed(const ExtensionEntry<T> (&entries)[N], u32 seed)
+        {
+            for (size_t i = 0; i < Slots; ++i) _used[i] = false;
+            for (size_t i = 0; i < N; ++i)
+            {
+                const size_t slot = hash_extension(entries[i].extension, seed) & (Slots - 1);
+                if (_used[slot]) return false;
+                _used[slot] = true;
+                _keys[slot] = entries[i].extension;
+                _values[slot] = entries[i].value;
+            }
+            return true;
+        }
+    };
+} // namespace aecl
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <aecl/symbol_export.h>
+#include "view.hpp"
+
+namespace aecl::image
+{
+    /**
+     * @brief Convert the pixels of an image to another channel format and channel count.
+     *
+     * Unsigned values are normalized to [0, 1] and float values are clamped to [0, 1] when written to an
+     * unsigned format. Destination channels are matched to the source by name (R, G, B, A), a single luminance
+     * channel is expanded to RGB and a missing alpha channel is filled as opaque, so BGRA is swizzled to RGBA.
+     * Channels without a known name keep their position when the channel counts are equal. Rows are converted in
+     * parallel with AVX2/F16C kernels when the CPU supports them.
+     *
+     * @return Tightly packed pixel buffer allocated with acul::mem_allocator<std::byte>, owned by the caller
+     **/
+    AECL_EXPORT void *convert_image(const ImageView &image, ::umbf::ImageFormat dst_format, size_t dst_channels);
+
+    // Whether convert_image would reorder, drop or fill channels, as for BGRA written as RGBA
+    AECL_EXPORT bool needs_channel_remap(const ImageView &image, size_t dst_channels);
+} // namespace aecl::image
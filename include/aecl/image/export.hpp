@@ -1,15 +1,20 @@
 #pragma once
 
+#include <aecl/sink.hpp>
 #include <aecl/symbol_export.h>
 #include <umbf/umbf.hpp>
 #include "format.hpp"
+#include "view.hpp"
 
 namespace aecl::image
 {
+    // Export parameters reference the exported images through views, the pixels are not copied
     struct OIIOParams
     {
         Format format;
         acul::string error;
+        // If set, the encoded image is written here and the path only selects the file format
+        ISink *sink = nullptr;
         OIIOParams(Format format) : format(format) {}
     };
 
@@ -17,11 +22,11 @@ namespace aecl::image
     {
         struct Params : OIIOParams
         {
-            umbf::Image2D image;
+            ImageView image;
             f32 dpi;
             bool dither;
 
-            Params(const umbf::Image2D &image, f32 dpi = 72.0f, bool dither = false)
+            Params(const ImageView &image, f32 dpi = 72.0f, bool dither = false)
                 : OIIOParams(
                       {FormatFlagBits::bit8 | FormatFlagBits::alpha,
                        {umbf::ImageFormat::Type::uint, umbf::ImageFormat::Type::none, umbf::ImageFormat::Type::none}}),
@@ -39,12 +44,12 @@ namespace aecl::image
     {
         struct Params : OIIOParams
         {
-            acul::vector<umbf::Image2D> images;
+            acul::vector<ImageView> images;
             bool interlacing;
             int loops;
             int fps;
 
-            Params(const acul::vector<umbf::Image2D> &images, bool interlacing = false, int loops = 0, int fps = 0)
+            Params(const acul::vector<ImageView> &images, bool interlacing = false, int loops = 0, int fps = 0)
                 : OIIOParams(
                       {FormatFlagBits::bit8 | FormatFlagBits::multilayer,
                        {umbf::ImageFormat::Type::uint, umbf::ImageFormat::Type::none, umbf::ImageFormat::Type::none}}),
@@ -63,9 +68,9 @@ namespace aecl::image
     {
         struct Params : OIIOParams
         {
-            umbf::Image2D image;
+            ImageView image;
 
-            Params(const umbf::Image2D &image)
+            Params(const ImageView &image)
                 : OIIOParams({FormatFlagBits::bit32,
                               {umbf::ImageFormat::Type::none, umbf::ImageFormat::Type::none,
                                umbf::ImageFormat::Type::sfloat}}),
@@ -81,10 +86,10 @@ namespace aecl::image
     {
         struct Params : OIIOParams
         {
-            umbf::Image2D image;
+            ImageView image;
             int compression; // Quality can be 1-100, with 100 meaning lossless
 
-            Params(const umbf::Image2D &image, int compression = 100)
+            Params(const ImageView &image, int compression = 100)
                 : OIIOParams(
                       {FormatFlagBits::bit8 | FormatFlagBits::alpha | FormatFlagBits::multilayer,
                        {umbf::ImageFormat::Type::uint, umbf::ImageFormat::Type::none, umbf::ImageFormat::Type::none}}),
@@ -101,14 +106,14 @@ namespace aecl::image
     {
         struct Params : OIIOParams
         {
-            umbf::Image2D image;
+            ImageView image;
             f32 dpi;
             bool dither;
             bool progressive;
             int compression;
             acul::string app_name;
 
-            Params(const umbf::Image2D &image, f32 dpi = 72.0f, bool dither = false, bool progressive = false,
+            Params(const ImageView &image, f32 dpi = 72.0f, bool dither = false, bool progressive = false,
                    int compression = 100, const acul::string &app_name = {})
                 : OIIOParams(
                       {FormatFlagBits::bit8,
@@ -130,7 +135,7 @@ namespace aecl::image
     {
         struct Params : OIIOParams
         {
-            const acul::vector<umbf::Image2D> &images;
+            acul::vector<ImageView> images;
             /*
              * The image comression. Can be the one of:
              * "none", "rle", "zip", "zips", "piz", "pxr24", "b44", "b44a",
@@ -144,7 +149,7 @@ namespace aecl::image
              */
             acul::string compression;
 
-            Params(const acul::vector<umbf::Image2D> &images, const acul::string &compression = "none")
+            Params(const acul::vector<ImageView> &images, const acul::string &compression = "none")
                 : OIIOParams({FormatFlagBits::bit16 | FormatFlagBits::bit32 | FormatFlagBits::alpha |
                                   FormatFlagBits::multilayer,
                               {umbf::ImageFormat::Type::none, umbf::ImageFormat::Type::sfloat,
@@ -161,7 +166,7 @@ namespace aecl::image
     {
         struct Params : OIIOParams
         {
-            umbf::Image2D image;
+            ImageView image;
             f32 dpi;
             bool dither;
             /*   Compression level for zip/deflate compression,
@@ -177,7 +182,7 @@ namespace aecl::image
             int filter;
             bool unassociated_alpha;
 
-            Params(const umbf::Image2D &image, f32 dpi = 72.0f, bool dither = false, int compression = 6,
+            Params(const ImageView &image, f32 dpi = 72.0f, bool dither = false, int compression = 6,
                    int filter = 0, bool unassociated_alpha = false)
                 : OIIOParams(
                       {FormatFlagBits::bit8 | FormatFlagBits::bit16 | FormatFlagBits::alpha,
@@ -199,11 +204,11 @@ namespace aecl::image
     {
         struct Params : OIIOParams
         {
-            umbf::Image2D image;
+            ImageView image;
             bool binary;
             bool dither;
 
-            Params(const umbf::Image2D &image, bool binary = false, bool dither = false)
+            Params(const ImageView &image, bool binary = false, bool dither = false)
                 : OIIOParams(
                       {FormatFlagBits::bit8,
                        {umbf::ImageFormat::Type::uint, umbf::ImageFormat::Type::none, umbf::ImageFormat::Type::none}}),
@@ -221,7 +226,7 @@ namespace aecl::image
     {
         struct Params : OIIOParams
         {
-            umbf::Image2D image;
+            ImageView image;
             bool dither;
             // Compression level for the exporting image.
             // Values of none and rle are supported. The default is RLE.
@@ -231,7 +236,7 @@ namespace aecl::image
             // unassociated alpha; 4 = useful associated alpha / premultiplied color).
             int alpha_type;
 
-            Params(const umbf::Image2D &image, bool dither = false, const acul::string &compression = "rle",
+            Params(const ImageView &image, bool dither = false, const acul::string &compression = "rle",
                    const acul::string &app_name = {}, int alpha_type = 4)
                 : OIIOParams(
                       {FormatFlagBits::bit8 | FormatFlagBits::bit16 | FormatFlagBits::alpha | FormatFlagBits::read_only,
@@ -252,7 +257,7 @@ namespace aecl::image
     {
         struct Params : OIIOParams
         {
-            acul::vector<umbf::Image2D> images;
+            acul::vector<ImageView> images;
             bool unassociated_alpha;
             bool dither;
             /* An integer representing the quality level for ZIP compression.
@@ -269,7 +274,7 @@ namespace aecl::image
             // A string representing the compression algorithm to be used for the exported image.
             acul::string compression;
 
-            Params(const acul::vector<umbf::Image2D> &images, bool unassociated_alpha = false, bool dither = false,
+            Params(const acul::vector<ImageView> &images, bool unassociated_alpha = false, bool dither = false,
                    int zipquality = 6, bool force_big_tiff = false, const acul::string &app_name = {}, f32 dpi = 72.0f,
                    const acul::string &compression = "none")
                 : OIIOParams({FormatFlagBits::bit8 | FormatFlagBits::bit16 | FormatFlagBits::bit32 |
@@ -294,10 +299,10 @@ namespace aecl::image
     {
         struct Params : OIIOParams
         {
-            umbf::Image2D image;
+            ImageView image;
             bool dither;
 
-            Params(const umbf::Image2D &image, bool dither = false)
+            Params(const ImageView &image, bool dither = false)
                 : OIIOParams(
                       {FormatFlagBits::bit8 | FormatFlagBits::alpha,
                        {umbf::ImageFormat::Type::uint, umbf::ImageFormat::Type::none, umbf::ImageFormat::Type::none}}),
@@ -314,7 +319,7 @@ namespace aecl::image
     {
         struct Params
         {
-            ::umbf::Image2D image;
+            ImageView image;
             int compression = 5;
             u32 checksum;
         };
@@ -322,9 +327,8 @@ namespace aecl::image
         AECL_EXPORT bool save(const acul::string &path, Params &up);
     } // namespace umbf
 
-    inline bool is_image_equals(const ::umbf::Image2D &image, ::umbf::ImageFormat dst_format, size_t dst_channels)
+    inline bool is_image_equals(const ImageView &image, ::umbf::ImageFormat dst_format, size_t dst_channels)
     {
-        if (image.channels.size() < dst_channels) return false;
-        return dst_format == image.format;
+        return image.channel_count == dst_channels && dst_format == image.format;
     }
 } // namespace aecl::image
\ No newline at end of file
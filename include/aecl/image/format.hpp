@@ -4,6 +4,7 @@
 #include <acul/enum.hpp>
 #include <acul/scalars.hpp>
 #include <acul/string/string_view.hpp>
+#include <aecl/extension_map.hpp>
 #include "umbf/umbf.hpp"
 
 namespace aecl
@@ -80,20 +81,23 @@ namespace aecl
             umbf
         };
 
+        inline constexpr ExtensionEntry<Type> builtin_extensions[] = {
+            {".bmp", Type::bmp},     {".gif", Type::gif},   {".hdr", Type::hdr},   {".heif", Type::heif},
+            {".heic", Type::heif},   {".avif", Type::heif}, {".jpg", Type::jpeg},  {".jpe", Type::jpeg},
+            {".jpeg", Type::jpeg},   {".jif", Type::jpeg},  {".jfif", Type::jpeg}, {".jfi", Type::jpeg},
+            {".exr", Type::openexr}, {".png", Type::png},   {".pbm", Type::pbm},   {".pgm", Type::pbm},
+            {".ppm", Type::pbm},     {".pnm", Type::pbm},   {".tga", Type::targa}, {".tpic", Type::targa},
+            {".tif", Type::tiff},    {".tiff", Type::tiff}, {".webp", Type::webp}, {".umia", Type::umbf},
+            {".umbf", Type::umbf}};
+
+        inline constexpr ExtensionMap builtin_extension_map(builtin_extensions);
+
+        // Get the built-in image type of a file extension (case-insensitive, with the leading dot)
         constexpr Type get_type_by_extension(acul::string_view extension)
         {
-            constexpr std::array<acul::pair<acul::string_view, Type>, 25> extension_map = {
-                {{".bmp", Type::bmp},     {".gif", Type::gif},   {".hdr", Type::hdr},   {".heif", Type::heif},
-                 {".heic", Type::heif},   {".avif", Type::heif}, {".jpg", Type::jpeg},  {".jpe", Type::jpeg},
-                 {".jpeg", Type::jpeg},   {".jif", Type::jpeg},  {".jfif", Type::jpeg}, {".jfi", Type::jpeg},
-                 {".exr", Type::openexr}, {".png", Type::png},   {".pbm", Type::pbm},   {".pgm", Type::pbm},
-                 {".ppm", Type::pbm},     {".pnm", Type::pbm},   {".tga", Type::targa}, {".tpic", Type::targa},
-                 {".tif", Type::tiff},    {".tiff", Type::tiff}, {".webp", Type::webp}, {".umia", Type::umbf},
-                 {".umbf", Type::umbf}}};
-
-            for (const auto &[ext, type] : extension_map)
-                if (ext == extension) return type;
-            return Type::unknown;
+            return builtin_extension_map.find(extension, Type::unknown);
         }
+
+        static_assert(get_type_by_extension(".JPG") == Type::jpeg && get_type_by_extension(".obj") == Type::unknown);
     } // namespace image
 } // namespace aecl
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <aecl/progress.hpp>
+#include <aecl/stats.hpp>
 #include <aecl/symbol_export.h>
 #include <umbf/umbf.hpp>
 #include "format.hpp"
@@ -28,8 +30,25 @@ namespace aecl::image
 
         const acul::string &error() const { return _error; }
 
+        // Attach optional import statistics. The stats must outlive the load calls.
+        void stats(ImportStats *stats) { _stats = stats; }
+
+        // Get the attached import statistics
+        ImportStats *stats() const { return _stats; }
+
+        /**
+         * @brief Attach an optional progress/cancellation token. The token must outlive the load calls.
+         * A cancelled load releases the images it has read so far and returns false.
+         **/
+        void progress(ProgressToken *token) { _progress = token; }
+
+        // Get the attached progress token
+        ProgressToken *progress() const { return _progress; }
+
     protected:
         acul::string _error;
+        ImportStats *_stats = nullptr;
+        ProgressToken *_progress = nullptr;
     };
 
     class OIIOLoader : public ILoader
@@ -195,5 +214,45 @@ namespace aecl::image
         u32 _checksum = 0;
     };
 
+    // Number of leading file bytes passed to Codec::sniff
+    constexpr size_t max_signature_size = 64;
+
+    /**
+     * @brief Image format entry of the codec registry
+     *
+     * The factory returns a loader allocated with acul::alloc.
+     **/
+    struct Codec
+    {
+        acul::vector<acul::string> extensions; // With the leading dot, matched case-insensitively
+
+        // Optional content check on the first max_signature_size bytes of the file
+        bool (*sniff)(const u8 *data, size_t size) = nullptr;
+        ILoader *(*create)() = nullptr;
+    };
+
+    /**
+     * @brief Register an image loader at runtime.
+     *
+     * Registered loaders take precedence over the built-in ones, and a later registration over an earlier one
+     * for the same extension. Safe to call concurrently with the lookups.
+     **/
+    AECL_EXPORT void register_importer(const Codec &codec);
+
+    /**
+     * @brief Identify a built-in image format by the leading bytes of a file.
+     * TGA and UMBF have no reliable signature and are never detected.
+     * @return The image type or Type::unknown
+     **/
+    AECL_EXPORT Type get_type_by_signature(const u8 *data, size_t size);
+
+    /**
+     * @brief Create a loader for the file.
+     *
+     * A loader registered for the extension is used as is. Otherwise the file signature takes precedence over the
+     * extension for the built-in formats, so a misnamed file still gets the right loader, and files of unknown
+     * type are offered to the sniffers of the registered loaders.
+     * @return Loader allocated with acul::alloc or nullptr if the format is not supported
+     **/
     AECL_EXPORT ILoader *get_importer_by_path(const acul::string &path);
 } // namespace aecl::image
\ No newline at end of file
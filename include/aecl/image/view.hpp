@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <umbf/umbf.hpp>
+
+namespace aecl::image
+{
+    /**
+     * @brief Non-owning view of the pixels of an image
+     *
+     * Rows are stride bytes apart, so a sub-rectangle of a larger image or a padded readback buffer can be
+     * passed without repacking it. The pixels and the channel names are referenced, not copied, and must outlive
+     * the view. Without channel names the channels are matched by position.
+     **/
+    struct ImageView
+    {
+        const void *pixels = nullptr;
+        u32 width = 0;
+        u32 height = 0;
+        size_t stride = 0; // Bytes between the starts of two rows, 0 for tightly packed rows
+        ::umbf::ImageFormat format;
+        u32 channel_count = 0;
+        const acul::string *channels = nullptr; // channel_count names or nullptr
+
+        ImageView() = default;
+
+        ImageView(const ::umbf::Image2D &image)
+            : pixels(image.pixels),
+              width(image.width),
+              height(image.height),
+              format(image.format),
+              channel_count(static_cast<u32>(image.channels.size())),
+              channels(image.channels.data())
+        {
+        }
+
+        ImageView(const void *pixels, u32 width, u32 height, ::umbf::ImageFormat format, u32 channel_count,
+                  size_t stride = 0, const acul::string *channels = nullptr)
+            : pixels(pixels),
+              width(width),
+              height(height),
+              stride(stride),
+              format(format),
+              channel_count(channel_count),
+              channels(channels)
+        {
+        }
+
+        size_t pixel_size() const { return static_cast<size_t>(channel_count) * format.bytes_per_channel; }
+
+        size_t row_size() const { return width * pixel_size(); }
+
+        size_t row_stride() const { return stride ? stride : row_size(); }
+
+        // Whether the rows follow each other without padding
+        bool packed() const { return row_stride() == row_size(); }
+
+        const std::byte *row(u32 y) const { return static_cast<const std::byte *>(pixels) + y * row_stride(); }
+
+        // Get a view of the sub-rectangle, sharing the rows of this view
+        ImageView crop(u32 x, u32 y, u32 crop_width, u32 crop_height) const
+        {
+            return ImageView(row(y) + x * pixel_size(), crop_width, crop_height, format, channel_count, row_stride(),
+                             channels);
+        }
+    };
+
+    inline acul::vector<ImageView> make_views(const acul::vector<::umbf::Image2D> &images)
+    {
+        return acul::vector<ImageView>(images.begin(), images.end());
+    }
+} // namespace aecl::image
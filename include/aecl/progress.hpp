@@ -0,0 +1,59 @@
+#pragma once
+
+#include <acul/functional/unique_function.hpp>
+#include <acul/scalars.hpp>
+#include <atomic>
+
+namespace aecl
+{
+    /**
+     * @brief Progress reporting and cooperative cancellation of a long running operation.
+     *
+     * The token is polled by the loaders at chunk granularity, so cancellation takes effect promptly
+     * but not instantly. Progress and the callback may be driven from worker threads.
+     **/
+    class ProgressToken
+    {
+    public:
+        // Called with the overall progress in [0, 1]. Must be thread-safe.
+        acul::unique_function<void(f32)> callback;
+
+        // Request cancellation of the operation
+        void cancel() { _cancelled.store(true, std::memory_order_relaxed); }
+
+        bool cancelled() const { return _cancelled.load(std::memory_order_relaxed); }
+
+        // Get the last reported progress in [0, 1]
+        f32 progress() const { return _progress.load(std::memory_order_relaxed); }
+
+        // Report the overall progress. Values below the already reported one are ignored.
+        void report(f32 value)
+        {
+            f32 current = _progress.load(std::memory_order_relaxed);
+            while (value > current)
+                if (_progress.compare_exchange_weak(current, value, std::memory_order_relaxed))
+                {
+                    if (callback) callback(value);
+                    return;
+                }
+        }
+
+        // Prepare the token for reuse
+        void reset()
+        {
+            _cancelled.store(false, std::memory_order_relaxed);
+            _progress.store(0.0f, std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<bool> _cancelled{false};
+        std::atomic<f32> _progress{0.0f};
+    };
+
+    inline bool is_cancelled(const ProgressToken *token) { return token && token->cancelled(); }
+
+    inline void report_progress(ProgressToken *token, f32 value)
+    {
+        if (token) token->report(value);
+    }
+} // namespace aecl
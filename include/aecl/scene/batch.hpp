@@ -0,0 +1,83 @@
+#pragma once
+
+#include <aecl/symbol_export.h>
+#include <oneapi/tbb/task_arena.h>
+#include "import.hpp"
+
+namespace aecl::scene
+{
+    /**
+     * @brief Import of many scene files as one job
+     *
+     * All files are scheduled on a single task arena, the largest ones first. A file smaller than small_file_size
+     * is imported whole by one task with the parallel loops of its importer running serially, so many small
+     * files do not pay the cost of splitting tiny inputs. Larger files take the chunk-parallel path of their
+     * importer and share the workers of the arena. The importer of a file is picked by get_importer_by_path.
+     *
+     * Materials and textures that are identical across the files are merged: textures by url, materials by name
+     * and content. The merged lists are shared by all files and the material ranges of the objects reference
+     * the merged materials.
+     **/
+    class BatchImporter
+    {
+    public:
+        struct Entry
+        {
+            acul::string path;
+            acul::op_result result;
+            acul::string error;
+            acul::vector<umbf::Object> objects;
+        };
+
+        // Files below this size in bytes are imported on a single task
+        u64 small_file_size = 1 << 20;
+
+        // Worker count of the arena
+        int max_concurrency = oneapi::tbb::task_arena::automatic;
+
+        AECL_EXPORT BatchImporter(const acul::vector<acul::string> &paths);
+
+        /**
+         * @brief Import all files.
+         *
+         * A failing file does not stop the others. The result is an error if any file failed, the state of
+         * every file is kept in its entry.
+         **/
+        AECL_EXPORT acul::op_result load();
+
+        // Get the per-file results in the order of the paths
+        acul::vector<Entry> &entries() { return _entries; }
+
+        // Get the merged materials of all files
+        acul::vector<acul::shared_ptr<umbf::File>> &materials() { return _materials; }
+
+        // Get the merged textures of all files
+        acul::vector<acul::shared_ptr<umbf::Target>> &textures() { return _textures; }
+
+        // Get the error of the first failed file
+        const acul::string &error() const { return _error; }
+
+        // Attach optional import statistics, summed over all files. The stats must outlive the load calls.
+        void stats(ImportStats *stats) { _stats = stats; }
+
+        // Get the attached import statistics
+        ImportStats *stats() const { return _stats; }
+
+        /**
+         * @brief Attach an optional progress/cancellation token. The token must outlive the load calls.
+         * The progress is weighted by the file sizes. Cancellation stops the running imports and skips the rest.
+         **/
+        void progress(ProgressToken *token) { _progress = token; }
+
+        // Get the attached progress token
+        ProgressToken *progress() const { return _progress; }
+
+    private:
+        acul::vector<Entry> _entries;
+        acul::vector<acul::shared_ptr<umbf::File>> _materials;
+        acul::vector<acul::shared_ptr<umbf::Target>> _textures;
+        acul::string _error;
+        ImportStats *_stats = nullptr;
+        ProgressToken *_progress = nullptr;
+    };
+} // namespace aecl::scene
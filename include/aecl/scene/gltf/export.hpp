@@ -0,0 +1,88 @@
+#pragma once
+
+#include <acul/hash/hashmap.hpp>
+#include <acul/op_result.hpp>
+#include <aecl/sink.hpp>
+#include <aecl/symbol_export.h>
+#include <oneapi/tbb/task_group.h>
+#include "../export.hpp"
+
+namespace aecl::io
+{
+    class TextBuffer;
+} // namespace aecl::io
+
+namespace aecl::scene::gltf
+{
+    /**
+     * @brief Binary glTF 2.0 (GLB) exporter
+     *
+     * Every object becomes a node with one mesh, and every material range of the object a triangle primitive.
+     * Vertex attributes and indices are stored in tightly packed buffer views of the binary chunk. Where the
+     * source layout already matches, the views are written straight from the model without a copy.
+     *
+     * The mesh is always exported triangulated, `export_triangulated` has no effect.
+     **/
+    class Exporter final : public IExporter
+    {
+    public:
+        /**
+         * Flip the V texture coordinate. glTF places the UV origin at the top left corner, while the imported
+         * models use the bottom left one. Disabling the flip lets the vertices be written without a copy when no
+         * axis transform is requested.
+         */
+        bool flip_uv = true;
+
+        /**
+         * Constructs an Exporter object with the given parameters.
+         *
+         * @param path The path to the output file.
+         */
+        Exporter(const acul::string &path) : IExporter(path) {}
+
+        /**
+         * Saves the exported scene to the output file.
+         *
+         * @return `true` if the export was successful, `false` otherwise.
+         */
+        AECL_EXPORT acul::op_result save() override;
+
+        /**
+         * Exports the scene to a sink. Copied textures are still written next to `path`.
+         *
+         * @param sink Receives the GLB data.
+         */
+        AECL_EXPORT acul::op_result save(ISink &sink);
+
+    private:
+        struct MeshSegment;
+        struct Layout;
+
+        struct MaterialEntry
+        {
+            acul::shared_ptr<umbf::MaterialInfo> info;
+            acul::shared_ptr<umbf::Material> mat;
+            i64 image = -1; // Index in _images
+        };
+
+        struct ImageRef
+        {
+            acul::string uri;
+            acul::string source; // Set if the texture is copied
+            acul::string target;
+            bool done;
+        };
+
+        acul::hashmap<u64, u32> _material_ids; // Material id to the index of the glTF material
+        acul::vector<MaterialEntry> _materials;
+        acul::vector<ImageRef> _images;
+
+        void collect_materials();
+        void copy_textures(oneapi::tbb::task_group &tasks);
+        void prepare_mesh(const umbf::Object &object, MeshSegment &segment);
+        void write_materials(io::TextBuffer &json);
+        static void write_meshes(io::TextBuffer &json, const acul::vector<MeshSegment *> &meshes,
+                                 MeshExportFlags flags);
+        acul::op_result write_scene(ISink &sink);
+    };
+} // namespace aecl::scene::gltf
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <aecl/symbol_export.h>
+#include "../import.hpp"
+
+namespace aecl::scene::gltf
+{
+    /**
+     * @brief glTF 2.0 scene importer for .gltf and .glb files
+     *
+     * The file and its external buffers are memory mapped and the accessors are decoded straight from the
+     * mapped binary data. Every node instancing a mesh becomes an object with the node world transform applied
+     * to its vertices. Primitives are decoded in parallel and the primitives of a material form a MaterialRange.
+     *
+     * Only triangle primitives are read. Textures are resolved as external images that one of the image
+     * importers can read.
+     **/
+    class Importer : public ILoader
+    {
+    public:
+        // Flip the V texture coordinate back to the bottom left origin (see gltf::Exporter::flip_uv)
+        bool flip_uv = true;
+
+        Importer(const acul::string &filename) : ILoader(filename) {};
+
+        AECL_EXPORT ~Importer();
+        AECL_EXPORT virtual acul::op_result read_source() override;
+        AECL_EXPORT virtual void build_geometry() override;
+        AECL_EXPORT virtual acul::op_result load_materials() override;
+
+    protected:
+        AECL_EXPORT virtual acul::op_result cancel() override;
+
+    private:
+        struct ImportCtx *_ctx = nullptr;
+    };
+} // namespace aecl::scene::gltf
@@ -1,6 +1,10 @@
 #pragma once
 
 #include <acul/op_result.hpp>
+#include <aecl/progress.hpp>
+#include <aecl/stats.hpp>
+#include <aecl/status.hpp>
+#include <future>
 #include <umbf/umbf.hpp>
 
 namespace aecl::scene
@@ -21,12 +25,22 @@ namespace aecl::scene
         // Load the scene includes all intermediate calls
         acul::op_result load()
         {
+            MemoryScope memory(_stats);
             auto state = read_source();
             if (!state.success()) return state;
             build_geometry();
+            if (is_cancelled(_progress)) return cancel();
             load_materials();
+            if (is_cancelled(_progress)) return cancel();
+            report_progress(_progress, 1.0f);
             return acul::make_op_success();
         }
+        // Run load() on a dedicated thread. The loader must stay alive until the future is ready.
+        std::future<acul::op_result> load_async()
+        {
+            return std::async(std::launch::async, [this] { return load(); });
+        }
+
         // Indexing geometry to UMBF format
         virtual void build_geometry() = 0;
 
@@ -54,10 +68,32 @@ namespace aecl::scene
 
         const acul::string &error() const { return _error; }
 
+        // Attach optional import statistics. The stats must outlive the load calls.
+        void stats(ImportStats *stats) { _stats = stats; }
+
+        // Get the attached import statistics
+        ImportStats *stats() const { return _stats; }
+
+        // Attach an optional progress/cancellation token. The token must outlive the load calls.
+        void progress(ProgressToken *token) { _progress = token; }
+
+        // Get the attached progress token
+        ProgressToken *progress() const { return _progress; }
+
     protected:
         acul::string _path, _error;
+        ImportStats *_stats = nullptr;
+        ProgressToken *_progress = nullptr;
         acul::vector<umbf::Object> _objects;
         acul::vector<acul::shared_ptr<umbf::File>> _materials;
         acul::vector<acul::shared_ptr<umbf::Target>> _textures;
+
+        // Drop the partial results of a cancelled import
+        virtual acul::op_result cancel()
+        {
+            clear();
+            _error = "Import cancelled";
+            return acul::op_result(ACUL_OP_READ_ERROR, AECL_OP_DOMAIN, AECL_OP_CODE_CANCELLED);
+        }
     };
 } // namespace aecl::scene
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <acul/op_result.hpp>
+#include <aecl/symbol_export.h>
+#include "../export.hpp"
+
+namespace aecl::scene::native
+{
+    /**
+     * @brief Native UMBF scene exporter
+     *
+     * The objects, materials and textures are written as a single scene block of a UMBF file. Meshes and
+     * material ranges are stored as is, so the mesh flags have no effect and an import restores the scene
+     * exactly. Textures are stored as targets referencing the image files.
+     **/
+    class Exporter final : public IExporter
+    {
+    public:
+        // Compression level of the payload, 0 to store it uncompressed
+        int compression = 5;
+        u32 checksum = 0;
+
+        /**
+         * Constructs an Exporter object with the given parameters.
+         *
+         * @param path The path to the output file.
+         */
+        Exporter(const acul::string &path) : IExporter(path) {}
+
+        /**
+         * Saves the exported scene to the output file.
+         *
+         * @return `true` if the export was successful, `false` otherwise.
+         */
+        AECL_EXPORT acul::op_result save() override;
+    };
+} // namespace aecl::scene::native
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <aecl/symbol_export.h>
+#include "../import.hpp"
+
+namespace aecl::scene::native
+{
+    /**
+     * @brief Native UMBF scene importer
+     *
+     * Loads the scene block written by native::Exporter. The objects are taken over without any indexing,
+     * relative texture targets are resolved against the directory of the file.
+     **/
+    class Importer : public ILoader
+    {
+    public:
+        Importer(const acul::string &filename) : ILoader(filename) {};
+
+        AECL_EXPORT virtual acul::op_result read_source() override;
+        AECL_EXPORT virtual void build_geometry() override;
+        AECL_EXPORT virtual acul::op_result load_materials() override;
+
+    protected:
+        AECL_EXPORT virtual acul::op_result cancel() override;
+
+    private:
+        acul::shared_ptr<umbf::Scene> _scene;
+    };
+} // namespace aecl::scene::native
@@ -2,11 +2,18 @@
 
 #include <acul/hash/hl_hashmap.hpp>
 #include <acul/op_result.hpp>
-#include <acul/string/sstream.hpp>
+#include <aecl/sink.hpp>
 #include <aecl/symbol_export.h>
 #include <oneapi/tbb/concurrent_unordered_set.h>
+#include <oneapi/tbb/task_group.h>
 #include "../export.hpp"
 
+namespace aecl::io
+{
+    class StreamWriter;
+    class TextBuffer;
+} // namespace aecl::io
+
 namespace aecl::scene::obj
 {
     // Policy for exporting objects
@@ -25,10 +32,19 @@ namespace aecl::scene::obj
 
     using ObjExportFlags = acul::flags<ObjExportFlagBits>;
 
+    // Compression of the written OBJ file
+    enum class ObjCompression
+    {
+        none,
+        gzip, // Concatenated gzip members, readable by any gzip decoder
+        zstd  // Concatenated zstd frames. Only available when built with zstd
+    };
+
     struct MaterialRef
     {
         acul::shared_ptr<umbf::MaterialInfo> info;
         acul::shared_ptr<umbf::Material> mat;
+        acul::string name; // Written to newmtl and usemtl, unique within the MTL library
     };
 
     // OBJ file exporter
@@ -36,6 +52,23 @@ namespace aecl::scene::obj
     {
     public:
         ObjExportFlags obj_flags;
+        // Drop the written pages from the OS page cache (Linux). Useful for exports larger than RAM.
+        bool drop_page_cache = false;
+        // Digits after the decimal point for v/vt/vn and MTL values. Shortest round-trip form if negative.
+        int float_precision = -1;
+        /**
+         * Compress the OBJ file. Formatted chunks are compressed in parallel as independent members, so
+         * `path` should carry the matching .gz/.zst suffix. The MTL file stays uncompressed.
+         */
+        ObjCompression compression = ObjCompression::none;
+        // Codec compression level, the codec default if negative
+        int compression_level = -1;
+        /**
+         * Write every object to its own OBJ file. The files are formatted concurrently, named after the objects
+         * and placed next to `path`. All of them reference a single MTL library named after `path`, holding
+         * every material once. Only save() honors it, the sink overload always writes a single stream.
+         */
+        bool split_objects = false;
         /**
          * Constructs an Exporter object with the given parameters.
          *
@@ -50,23 +83,76 @@ namespace aecl::scene::obj
          */
         AECL_EXPORT acul::op_result save() override;
 
+        /**
+         * Exports the scene to sinks instead of files.
+         *
+         * `path` only names the MTL library referenced by the OBJ data. Copied textures are still written next
+         * to `path`.
+         *
+         * @param obj_sink Receives the OBJ data, compressed if `compression` is set.
+         * @param mtl_sink Receives the MTL data. Not written if null.
+         */
+        AECL_EXPORT acul::op_result save(ISink &obj_sink, ISink *mtl_sink = nullptr);
+
+        // Get the files written by the last split export, in object order
+        const acul::vector<acul::string> &split_paths() const { return _split_paths; }
+
     private:
-        acul::hl_hashmap<amal::vec2, u32> _vt_map;
-        acul::hl_hashmap<amal::vec3, u32> _vn_map;
+        // Dense per-vertex indices of the deduplicated vt/vn values of an object
+        struct AttributeRemap
+        {
+            acul::vector<u32> uv;
+            acul::vector<u32> normal;
+        };
+        struct ObjectSegment;
+        using FaceKernel = void (*)(const ObjectSegment &segment, const acul::vector<u32> &faces, size_t begin,
+                                    size_t end, io::TextBuffer &buffer);
+
+        struct TextureCopy
+        {
+            acul::string source;
+            acul::string target;
+            bool done;
+        };
+
+        // Destination of the formatted text of one OBJ file
+        struct Output
+        {
+            io::StreamWriter *writer = nullptr;
+            acul::vector<char> pending; // Small sections coalesced into a single write
+            bool uses_default_material = false;
+            acul::string error;
+        };
+
+        // Read-only while the objects are written, so concurrent files share it
         acul::hashmap<u64, MaterialRef> _material_map;
+        acul::hashmap<acul::string, acul::string> _texture_refs; // Source path to the reference written to MTL
+        acul::vector<TextureCopy> _texture_copies;
+        acul::vector<acul::string> _split_paths;
         bool _all_materials_exist = true;
+        FaceKernel _face_kernel = nullptr; // Emit kernel specialized for the export flags
+
+        static void flush(Output &out, io::TextBuffer &buffer);
+        static void flush_pending(Output &out);
+        void prepare_object(const umbf::Object &object, ObjectSegment &segment);
+        void write_vertices(const ObjectSegment &segment, size_t begin, size_t end, io::TextBuffer &buffer);
+        template <bool uv, bool normals, bool flip>
+        static void write_faces(const ObjectSegment &segment, const acul::vector<u32> &faces, size_t begin,
+                                size_t end, io::TextBuffer &buffer);
+        template <bool uv, bool normals, bool flip>
+        static void write_triangles(const ObjectSegment &segment, const acul::vector<u32> &faces, size_t begin,
+                                    size_t end, io::TextBuffer &buffer);
+        static FaceKernel select_face_kernel(MeshExportFlags flags, bool flip_winding);
+        void copy_textures(oneapi::tbb::task_group &tasks);
+        void write_texture(io::TextBuffer &buffer, const acul::string &token, const acul::string &tex);
 
-        void write_vertices(umbf::mesh::Model &model, const acul::vector<umbf::mesh::VertexGroup> &groups,
-                            acul::stringstream &ss);
-        void write_faces(umbf::mesh::Mesh *meta, acul::stringstream &os, const acul::vector<u32> &faces);
-        void write_triangles(umbf::mesh::Mesh *meta, acul::stringstream &os, const acul::vector<u32> &faces,
-                             const acul::vector<umbf::mesh::VertexGroup> &groups);
-        void write_texture(acul::stringstream &os, const acul::string &token, const acul::string &tex);
-
-        void write_material(const acul::shared_ptr<umbf::MaterialInfo> &material_info,
-                            const acul::shared_ptr<umbf::Material> &material, std::ostream &os);
-        bool write_mtllib_info(std::ofstream &mtl_stream, acul::stringstream &obj_stream);
-        void write_mtl(std::ofstream &stream);
-        u32 write_object(const umbf::Object &object, acul::stringstream &stream);
+        void write_material(const MaterialRef &ref, io::TextBuffer &buffer);
+        void build_material_map();
+        bool open_mtl(std::ofstream &mtl_stream);
+        void write_mtl(io::TextBuffer &buffer);
+        u32 write_mtl_file(std::ofstream &mtl_stream, ISink *mtl_sink);
+        acul::op_result write_scene(ISink *obj_sink, ISink *mtl_sink);
+        acul::op_result write_split_scene();
+        u32 write_objects(const umbf::Object *objects, size_t count, Output &out);
     };
 } // namespace aecl::scene::obj
\ No newline at end of file
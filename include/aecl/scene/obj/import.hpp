@@ -1,12 +1,59 @@
 #pragma once
 
 #include <aecl/symbol_export.h>
+#include <limits>
 #include <oneapi/tbb/concurrent_vector.h>
 #include "../import.hpp"
 
 
 namespace aecl::scene::obj
 {
+    // Fast approximation of an OBJ scene for interactive placement
+    struct Preview
+    {
+        struct Group
+        {
+            acul::string name;
+            amal::vec3 min{std::numeric_limits<f32>::max()};
+            amal::vec3 max{std::numeric_limits<f32>::lowest()};
+        };
+
+        /**
+         * Sampled bounds of every group. Vertices belong to the group they are declared in,
+         * so a group without sampled vertices keeps an empty (inverted) box.
+         **/
+        acul::vector<Group> groups;
+        // Decimated vertex positions of the whole scene
+        acul::vector<amal::vec3> points;
+    };
+
+    /**
+     * @brief Signatures of the groups of a previous import.
+     *
+     * Attach the manifest to an importer to enable incremental import: a group whose source lines,
+     * preceding element counts and referenced data are unchanged reuses the mesh and object id of the
+     * previous import instead of being indexed again. The manifest is replaced by the one of the new import
+     * once its geometry is built, a cancelled import leaves it unchanged.
+     **/
+    struct ImportManifest
+    {
+        struct Group
+        {
+            acul::string name;
+            u64 hash = 0;               // Hash of the group source lines
+            u32 base[3] = {0, 0, 0};    // Count of v, vt and vn declared before the group
+            bool uses_preamble = false; // Faces reference data declared before the first group
+            bool reusable = false;      // Faces reference only the group itself or the preamble
+            u64 object_id = 0;
+            acul::shared_ptr<umbf::mesh::Mesh> mesh;
+        };
+
+        u64 preamble_hash = 0; // Hash of the source lines before the first group
+        bool use_normals = false; // The source has vn lines, which selects how every group is indexed
+        acul::vector<Group> groups;
+        size_t reused = 0; // Count of groups reused by the import which produced the manifest
+    };
+
     /**
      * @brief Load the scene
      * @return Read state result
@@ -21,7 +68,24 @@ namespace aecl::scene::obj
         AECL_EXPORT virtual void build_geometry() override;
         AECL_EXPORT virtual acul::op_result load_materials() override;
 
+        /**
+         * @brief Build a preview with a strided, vertex-only pass over the mapped file.
+         * Meant to be shown while load() runs in the background (see load_async()).
+         * @param preview Output preview
+         * @param max_points Approximate upper bound of the sampled points
+         **/
+        AECL_EXPORT acul::op_result load_preview(Preview &preview, size_t max_points = 1 << 16);
+
+        // Attach a manifest to enable incremental import. The manifest must outlive the load calls.
+        void manifest(ImportManifest *manifest) { _manifest = manifest; }
+
+    protected:
+        AECL_EXPORT virtual acul::op_result cancel() override;
+
     private:
-        struct ImportCtx *_ctx;
+        struct ImportCtx *_ctx = nullptr;
+        ImportManifest *_manifest = nullptr;
+
+        void match_manifest();
     };
 } // namespace aecl::scene::obj
\ No newline at end of file
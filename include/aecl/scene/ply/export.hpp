@@ -0,0 +1,61 @@
+#pragma once
+
+#include <acul/op_result.hpp>
+#include <aecl/sink.hpp>
+#include <aecl/symbol_export.h>
+#include "../export.hpp"
+
+namespace aecl::scene::ply
+{
+    enum class Format
+    {
+        ascii,
+        binary_little_endian,
+        binary_big_endian
+    };
+
+    /**
+     * @brief PLY exporter
+     *
+     * All objects are merged into one vertex and one face element. Vertex records hold the position and,
+     * depending on the mesh flags, the normal and the texture coordinate (as s/t). Objects without faces are
+     * written as points. The records of every object are formatted in parallel.
+     *
+     * Materials are not exported: PLY has no material model.
+     **/
+    class Exporter final : public IExporter
+    {
+    public:
+        Format format = Format::binary_little_endian;
+
+        // Digits after the decimal point of ASCII values. Shortest round-trip form if negative.
+        int float_precision = -1;
+
+        /**
+         * Constructs an Exporter object with the given parameters.
+         *
+         * @param path The path to the output file.
+         */
+        Exporter(const acul::string &path) : IExporter(path) {}
+
+        /**
+         * Saves the exported scene to the output file.
+         *
+         * @return `true` if the export was successful, `false` otherwise.
+         */
+        AECL_EXPORT acul::op_result save() override;
+
+        /**
+         * Exports the scene to a sink.
+         *
+         * @param sink Receives the PLY data.
+         */
+        AECL_EXPORT acul::op_result save(ISink &sink);
+
+    private:
+        struct MeshSegment;
+
+        void prepare_mesh(const umbf::Object &object, MeshSegment &segment);
+        acul::op_result write_scene(ISink &sink);
+    };
+} // namespace aecl::scene::ply
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <aecl/symbol_export.h>
+#include "../import.hpp"
+
+namespace aecl::scene::ply
+{
+    /**
+     * @brief PLY scene importer for ASCII and binary (little and big endian) files
+     *
+     * The file is memory mapped and the element records are decoded in parallel straight from the mapping.
+     * The vertex and face elements form a single object. Every PLY vertex is kept as is and forms its own
+     * vertex group. Files without faces are imported as point clouds: the model holds only vertices.
+     *
+     * Recognized vertex properties are x/y/z, nx/ny/nz and u/v (also s/t, texture_u/texture_v). Other
+     * properties such as colors are skipped, as UMBF vertices carry no color.
+     **/
+    class Importer : public ILoader
+    {
+    public:
+        Importer(const acul::string &filename) : ILoader(filename) {};
+
+        AECL_EXPORT ~Importer();
+        AECL_EXPORT virtual acul::op_result read_source() override;
+        AECL_EXPORT virtual void build_geometry() override;
+
+        // PLY carries no materials
+        virtual acul::op_result load_materials() override { return acul::make_op_success(); }
+
+    protected:
+        AECL_EXPORT virtual acul::op_result cancel() override;
+
+    private:
+        struct ImportCtx *_ctx = nullptr;
+    };
+} // namespace aecl::scene::ply
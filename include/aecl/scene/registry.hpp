@@ -0,0 +1,52 @@
+#pragma once
+
+#include <aecl/symbol_export.h>
+#include "export.hpp"
+#include "import.hpp"
+
+namespace aecl::scene
+{
+    // Number of leading file bytes passed to Codec::sniff
+    constexpr size_t max_signature_size = 256;
+
+    /**
+     * @brief Scene format entry of the codec registry
+     *
+     * The factories return objects allocated with acul::alloc. A codec may provide only one of them.
+     **/
+    struct Codec
+    {
+        acul::string name;
+        acul::vector<acul::string> extensions; // With the leading dot, matched case-insensitively
+
+        // Optional content check on the first max_signature_size bytes of the file
+        bool (*sniff)(const u8 *data, size_t size) = nullptr;
+        ILoader *(*create_loader)(const acul::string &path) = nullptr;
+        IExporter *(*create_exporter)(const acul::string &path) = nullptr;
+    };
+
+    /**
+     * @brief Register a scene codec at runtime.
+     *
+     * Registered codecs take precedence over the built-in ones (obj, gltf, glb, ply, stl and the native umsc
+     * scene), and a later registration over an earlier one for the same extension. Safe to call concurrently
+     * with the lookups.
+     **/
+    AECL_EXPORT void register_codec(const Codec &codec);
+
+    /**
+     * @brief Create an importer for the file.
+     *
+     * A codec registered for the extension is used as is. Otherwise the file content is sniffed for the built-in
+     * formats (GLB, glTF JSON, PLY, ASCII STL and OBJ), so a misnamed file still gets the right importer, then the
+     * built-in extensions are checked and last the sniffers of the registered codecs.
+     * @return Importer allocated with acul::alloc or nullptr if the format is not supported
+     **/
+    AECL_EXPORT ILoader *get_importer_by_path(const acul::string &path);
+
+    /**
+     * @brief Create an exporter for the output path based on its extension.
+     * @return Exporter allocated with acul::alloc or nullptr if the format is not supported
+     **/
+    AECL_EXPORT IExporter *get_exporter_by_path(const acul::string &path);
+} // namespace aecl::scene
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <aecl/symbol_export.h>
+#include "../import.hpp"
+
+namespace aecl::scene::stl
+{
+    /**
+     * @brief STL scene importer for binary and ASCII files
+     *
+     * The file is memory mapped and its triangles are decoded in parallel chunks. Every ASCII solid becomes
+     * an object; a binary file holds a single one. The unconnected triangles are welded into an indexed
+     * model: corners sharing a position form a vertex group, corners sharing a position and a face normal
+     * share a vertex. Faces keep the normal stored in the file, or a computed one if it is missing.
+     **/
+    class Importer : public ILoader
+    {
+    public:
+        Importer(const acul::string &filename) : ILoader(filename) {};
+
+        AECL_EXPORT ~Importer();
+        AECL_EXPORT virtual acul::op_result read_source() override;
+        AECL_EXPORT virtual void build_geometry() override;
+
+        // STL carries no materials
+        virtual acul::op_result load_materials() override { return acul::make_op_success(); }
+
+    protected:
+        AECL_EXPORT virtual acul::op_result cancel() override;
+
+    private:
+        struct ImportCtx *_ctx = nullptr;
+    };
+} // namespace aecl::scene::stl
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <acul/vector.hpp>
+#include <cstring>
+
+namespace aecl
+{
+    /**
+     * @brief Destination of exported bytes.
+     *
+     * Lets exporters write to sockets, pack files or memory instead of the filesystem.
+     * Writes arrive in order from a single thread at a time.
+     **/
+    class ISink
+    {
+    public:
+        virtual ~ISink() = default;
+
+        // Write size bytes. Returns false if the bytes could not be written
+        virtual bool write(const void *data, size_t size) = 0;
+    };
+
+    // Collects the written bytes in memory
+    class MemorySink final : public ISink
+    {
+    public:
+        acul::vector<char> data;
+
+        bool write(const void *src, size_t size) override
+        {
+            size_t offset = data.size();
+            data.resize(offset + size);
+            memcpy(data.data() + offset, src, size);
+            return true;
+        }
+    };
+} // namespace aecl
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <acul/scalars.hpp>
+#include <acul/string/string.hpp>
+#include <acul/vector.hpp>
+#include <aecl/symbol_export.h>
+#include <chrono>
+
+namespace aecl
+{
+    /**
+     * Import pipeline stages measured by the instrumentation.
+     * For block-streamed sources the read stage encloses the split and parse stages of every block.
+     * The convert stage is the conversion of decoded pixels whose stored type differs from the requested one.
+     **/
+    enum class Stage
+    {
+        read,
+        line_split,
+        parse,
+        sort_merge,
+        index,
+        triangulate,
+        material_resolve,
+        decode,
+        convert,
+        count
+    };
+
+    AECL_EXPORT const char *get_stage_name(Stage stage);
+
+    struct TraceEvent
+    {
+        Stage stage;
+        u64 begin;    // Offset from the stats origin in nanoseconds
+        u64 duration; // Nanoseconds
+    };
+
+    /**
+     * @brief Opt-in import statistics.
+     *
+     * Attach to a loader before the call and read back after it. Stage timings are accumulated per stage
+     * and also kept as separate events, so the whole call can be exported as a Chrome trace.
+     **/
+    struct ImportStats
+    {
+        u64 stage_time[static_cast<int>(Stage::count)]{}; // Total time per stage in nanoseconds
+        u64 lines = 0;                                     // Source lines split
+        u64 faces = 0;                                     // Parsed faces
+        u64 vertices = 0;                                  // Vertices before deduplication
+        u64 unique_vertices = 0;                           // Vertices after deduplication
+        u64 bytes_read = 0;                                // Bytes read from the source
+        u64 bytes_decoded = 0;                             // Bytes of decoded pixel data
+        u64 peak_memory = 0;        // High-water mark of the process memory after the call in bytes
+        u64 peak_memory_growth = 0; // Growth of the high-water mark during the call in bytes
+        acul::vector<TraceEvent> events;
+        std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+        void reset() { *this = ImportStats(); }
+
+        u64 time(Stage stage) const { return stage_time[static_cast<int>(stage)]; }
+
+        // Add the timings and counters of another call. Its events are rebased onto this origin.
+        AECL_EXPORT void merge(const ImportStats &other);
+
+        /**
+         * @brief Serialize the stats in the Chrome Trace Event format
+         * (chrome://tracing, Perfetto). Stages become complete events, counters become a counter event.
+         **/
+        AECL_EXPORT acul::string to_chrome_trace() const;
+    };
+
+    // Scoped stage timer. Does nothing if no stats are attached.
+    class StageTimer
+    {
+    public:
+        StageTimer(ImportStats *stats, Stage stage) : _stats(stats), _stage(stage)
+        {
+            if (_stats) _begin = std::chrono::steady_clock::now();
+        }
+
+        ~StageTimer()
+        {
+            if (!_stats) return;
+            auto end = std::chrono::steady_clock::now();
+            u64 begin = std::chrono::duration_cast<std::chrono::nanoseconds>(_begin - _stats->origin).count();
+            u64 duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - _begin).count();
+            _stats->stage_time[static_cast<int>(_stage)] += duration;
+            _stats->events.push_back({_stage, begin, duration});
+        }
+
+        StageTimer(const StageTimer &) = delete;
+        StageTimer &operator=(const StageTimer &) = delete;
+
+    private:
+        ImportStats *_stats;
+        Stage _stage;
+        std::chrono::steady_clock::time_point _begin;
+    };
+
+    // Get the high-water mark of the process memory in bytes
+    AECL_EXPORT u64 get_peak_memory();
+
+    // Records the memory high-water mark of the scope. Does nothing if no stats are attached.
+    class MemoryScope
+    {
+    public:
+        MemoryScope(ImportStats *stats) : _stats(stats), _begin(stats ? get_peak_memory() : 0) {}
+
+        ~MemoryScope()
+        {
+            if (!_stats) return;
+            _stats->peak_memory = get_peak_memory();
+            _stats->peak_memory_growth = _stats->peak_memory > _begin ? _stats->peak_memory - _begin : 0;
+        }
+
+        MemoryScope(const MemoryScope &) = delete;
+        MemoryScope &operator=(const MemoryScope &) = delete;
+
+    private:
+        ImportStats *_stats;
+        u64 _begin;
+    };
+} // namespace aecl
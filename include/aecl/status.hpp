@@ -2,4 +2,5 @@
 
 #define AECL_OP_DOMAIN              0xB944
 #define AECL_OP_CODE_MATERIAL_ERROR 0x01
-#define AECL_OP_CODE_MESH_ERROR     0x02
\ No newline at end of file
+#define AECL_OP_CODE_MESH_ERROR     0x02
+#define AECL_OP_CODE_CANCELLED      0x04
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <acul/hash/hashmap.hpp>
+#include <acul/string/string.hpp>
+#include <acul/vector.hpp>
+#include <aecl/extension_map.hpp>
+#include <mutex>
+#include <shared_mutex>
+
+namespace aecl
+{
+    /**
+     * Codecs registered at runtime. The codec type needs an `extensions` list and an optional
+     * `bool (*sniff)(const u8 *, size_t)` content check. A later registration takes precedence over earlier ones
+     * for both the extension and the content lookup. Lookups may run concurrently with each other and with
+     * registration.
+     **/
+    template <typename Codec>
+    class CodecTable
+    {
+    public:
+        void add(const Codec &codec)
+        {
+            std::unique_lock<std::shared_mutex> lock(_mutex);
+            _codecs.push_back(codec);
+            for (auto &extension : codec.extensions) _extensions[to_lower(extension)] = _codecs.size() - 1;
+        }
+
+        // Copy the codec registered for the extension to dst. Returns false if there is none.
+        bool find_by_extension(acul::string_view extension, Codec &dst) const
+        {
+            std::shared_lock<std::shared_mutex> lock(_mutex);
+            if (_extensions.empty()) return false;
+            auto it = _extensions.find(to_lower(extension));
+            if (it == _extensions.end()) return false;
+            dst = _codecs[it->second];
+            return true;
+        }
+
+        // Copy the most recently registered codec recognizing the data to dst. Returns false if there is none.
+        bool find_by_signature(const u8 *data, size_t size, Codec &dst) const
+        {
+            std::shared_lock<std::shared_mutex> lock(_mutex);
+            for (size_t i = _codecs.size(); i-- > 0;)
+                if (_codecs[i].sniff && _codecs[i].sniff(data, size))
+                {
+                    dst = _codecs[i];
+                    return true;
+                }
+            return false;
+        }
+
+    private:
+        acul::vector<Codec> _codecs;
+        acul::hashmap<acul::string, size_t> _extensions;
+        mutable std::shared_mutex _mutex;
+
+        static acul::string to_lower(acul::string_view extension)
+        {
+            acul::string lower(extension.data(), extension.size());
+            for (auto &c : lower) c = to_lower_ascii(c);
+            return lower;
+        }
+    };
+
+    // Check whether the data starts with the signature
+    inline bool has_signature(const u8 *data, size_t size, const char *signature, size_t length, size_t offset = 0)
+    {
+        if (size < offset + length) return false;
+        for (size_t i = 0; i < length; ++i)
+            if (data[offset + i] != static_cast<u8>(signature[i])) return false;
+        return true;
+    }
+} // namespace aecl
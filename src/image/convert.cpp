@@ -0,0 +1,430 @@
+#include <aecl/image/convert.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <oneapi/tbb/parallel_for.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define AECL_X86
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define AECL_TARGET_AVX2
+    #else
+        #define AECL_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+    #endif
+#endif
+
+namespace aecl::image
+{
+    enum class PixelType
+    {
+        uint8,
+        uint16,
+        uint32,
+        half,
+        float32,
+        unknown
+    };
+
+    constexpr size_t pixel_type_count = static_cast<size_t>(PixelType::unknown);
+
+    static PixelType get_pixel_type(::umbf::ImageFormat format)
+    {
+        if (format.type == ::umbf::ImageFormat::Type::uint)
+            switch (format.bytes_per_channel)
+            {
+                case 1:
+                    return PixelType::uint8;
+                case 2:
+                    return PixelType::uint16;
+                case 4:
+                    return PixelType::uint32;
+            }
+        else if (format.type == ::umbf::ImageFormat::Type::sfloat)
+            switch (format.bytes_per_channel)
+            {
+                case 2:
+                    return PixelType::half;
+                case 4:
+                    return PixelType::float32;
+            }
+        return PixelType::unknown;
+    }
+
+    static f32 half_to_float(u16 h)
+    {
+        const u32 sign = static_cast<u32>(h & 0x8000) << 16;
+        const u32 exponent = (h >> 10) & 0x1F;
+        const u32 mantissa = h & 0x3FF;
+        u32 bits;
+        if (exponent == 0)
+        {
+            const f32 value = mantissa * 5.9604645e-8f; // Subnormal, mantissa * 2^-24
+            return sign ? -value : value;
+        }
+        else if (exponent == 31) bits = sign | 0x7F800000 | (mantissa << 13) | (mantissa ? 0x400000 : 0); // Quiet NaN
+        else bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        f32 value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // Round to nearest even, the same rounding as the F16C conversion
+    static u16 float_to_half(f32 value)
+    {
+        u32 bits;
+        memcpy(&bits, &value, sizeof(bits));
+        const u32 sign = (bits >> 16) & 0x8000;
+        bits &= 0x7FFFFFFF;
+        if (bits >= 0x7F800000) return sign | 0x7C00 | (bits > 0x7F800000 ? 0x200 : 0); // Inf or NaN
+        if (bits >= 0x477FF000) return sign | 0x7C00;                                  // Rounds to Inf
+        if (bits < 0x38800000)
+        {
+            // Subnormal: adding 0.5 aligns the half mantissa to the low bits and rounds it
+            f32 shifted;
+            memcpy(&shifted, &bits, sizeof(shifted));
+            shifted += 0.5f;
+            memcpy(&bits, &shifted, sizeof(bits));
+            return sign | (bits - 0x3F000000);
+        }
+        const u32 odd = (bits >> 13) & 1;
+        bits += 0xC8000FFF + odd; // Rebias the exponent and round
+        return sign | (bits >> 13);
+    }
+
+    static f32 clamp_unit(f32 value)
+    {
+        value = value > 0.0f ? value : 0.0f; // NaN to zero as well
+        return value < 1.0f ? value : 1.0f;
+    }
+
+    using DecodeRow = void (*)(const void *src, f32 *dst, size_t count);
+    using EncodeRow = void (*)(const f32 *src, void *dst, size_t count);
+
+    static void decode_u8(const void *src, f32 *dst, size_t count)
+    {
+        auto *in = static_cast<const u8 *>(src);
+        for (size_t i = 0; i < count; ++i) dst[i] = in[i] * (1.0f / 255.0f);
+    }
+
+    static void decode_u16(const void *src, f32 *dst, size_t count)
+    {
+        auto *in = static_cast<const u16 *>(src);
+        for (size_t i = 0; i < count; ++i) dst[i] = in[i] * (1.0f / 65535.0f);
+    }
+
+    static void decode_u32(const void *src, f32 *dst, size_t count)
+    {
+        auto *in = static_cast<const u32 *>(src);
+        for (size_t i = 0; i < count; ++i) dst[i] = static_cast<f32>(in[i] * (1.0 / 4294967295.0));
+    }
+
+    static void decode_half(const void *src, f32 *dst, size_t count)
+    {
+        auto *in = static_cast<const u16 *>(src);
+        for (size_t i = 0; i < count; ++i) dst[i] = half_to_float(in[i]);
+    }
+
+    static void decode_f32(const void *src, f32 *dst, size_t count) { memcpy(dst, src, count * sizeof(f32)); }
+
+    static void encode_u8(const f32 *src, void *dst, size_t count)
+    {
+        auto *out = static_cast<u8 *>(dst);
+        for (size_t i = 0; i < count; ++i) out[i] = static_cast<u8>(std::lrint(clamp_unit(src[i]) * 255.0f));
+    }
+
+    static void encode_u16(const f32 *src, void *dst, size_t count)
+    {
+        auto *out = static_cast<u16 *>(dst);
+        for (size_t i = 0; i < count; ++i) out[i] = static_cast<u16>(std::lrint(clamp_unit(src[i]) * 65535.0f));
+    }
+
+    static void encode_u32(const f32 *src, void *dst, size_t count)
+    {
+        auto *out = static_cast<u32 *>(dst);
+        for (size_t i = 0; i < count; ++i)
+            out[i] = static_cast<u32>(std::llrint(clamp_unit(src[i]) * 4294967295.0));
+    }
+
+    static void encode_half(const f32 *src, void *dst, size_t count)
+    {
+        auto *out = static_cast<u16 *>(dst);
+        for (size_t i = 0; i < count; ++i) out[i] = float_to_half(src[i]);
+    }
+
+    static void encode_f32(const f32 *src, void *dst, size_t count) { memcpy(dst, src, count * sizeof(f32)); }
+
+#ifdef AECL_X86
+    // The vector kernels convert 8 values per step and leave the tail to the scalar ones
+
+    AECL_TARGET_AVX2 static void decode_u8_avx2(const void *src, f32 *dst, size_t count)
+    {
+        auto *in = static_cast<const u8 *>(src);
+        const __m256 scale = _mm256_set1_ps(1.0f / 255.0f);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(in + i)));
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+        }
+        decode_u8(in + i, dst + i, count - i);
+    }
+
+    AECL_TARGET_AVX2 static void decode_u16_avx2(const void *src, f32 *dst, size_t count)
+    {
+        auto *in = static_cast<const u16 *>(src);
+        const __m256 scale = _mm256_set1_ps(1.0f / 65535.0f);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)));
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+        }
+        decode_u16(in + i, dst + i, count - i);
+    }
+
+    AECL_TARGET_AVX2 static void decode_half_avx2(const void *src, f32 *dst, size_t count)
+    {
+        auto *in = static_cast<const u16 *>(src);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i))));
+        decode_half(in + i, dst + i, count - i);
+    }
+
+    // Clamp to [0, 1] with NaN mapped to zero and round to nearest even integers of the scale
+    AECL_TARGET_AVX2 static __m256i quantize_avx2(const f32 *src, __m256 scale)
+    {
+        const __m256 clamped = _mm256_max_ps(_mm256_loadu_ps(src), _mm256_setzero_ps());
+        const __m256 v = _mm256_min_ps(clamped, _mm256_set1_ps(1.0f));
+        return _mm256_cvtps_epi32(_mm256_mul_ps(v, scale));
+    }
+
+    AECL_TARGET_AVX2 static void encode_u8_avx2(const f32 *src, void *dst, size_t count)
+    {
+        auto *out = static_cast<u8 *>(dst);
+        const __m256 scale = _mm256_set1_ps(255.0f);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256i v = quantize_avx2(src + i, scale);
+            const __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(words, words));
+        }
+        encode_u8(src + i, out + i, count - i);
+    }
+
+    AECL_TARGET_AVX2 static void encode_u16_avx2(const f32 *src, void *dst, size_t count)
+    {
+        auto *out = static_cast<u16 *>(dst);
+        const __m256 scale = _mm256_set1_ps(65535.0f);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256i v = quantize_avx2(src + i, scale);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                             _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+        }
+        encode_u16(src + i, out + i, count - i);
+    }
+
+    AECL_TARGET_AVX2 static void encode_half_avx2(const f32 *src, void *dst, size_t count)
+    {
+        auto *out = static_cast<u16 *>(dst);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                             _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+        encode_half(src + i, out + i, count - i);
+    }
+
+    static bool has_avx2_f16c()
+    {
+    #ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+        const bool f16c = info[2] & (1 << 29);
+        const bool osxsave = info[2] & (1 << 27);
+        if (!f16c || !osxsave || (_xgetbv(0) & 0x6) != 0x6) return false;
+        __cpuidex(info, 7, 0);
+        return info[1] & (1 << 5);
+    #else
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+    #endif
+    }
+#endif
+
+    struct RowKernels
+    {
+        DecodeRow decode[pixel_type_count];
+        EncodeRow encode[pixel_type_count];
+    };
+
+    static const RowKernels &get_row_kernels()
+    {
+        static const RowKernels kernels = [] {
+            RowKernels k{{decode_u8, decode_u16, decode_u32, decode_half, decode_f32},
+                         {encode_u8, encode_u16, encode_u32, encode_half, encode_f32}};
+#ifdef AECL_X86
+            if (has_avx2_f16c())
+            {
+                k.decode[(int)PixelType::uint8] = decode_u8_avx2;
+                k.decode[(int)PixelType::uint16] = decode_u16_avx2;
+                k.decode[(int)PixelType::half] = decode_half_avx2;
+                k.encode[(int)PixelType::uint8] = encode_u8_avx2;
+                k.encode[(int)PixelType::uint16] = encode_u16_avx2;
+                k.encode[(int)PixelType::half] = encode_half_avx2;
+            }
+#endif
+            return k;
+        }();
+        return kernels;
+    }
+
+    // Source channel index of each destination channel, or one of the fill values
+    enum ChannelSource
+    {
+        fill_zero = -1,
+        fill_one = -2
+    };
+
+    static bool equal_name(const char *name, size_t size, const char *expected)
+    {
+        for (size_t i = 0; i < size; ++i, ++expected)
+        {
+            const char c = name[i] >= 'A' && name[i] <= 'Z' ? name[i] - 'A' + 'a' : name[i];
+            if (c != *expected) return false;
+        }
+        return *expected == '\0';
+    }
+
+    /**
+     * Find a channel by its short or full name, case-insensitive. Layered names like "diffuse.R" are matched by
+     * the last component.
+     **/
+    static int find_channel(const ImageView &image, const char *letter, const char *word)
+    {
+        if (!image.channels) return -1;
+        for (u32 i = 0; i < image.channel_count; ++i)
+        {
+            const auto &channel = image.channels[i];
+            const char *name = channel.c_str();
+            size_t size = channel.size();
+            for (size_t k = size; k > 0; --k)
+                if (name[k - 1] == '.')
+                {
+                    name += k;
+                    size -= k;
+                    break;
+                }
+            if (equal_name(name, size, letter) || equal_name(name, size, word)) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    // Returns false if the destination channels are the source ones in the same order
+    static bool build_channel_map(const ImageView &image, size_t dst_channels, int *map)
+    {
+        const size_t src_channels = image.channel_count;
+        for (size_t c = 0; c < dst_channels; ++c)
+        {
+            const bool alpha = c == 3 || (dst_channels == 2 && c == 1);
+            static const char *const letters[] = {"r", "g", "b"};
+            static const char *const words[] = {"red", "green", "blue"};
+            int index = alpha              ? find_channel(image, "a", "alpha")
+                        : dst_channels < 3 ? find_channel(image, "y", "luminance")
+                                           : find_channel(image, letters[c], words[c]);
+            if (index >= 0) map[c] = index;
+            else if (src_channels == dst_channels) map[c] = static_cast<int>(c); // Unnamed, kept in place
+            else if (alpha) map[c] = fill_one;
+            else if (src_channels <= 2) map[c] = 0; // Luminance expanded to color
+            else map[c] = c < src_channels ? static_cast<int>(c) : fill_zero;
+        }
+        if (src_channels != dst_channels) return true;
+        for (size_t c = 0; c < dst_channels; ++c)
+            if (map[c] != static_cast<int>(c)) return true;
+        return false;
+    }
+
+    template <typename T>
+    static void remap_row(const T *src, T *dst, size_t width, size_t src_channels, size_t dst_channels,
+                          const int *map, const T *fill)
+    {
+        for (size_t x = 0; x < width; ++x, src += src_channels)
+            for (size_t c = 0; c < dst_channels; ++c) *dst++ = map[c] >= 0 ? src[map[c]] : fill[-1 - map[c]];
+    }
+
+    bool needs_channel_remap(const ImageView &image, size_t dst_channels)
+    {
+        int map[4];
+        return dst_channels > 4 || build_channel_map(image, dst_channels, map);
+    }
+
+    void *convert_image(const ImageView &image, ::umbf::ImageFormat dst_format, size_t dst_channels)
+    {
+        const PixelType src_type = get_pixel_type(image.format);
+        const PixelType dst_type = get_pixel_type(dst_format);
+        const size_t src_channels = image.channel_count;
+        if (src_type == PixelType::unknown || dst_type == PixelType::unknown || src_channels == 0 ||
+            dst_channels == 0 || dst_channels > 4)
+            return nullptr;
+
+        const size_t width = image.width;
+        const size_t dst_row = width * dst_channels * dst_format.bytes_per_channel;
+        auto *dst = acul::mem_allocator<std::byte>::allocate(dst_row * image.height);
+        if (!dst) return nullptr;
+
+        int map[4];
+        const bool remap = build_channel_map(image, dst_channels, map);
+        const auto &kernels = get_row_kernels();
+        const DecodeRow decode = kernels.decode[(int)src_type];
+        const EncodeRow encode = kernels.encode[(int)dst_type];
+
+        // Zero and one in the destination format, for the filled channels
+        const f32 unit_values[2] = {0.0f, 1.0f};
+        alignas(4) std::byte fill[2 * sizeof(u32)];
+        encode(unit_values, fill, 2);
+
+        // Around 64K pixels per task
+        const size_t grain = std::max<size_t>(1, 65536 / std::max<size_t>(width, 1));
+        oneapi::tbb::parallel_for(
+            oneapi::tbb::blocked_range<size_t>(0, image.height, grain),
+            [&](const oneapi::tbb::blocked_range<size_t> &range) {
+                if (src_type == dst_type)
+                {
+                    for (size_t y = range.begin(); y != range.end(); ++y)
+                    {
+                        const std::byte *in = image.row(y);
+                        std::byte *out = dst + y * dst_row;
+                        if (!remap) memcpy(out, in, dst_row);
+                        else if (dst_format.bytes_per_channel == 1)
+                            remap_row(reinterpret_cast<const u8 *>(in), reinterpret_cast<u8 *>(out), width,
+                                      src_channels, dst_channels, map, reinterpret_cast<const u8 *>(fill));
+                        else if (dst_format.bytes_per_channel == 2)
+                            remap_row(reinterpret_cast<const u16 *>(in), reinterpret_cast<u16 *>(out), width,
+                                      src_channels, dst_channels, map, reinterpret_cast<const u16 *>(fill));
+                        else
+                            remap_row(reinterpret_cast<const u32 *>(in), reinterpret_cast<u32 *>(out), width,
+                                      src_channels, dst_channels, map, reinterpret_cast<const u32 *>(fill));
+                    }
+                    return;
+                }
+
+                acul::vector<f32> decoded(width * src_channels);
+                acul::vector<f32> remapped(remap ? width * dst_channels : 0);
+                for (size_t y = range.begin(); y != range.end(); ++y)
+                {
+                    decode(image.row(y), decoded.data(), decoded.size());
+                    if (remap)
+                    {
+                        remap_row(decoded.data(), remapped.data(), width, src_channels, dst_channels, map,
+                                  unit_values);
+                        encode(remapped.data(), dst + y * dst_row, remapped.size());
+                    }
+                    else encode(decoded.data(), dst + y * dst_row, decoded.size());
+                }
+            });
+        return dst;
+    }
+} // namespace aecl::image
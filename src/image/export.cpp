@@ -1,6 +1,7 @@
 #include <acul/log.hpp>
+#include <aecl/image/convert.hpp>
 #include <aecl/image/export.hpp>
-#include <umbf/utils.hpp>
+#include <cstring>
 #include <umbf/version.h>
 
 namespace aecl::image
@@ -11,46 +12,113 @@ namespace aecl::image
         return false;
     }
 
-    bool bmp::save(const acul::string &path, Params &bp)
+    // Image output writing to the file at path, or to an in-memory buffer passed on to params.sink on close
+    class Output
     {
-        auto &image = bp.image;
-        void *pixels = image.pixels;
-        acul::unique_ptr<void> tmp;
-        ::umbf::ImageFormat dst_format = {bp.format.format_types[0], 1};
-        if (!is_image_equals(image, dst_format, 3))
+    public:
+        Output(const acul::string &path, OIIOParams &params) : _params(params), _proxy(_buffer)
+        {
+            _out = OIIO::ImageOutput::create(path.c_str());
+            if (!_out) params.error = acul::format("Unsupported image format: %s", path.c_str());
+            else if (params.sink && (!_out->supports("ioproxy") || !_out->set_ioproxy(&_proxy)))
+            {
+                params.error = acul::format("Image format cannot be written to a sink: %s", path.c_str());
+                _out.reset();
+            }
+        }
+
+        explicit operator bool() const { return _out != nullptr; }
+
+        OIIO::ImageOutput *operator->() const { return _out.get(); }
+
+        OIIO::ImageOutput *get() const { return _out.get(); }
+
+        bool close()
+        {
+            if (!_out->close()) return oiio_error(_params, _out.get());
+            if (_params.sink && !_params.sink->write(_buffer.data(), _buffer.size()))
+            {
+                _params.error = "Failed to write image data";
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        OIIOParams &_params;
+        std::vector<unsigned char> _buffer;
+        OIIO::Filesystem::IOVecOutput _proxy;
+        std::unique_ptr<OIIO::ImageOutput> _out;
+    };
+
+    // Pixels of an image in the written format, converted to a packed buffer only if the image does not match it
+    class Pixels
+    {
+    public:
+        Pixels(const ImageView &image, ::umbf::ImageFormat format, size_t channels)
         {
-            pixels = ::umbf::utils::convert_image(image, dst_format, 3);
-            tmp = acul::unique_ptr<void>(pixels); // Release on call end
+            if (is_image_equals(image, format, channels) && !needs_channel_remap(image, channels))
+            {
+                _data = image.pixels;
+                _stride = image.row_stride();
+            }
+            else
+            {
+                _converted.reset(convert_image(image, format, channels));
+                _data = _converted.get();
+            }
         }
+
+        explicit operator bool() const { return _data != nullptr; }
+
+        bool write(OIIO::ImageOutput *out, OIIO::TypeDesc type) const
+        {
+            return out->write_image(type, _data, OIIO::AutoStride, _stride);
+        }
+
+    private:
+        const void *_data = nullptr;
+        OIIO::stride_t _stride = OIIO::AutoStride;
+        acul::unique_ptr<void> _converted;
+    };
+
+    inline bool pixels_error(OIIOParams &params)
+    {
+        params.error = "Unsupported pixel format";
+        return false;
+    }
+
+    bool bmp::save(const acul::string &path, Params &bp)
+    {
+        auto &image = bp.image;
+        Pixels pixels(image, {bp.format.format_types[0], 1}, 3);
+        if (!pixels) return pixels_error(bp);
         auto *c_path = path.c_str();
-        std::unique_ptr<OIIO::ImageOutput> out = OIIO::ImageOutput::create(c_path);
-        OIIO::ImageSpec spec(image.width, image.height, image.channels.size(), OIIO::TypeDesc::UINT8);
+        Output out(path, bp);
+        if (!out) return false;
+        OIIO::ImageSpec spec(image.width, image.height, 3, OIIO::TypeDesc::UINT8);
         spec.attribute("XResolution", bp.dpi);
         spec.attribute("YResolution", bp.dpi);
         if (bp.dither) spec.attribute("oiio:dither", 1);
-        if (!out->open(c_path, spec) || !out->write_image(OIIO::TypeDesc::UINT8, pixels))
+        if (!out->open(c_path, spec) || !pixels.write(out.get(), OIIO::TypeDesc::UINT8))
             return oiio_error(bp, out.get());
-        return out->close();
+        return out.close();
     }
 
     bool gif::save(const acul::string &path, Params &gp)
     {
-        acul::vector<acul::unique_ptr<void>> tmp;
-        acul::vector<void *> pixels;
+        acul::vector<Pixels> pixels;
         pixels.reserve(gp.images.size());
         auto *c_path = path.c_str();
-        std::unique_ptr<OIIO::ImageOutput> out = OIIO::ImageOutput::create(c_path);
+        Output out(path, gp);
+        if (!out) return false;
         acul::vector<OIIO::ImageSpec> specs;
 
         ::umbf::ImageFormat dst_format = {gp.format.format_types[0], 1};
         for (auto &image : gp.images)
         {
-            if (!is_image_equals(image, dst_format, 3))
-            {
-                pixels.emplace_back(::umbf::utils::convert_image(image, dst_format, 3));
-                tmp.emplace_back(pixels.back());
-            }
-            else pixels.emplace_back(image.pixels);
+            pixels.emplace_back(image, dst_format, 3);
+            if (!pixels.back()) return pixels_error(gp);
             OIIO::ImageSpec spec(image.width, image.height, 3, OIIO::TypeDesc::UINT8);
             if (gp.interlacing) spec.attribute("gif:Interlacing", 1);
             if (gp.images.size() > 1)
@@ -74,66 +142,51 @@ namespace aecl::image
                     return false;
                 }
             }
-            if (!out->write_image(OIIO::TypeDesc::UINT8, pixels[i]))
+            if (!pixels[i].write(out.get(), OIIO::TypeDesc::UINT8))
             {
                 gp.error = out->geterror().c_str();
                 return false;
             }
         }
-        return out->close();
+        return out.close();
     }
 
     bool hdr::save(const acul::string &path, Params &hp)
     {
-        acul::unique_ptr<void> tmp;
-        void *pixels = hp.image.pixels;
-        ::umbf::ImageFormat dst_format = {hp.format.format_types[2], 4};
-        if (!is_image_equals(hp.image, dst_format, 3))
-        {
-            pixels = ::umbf::utils::convert_image(hp.image, dst_format, 3);
-            tmp = acul::unique_ptr<void>(pixels); // Release on call end
-        }
+        Pixels pixels(hp.image, {hp.format.format_types[2], 4}, 3);
+        if (!pixels) return pixels_error(hp);
         auto *c_path = path.c_str();
-        std::unique_ptr<OIIO::ImageOutput> out = OIIO::ImageOutput::create(c_path);
+        Output out(path, hp);
+        if (!out) return false;
         OIIO::ImageSpec spec(hp.image.width, hp.image.height, 3, OIIO::TypeDesc::FLOAT);
-        if (!out->open(c_path, spec) || !out->write_image(OIIO::TypeDesc::FLOAT, pixels))
+        if (!out->open(c_path, spec) || !pixels.write(out.get(), OIIO::TypeDesc::FLOAT))
             return oiio_error(hp, out.get());
-        return out->close();
+        return out.close();
     }
 
     bool heif::save(const acul::string &path, Params &hp)
     {
-        acul::unique_ptr<void> tmp;
-        void *pixels = hp.image.pixels;
-        ::umbf::ImageFormat dst_format = {hp.format.format_types[0], 1};
-        size_t dst_channels = hp.image.channels.size() > 3 ? 4 : 3;
-        if (!is_image_equals(hp.image, dst_format, dst_channels))
-        {
-            pixels = ::umbf::utils::convert_image(hp.image, dst_format, dst_channels);
-            tmp = acul::unique_ptr<void>(pixels); // Release on call end
-        }
+        size_t dst_channels = hp.image.channel_count > 3 ? 4 : 3;
+        Pixels pixels(hp.image, {hp.format.format_types[0], 1}, dst_channels);
+        if (!pixels) return pixels_error(hp);
         auto *c_path = path.c_str();
-        std::unique_ptr<OIIO::ImageOutput> out = OIIO::ImageOutput::create(c_path);
+        Output out(path, hp);
+        if (!out) return false;
         OIIO::ImageSpec spec(hp.image.width, hp.image.height, dst_channels, OIIO::TypeDesc::UINT8);
         auto comp_attr = acul::format("heic:%d", hp.compression);
         spec.attribute("Compression", comp_attr.c_str());
-        if (!out->open(c_path, spec) || !out->write_image(OIIO::TypeDesc::UINT8, hp.image.pixels))
+        if (!out->open(c_path, spec) || !pixels.write(out.get(), OIIO::TypeDesc::UINT8))
             return oiio_error(hp, out.get());
-        return out->close();
+        return out.close();
     }
 
     bool jpeg::save(const acul::string &path, Params &jp)
     {
-        acul::unique_ptr<void> tmp;
-        void *pixels = jp.image.pixels;
-        ::umbf::ImageFormat dst_format = {jp.format.format_types[0], 1};
-        if (!is_image_equals(jp.image, dst_format, 3))
-        {
-            pixels = ::umbf::utils::convert_image(jp.image, dst_format, 3);
-            tmp = acul::unique_ptr<void>(pixels); // Release on call end
-        }
+        Pixels pixels(jp.image, {jp.format.format_types[0], 1}, 3);
+        if (!pixels) return pixels_error(jp);
         auto *c_path = path.c_str();
-        std::unique_ptr<OIIO::ImageOutput> out = OIIO::ImageOutput::create(c_path);
+        Output out(path, jp);
+        if (!out) return false;
         OIIO::ImageSpec spec(jp.image.width, jp.image.height, 3, OIIO::TypeDesc::UINT8);
         spec.attribute("XResolution", jp.dpi);
         spec.attribute("YResolution", jp.dpi);
@@ -143,19 +196,19 @@ namespace aecl::image
         if (jp.progressive) spec.attribute("jpeg:progressive", 1);
         spec.attribute("oiio:ColorSpace", "sRGB");
         spec.attribute("Software", jp.app_name.c_str());
-        if (!out->open(c_path, spec) || !out->write_image(OIIO::TypeDesc::UINT8, pixels))
+        if (!out->open(c_path, spec) || !pixels.write(out.get(), OIIO::TypeDesc::UINT8))
             return oiio_error(jp, out.get());
-        return out->close();
+        return out.close();
     }
 
     bool openexr::save(const acul::string &path, Params &op, u8 dst_bit)
     {
         assert(dst_bit == 2 || dst_bit == 4);
-        acul::vector<acul::unique_ptr<void>> tmp;
-        acul::vector<void *> pixels;
+        acul::vector<Pixels> pixels;
         pixels.reserve(op.images.size());
         auto *c_path = path.c_str();
-        std::unique_ptr<OIIO::ImageOutput> out = OIIO::ImageOutput::create(c_path);
+        Output out(path, op);
+        if (!out) return false;
         acul::vector<OIIO::ImageSpec> specs;
         u32 max_width = 0, max_height = 0;
         for (const auto &image : op.images)
@@ -168,13 +221,9 @@ namespace aecl::image
 
         for (auto &image : op.images)
         {
-            if (!is_image_equals(image, dst_format, image.channels.size()))
-            {
-                pixels.emplace_back(::umbf::utils::convert_image(image, dst_format, image.channels.size()));
-                tmp.emplace_back(pixels.back());
-            }
-            else pixels.emplace_back(image.pixels);
-            OIIO::ImageSpec spec(image.width, image.height, image.channels.size(), dst_type);
+            pixels.emplace_back(image, dst_format, image.channel_count);
+            if (!pixels.back()) return pixels_error(op);
+            OIIO::ImageSpec spec(image.width, image.height, image.channel_count, dst_type);
             OIIO::ROI full_roi(0, max_width, 0, max_height);
             spec.full_x = full_roi.xbegin;
             spec.full_y = full_roi.ybegin;
@@ -190,26 +239,22 @@ namespace aecl::image
         {
             if (i > 0 && !out->open(c_path, specs[i], OIIO::ImageOutput::AppendSubimage))
                 return oiio_error(op, out.get());
-            if (!out->write_image(dst_type, pixels[i])) return oiio_error(op, out.get());
+            if (!pixels[i].write(out.get(), dst_type)) return oiio_error(op, out.get());
         }
-        return out->close();
+        return out.close();
     }
 
     bool png::save(const acul::string &path, Params &pp, u8 dst_bit)
     {
         assert(dst_bit == 1 || dst_bit == 2);
-        acul::unique_ptr<void> tmp;
-        void *pixels = pp.image.pixels;
         const ::umbf::ImageFormat dst_format = {pp.format.format_types[dst_bit / 2], dst_bit};
         const OIIO::TypeDesc dst_type = umbf_format_to_oiio(dst_format);
-        int dst_channels = pp.image.channels.size() > 3 ? 4 : 3;
-        if (!is_image_equals(pp.image, dst_format, dst_channels))
-        {
-            pixels = ::umbf::utils::convert_image(pp.image, dst_format, dst_channels);
-            tmp = acul::unique_ptr<void>(pixels); // Release on call end
-        }
+        int dst_channels = pp.image.channel_count > 3 ? 4 : 3;
+        Pixels pixels(pp.image, dst_format, dst_channels);
+        if (!pixels) return pixels_error(pp);
         auto *c_path = path.c_str();
-        std::unique_ptr<OIIO::ImageOutput> out = OIIO::ImageOutput::create(c_path);
+        Output out(path, pp);
+        if (!out) return false;
         OIIO::ImageSpec spec(pp.image.width, pp.image.height, dst_channels, dst_type);
         spec.attribute("XResolution", pp.dpi);
         spec.attribute("YResolution", pp.dpi);
@@ -219,43 +264,33 @@ namespace aecl::image
         if (pp.dither) spec.attribute("oiio:dither", 1);
         spec.attribute("oiio:ColorSpace", "sRGB");
         if (pp.unassociated_alpha) spec.attribute("oiio:UnassociatedAlpha", 1);
-        if (!out->open(c_path, spec) || !out->write_image(dst_type, pixels)) return oiio_error(pp, out.get());
-        return out->close();
+        if (!out->open(c_path, spec) || !pixels.write(out.get(), dst_type)) return oiio_error(pp, out.get());
+        return out.close();
     }
 
     bool pnm::save(const acul::string &path, Params &pp)
     {
-        acul::unique_ptr<void> tmp;
-        void *pixels = pp.image.pixels;
-        ::umbf::ImageFormat dst_format = {pp.format.format_types[0], 1};
-        if (!is_image_equals(pp.image, dst_format, 3))
-        {
-            pixels = ::umbf::utils::convert_image(pp.image, dst_format, 3);
-            tmp = acul::unique_ptr<void>(pixels); // Release on call end
-        }
+        Pixels pixels(pp.image, {pp.format.format_types[0], 1}, 3);
+        if (!pixels) return pixels_error(pp);
         auto *c_path = path.c_str();
-        std::unique_ptr<OIIO::ImageOutput> out = OIIO::ImageOutput::create(c_path);
+        Output out(path, pp);
+        if (!out) return false;
         OIIO::ImageSpec spec(pp.image.width, pp.image.height, 3, OIIO::TypeDesc::UINT8);
         if (pp.binary) spec.attribute("pnm:binary", 1);
         if (pp.dither) spec.attribute("oiio:dither", 1);
-        if (!out->open(c_path, spec) || !out->write_image(OIIO::TypeDesc::UINT8, pixels))
+        if (!out->open(c_path, spec) || !pixels.write(out.get(), OIIO::TypeDesc::UINT8))
             return oiio_error(pp, out.get());
-        return out->close();
+        return out.close();
     }
 
     bool targa::save(const acul::string &path, Params &tp)
     {
-        acul::unique_ptr<void> tmp;
-        void *pixels = tp.image.pixels;
-        ::umbf::ImageFormat dst_format = {tp.format.format_types[0], 1};
-        size_t dst_channels = tp.image.channels.size() > 3 ? 4 : 3;
-        if (!is_image_equals(tp.image, dst_format, dst_channels))
-        {
-            pixels = ::umbf::utils::convert_image(tp.image, dst_format, dst_channels);
-            tmp = acul::unique_ptr<void>(pixels); // Release on call end
-        }
+        size_t dst_channels = tp.image.channel_count > 3 ? 4 : 3;
+        Pixels pixels(tp.image, {tp.format.format_types[0], 1}, dst_channels);
+        if (!pixels) return pixels_error(tp);
         auto *c_path = path.c_str();
-        std::unique_ptr<OIIO::ImageOutput> out = OIIO::ImageOutput::create(c_path);
+        Output out(path, tp);
+        if (!out) return false;
         OIIO::ImageSpec spec(tp.image.width, tp.image.height, dst_channels, OIIO::TypeDesc::UINT8);
         spec.attribute("targa:compression", tp.compression.c_str());
         spec.attribute("targa:alpha_type", tp.alpha_type);
@@ -263,18 +298,18 @@ namespace aecl::image
         spec.attribute("oiio:BitsPerSample", 8);
         spec.attribute("oiio:ColorSpace", "sRGB");
         if (tp.dither) spec.attribute("oiio:dither", 1);
-        if (!out->open(c_path, spec) || !out->write_image(OIIO::TypeDesc::UINT8, pixels))
+        if (!out->open(c_path, spec) || !pixels.write(out.get(), OIIO::TypeDesc::UINT8))
             return oiio_error(tp, out.get());
-        return out->close();
+        return out.close();
     }
 
     bool tiff::save(const acul::string &path, Params &tp, u8 dst_bit)
     {
-        acul::vector<acul::unique_ptr<void>> tmp;
-        acul::vector<void *> pixels;
+        acul::vector<Pixels> pixels;
         pixels.reserve(tp.images.size());
         auto *c_path = path.c_str();
-        std::unique_ptr<OIIO::ImageOutput> out = OIIO::ImageOutput::create(c_path);
+        Output out(path, tp);
+        if (!out) return false;
         assert(out);
         acul::vector<OIIO::ImageSpec> specs;
         const ::umbf::ImageFormat dst_format = {tp.format.format_types[dst_bit / 2], dst_bit};
@@ -282,13 +317,9 @@ namespace aecl::image
 
         for (auto &image : tp.images)
         {
-            if (!is_image_equals(image, dst_format, image.channels.size()))
-            {
-                pixels.emplace_back(::umbf::utils::convert_image(image, dst_format, image.channels.size()));
-                tmp.emplace_back(pixels.back());
-            }
-            else pixels.emplace_back(image.pixels);
-            OIIO::ImageSpec spec(image.width, image.height, image.channels.size(), dst_type);
+            pixels.emplace_back(image, dst_format, image.channel_count);
+            if (!pixels.back()) return pixels_error(tp);
+            OIIO::ImageSpec spec(image.width, image.height, image.channel_count, dst_type);
             if (tp.dither) spec.attribute("oiio:dither", 1);
             if (tp.unassociated_alpha) spec.attribute("oiio:UnassociatedAlpha", 1);
             spec.attribute("tiff:zipquality", tp.zipquality);
@@ -306,28 +337,24 @@ namespace aecl::image
         {
             if (i > 0 && !out->open(c_path, specs[i], OIIO::ImageOutput::AppendSubimage))
                 return oiio_error(tp, out.get());
-            if (!out->write_image(dst_type, pixels[i])) return oiio_error(tp, out.get());
+            if (!pixels[i].write(out.get(), dst_type)) return oiio_error(tp, out.get());
         }
-        return out->close();
+        return out.close();
     }
 
     bool webp::save(const acul::string &path, Params &wp)
     {
-        acul::unique_ptr<void> tmp;
-        void *pixels = wp.image.pixels;
-        ::umbf::ImageFormat dst_format = {wp.format.format_types[0], 1};
-        if (!is_image_equals(wp.image, dst_format, 3))
-        {
-            pixels = ::umbf::utils::convert_image(wp.image, dst_format, wp.image.channels.size() > 3 ? 4 : 3);
-            tmp = acul::unique_ptr<void>(pixels); // Release on call end
-        }
+        size_t dst_channels = wp.image.channel_count > 3 ? 4 : 3;
+        Pixels pixels(wp.image, {wp.format.format_types[0], 1}, dst_channels);
+        if (!pixels) return pixels_error(wp);
         auto *c_path = path.c_str();
-        std::unique_ptr<OIIO::ImageOutput> out = OIIO::ImageOutput::create(c_path);
-        OIIO::ImageSpec spec(wp.image.width, wp.image.height, wp.image.channels.size(), OIIO::TypeDesc::UINT8);
+        Output out(path, wp);
+        if (!out) return false;
+        OIIO::ImageSpec spec(wp.image.width, wp.image.height, dst_channels, OIIO::TypeDesc::UINT8);
         if (wp.dither) spec.attribute("oiio:dither", 1);
-        if (!out->open(c_path, spec) || !out->write_image(OIIO::TypeDesc::UINT8, pixels))
+        if (!out->open(c_path, spec) || !pixels.write(out.get(), OIIO::TypeDesc::UINT8))
             return oiio_error(wp, out.get());
-        return out->close();
+        return out.close();
     }
 
     bool umbf::save(const acul::string &path, Params &up)
@@ -339,7 +366,29 @@ namespace aecl::image
         asset.header.type_sign = ::umbf::sign_block::format::image;
         asset.header.flags = 0;
         if (up.compression > 0) asset.header.flags |= UMBF_COMPRESSION_PAYLOAD_BIT;
-        asset.blocks.push_back(acul::make_shared<::umbf::Image2D>(up.image));
+
+        // The block is serialized from packed rows, a strided view is repacked
+        const ImageView &view = up.image;
+        auto image = acul::make_shared<::umbf::Image2D>();
+        image->width = view.width;
+        image->height = view.height;
+        image->format = view.format;
+        for (u32 i = 0; i < view.channel_count; ++i)
+        {
+            static const char *const default_names[] = {"R", "G", "B", "A"};
+            if (view.channels) image->channels.push_back(view.channels[i]);
+            else image->channels.push_back(i < 4 ? default_names[i] : acul::format("C%u", i).c_str());
+        }
+        acul::unique_ptr<void> packed;
+        if (view.packed()) image->pixels = const_cast<void *>(view.pixels);
+        else
+        {
+            auto *rows = acul::mem_allocator<std::byte>::allocate(view.row_size() * view.height);
+            packed.reset(rows);
+            for (u32 y = 0; y < view.height; ++y) memcpy(rows + y * view.row_size(), view.row(y), view.row_size());
+            image->pixels = rows;
+        }
+        asset.blocks.push_back(image);
         asset.checksum = up.checksum;
         return asset.save(path, up.compression);
     }
@@ -2,8 +2,12 @@
 #include <acul/hash/hashmap.hpp>
 #include <acul/io/fs/path.hpp>
 #include <aecl/image/import.hpp>
+#include <algorithm>
+#include <cstring>
 #include <inttypes.h>
 #include <umbf/utils.hpp>
+#include "../codec_table.hpp"
+#include "../io/file.hpp"
 
 namespace aecl::image
 {
@@ -16,9 +20,28 @@ namespace aecl::image
         return load_handler(inp, subimage, info.channels.size(), info.pixels, info.size());
     }
 
+    // Converts packed channel values in place between two types of the same size
+    static void convert_values(OIIO::TypeDesc src_type, OIIO::TypeDesc dst_type, void *data, size_t count)
+    {
+        constexpr size_t chunk_size = 4096;
+        alignas(4) std::byte scratch[chunk_size * 4];
+        auto *values = static_cast<std::byte *>(data);
+        const size_t value_size = dst_type.size();
+        for (size_t i = 0; i < count; i += chunk_size)
+        {
+            const size_t n = std::min(chunk_size, count - i);
+            OIIO::convert_pixel_values(src_type, values + i * value_size, dst_type, scratch, static_cast<int>(n));
+            std::memcpy(values + i * value_size, scratch, n * value_size);
+        }
+    }
+
     bool OIIOLoader::load(const acul::string &path, acul::vector<umbf::Image2D> &images)
     {
-        auto inp = OIIO::ImageInput::open(path.c_str());
+        MemoryScope memory(_stats);
+        auto inp = [&] {
+            StageTimer timer(_stats, Stage::read);
+            return OIIO::ImageInput::open(path.c_str());
+        }();
         if (!inp)
         {
             _error = OIIO::geterror().c_str();
@@ -27,6 +50,8 @@ namespace aecl::image
         acul::unique_function<bool(const std::unique_ptr<OIIO::ImageInput> &inp, int, int, void *, size_t)>
             load_handler{nullptr};
         umbf::ImageFormat image_format;
+        OIIO::TypeDesc dst_type, read_type;
+        const size_t first_image = images.size();
         for (int subimage{0}; inp->seek_subimage(subimage, 0); subimage++)
         {
             const OIIO::ImageSpec &spec = inp->spec();
@@ -47,15 +72,51 @@ namespace aecl::image
                     _error = "Unsupported image format";
                     return false;
                 }
-                OIIO::TypeDesc dst_type = umbf_format_to_oiio(image_format);
-                load_handler = [dst_type](const std::unique_ptr<OIIO::ImageInput> &inp, int subimage, int channels,
-                                          void *dst, size_t size) {
-                    if (!inp->read_image(subimage, 0, 0, channels, dst_type, dst)) return false;
+                dst_type = umbf_format_to_oiio(image_format);
+                load_handler = [&read_type, token = _progress](const std::unique_ptr<OIIO::ImageInput> &inp,
+                                                             int subimage, int channels, void *dst, size_t size) {
+                    if (!token) return inp->read_image(subimage, 0, 0, channels, read_type, dst);
+
+                    // Decode by scanline chunks to poll the token between them
+                    constexpr int rows_per_chunk = 64;
+                    const OIIO::ImageSpec &spec = inp->spec();
+                    const int subimages = std::max(spec.get_int_attribute("oiio:subimages", 1), subimage + 1);
+                    const size_t row_size = size / spec.height;
+                    for (int y = 0; y < spec.height; y += rows_per_chunk)
+                    {
+                        if (token->cancelled()) return false;
+                        const int y_end = std::min(y + rows_per_chunk, spec.height);
+                        if (!inp->read_scanlines(subimage, 0, spec.y + y, spec.y + y_end, 0, 0, channels, read_type,
+                                                 static_cast<std::byte *>(dst) + row_size * y))
+                            return false;
+                        token->report((subimage + static_cast<f32>(y_end) / spec.height) / subimages);
+                    }
                     return true;
                 };
             }
             info.format = image_format;
-            load_image(inp, subimage, std::move(load_handler), info);
+            // Decode in the stored type when it has the requested size, the conversion is then timed on its own
+            read_type =
+                spec.channelformats.empty() && spec.format.size() == dst_type.size() ? spec.format : dst_type;
+            {
+                StageTimer timer(_stats, Stage::decode);
+                load_image(inp, subimage, std::move(load_handler), info);
+            }
+            if (is_cancelled(_progress))
+            {
+                acul::release(info.pixels);
+                for (size_t i = first_image; i < images.size(); ++i) acul::release(images[i].pixels);
+                images.resize(first_image);
+                inp->close();
+                _error = "Import cancelled";
+                return false;
+            }
+            if (read_type != dst_type)
+            {
+                StageTimer timer(_stats, Stage::convert);
+                convert_values(read_type, dst_type, info.pixels, info.size() / dst_type.size());
+            }
+            if (_stats) _stats->bytes_decoded += info.size();
             images.push_back(info);
         }
         inp->close();
@@ -64,8 +125,12 @@ namespace aecl::image
 
     bool UMBFLoader::load(const acul::string &path, acul::vector<umbf::Image2D> &images)
     {
+        MemoryScope memory(_stats);
         acul::shared_ptr<umbf::File> asset;
-        auto res = umbf::File::read_from_disk(path, asset);
+        auto res = [&] {
+            StageTimer timer(_stats, Stage::read);
+            return umbf::File::read_from_disk(path, asset);
+        }();
         if (!res.success())
         {
             _error = acul::format("Failed to load file. Error code: 0x%016" PRIx64, static_cast<u64>(res));
@@ -78,13 +143,14 @@ namespace aecl::image
             return false;
         }
         auto image = acul::static_pointer_cast<umbf::Image2D>(asset->blocks.front());
+        if (_stats) _stats->bytes_decoded += image->size();
         images.push_back(*image);
         return true;
     }
 
-    ILoader *get_importer_by_path(const acul::string &path)
+    static ILoader *create_builtin_loader(Type type)
     {
-        switch (get_type_by_extension(acul::fs::get_extension(path)))
+        switch (type)
         {
             case Type::bmp:
                 return acul::alloc<BMPLoader>();
@@ -114,4 +180,52 @@ namespace aecl::image
                 return nullptr;
         }
     }
+
+    Type get_type_by_signature(const u8 *data, size_t size)
+    {
+        if (has_signature(data, size, "\x89PNG\r\n\x1A\n", 8)) return Type::png;
+        if (has_signature(data, size, "\xFF\xD8\xFF", 3)) return Type::jpeg;
+        if (has_signature(data, size, "GIF87a", 6) || has_signature(data, size, "GIF89a", 6)) return Type::gif;
+        if (has_signature(data, size, "BM", 2)) return Type::bmp;
+        if (has_signature(data, size, "\x76\x2F\x31\x01", 4)) return Type::openexr;
+        if (has_signature(data, size, "II*\0", 4) || has_signature(data, size, "MM\0*", 4)) return Type::tiff;
+        if (has_signature(data, size, "RIFF", 4) && has_signature(data, size, "WEBP", 4, 8)) return Type::webp;
+        if (has_signature(data, size, "#?RADIANCE", 10) || has_signature(data, size, "#?RGBE", 6)) return Type::hdr;
+        if (size >= 3 && data[0] == 'P' && data[1] >= '1' && data[1] <= '6' &&
+            (data[2] == ' ' || data[2] == '\t' || data[2] == '\r' || data[2] == '\n'))
+            return Type::pbm;
+        if (has_signature(data, size, "ftyp", 4, 4))
+        {
+            static const char *brands[] = {"heic", "heix", "hevc", "hevx", "heim", "heis", "mif1", "msf1", "avif",
+                                           "avis"};
+            for (auto *brand : brands)
+                if (has_signature(data, size, brand, 4, 8)) return Type::heif;
+        }
+        return Type::unknown;
+    }
+
+    static CodecTable<Codec> &get_codec_table()
+    {
+        static CodecTable<Codec> table;
+        return table;
+    }
+
+    void register_importer(const Codec &codec) { get_codec_table().add(codec); }
+
+    ILoader *get_importer_by_path(const acul::string &path)
+    {
+        auto &table = get_codec_table();
+        const auto extension = acul::fs::get_extension(path);
+        Codec codec;
+        if (table.find_by_extension(extension, codec) && codec.create) return codec.create();
+
+        // The signature wins over the extension for the built-in formats, a file may be misnamed
+        u8 head[max_signature_size];
+        const size_t size = io::read_file_head(path, head, sizeof(head));
+        Type type = get_type_by_signature(head, size);
+        if (type == Type::unknown) type = get_type_by_extension(extension);
+        if (type != Type::unknown) return create_builtin_loader(type);
+        if (table.find_by_signature(head, size, codec) && codec.create) return codec.create();
+        return nullptr;
+    }
 } // namespace aecl::image
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "compress.hpp"
+#include <algorithm>
+#include <zlib.h>
+#ifdef AECL_WITH_ZSTD
+    #include <zstd.h>
+#endif
+
+namespace aecl::io
+{
+    bool is_compression_supported(Compression type)
+    {
+#ifdef AECL_WITH_ZSTD
+        return true;
+#else
+        return type != Compression::zstd;
+#endif
+    }
+
+    static bool compress_gzip(int level, const Chunk &src, Chunk &dst)
+    {
+        z_stream stream{};
+        // 15 window bits + 16 selects the gzip wrapper
+        if (deflateInit2(&stream, level < 0 ? Z_DEFAULT_COMPRESSION : level, Z_DEFLATED, 15 + 16, 8,
+                         Z_DEFAULT_STRATEGY) != Z_OK)
+            return false;
+
+        // zlib counts in uInt, so chunks of 4 GB and more are fed and drained in steps
+        constexpr size_t max_step = size_t(1) << 30;
+        dst.resize(src.size() <= max_step ? deflateBound(&stream, static_cast<uLong>(src.size())) + 32
+                                          : src.size() / 2);
+        size_t in_offset = 0, out_offset = 0;
+        int result = Z_OK;
+        while (result == Z_OK)
+        {
+            if (stream.avail_in == 0)
+            {
+                const size_t step = std::min(max_step, src.size() - in_offset);
+                stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(src.data() + in_offset));
+                stream.avail_in = static_cast<uInt>(step);
+                in_offset += step;
+            }
+            if (out_offset == dst.size()) dst.resize(dst.size() * 2);
+            const size_t out_step = std::min(max_step, dst.size() - out_offset);
+            stream.next_out = reinterpret_cast<Bytef *>(dst.data() + out_offset);
+            stream.avail_out = static_cast<uInt>(out_step);
+            result = deflate(&stream, in_offset == src.size() ? Z_FINISH : Z_NO_FLUSH);
+            out_offset += out_step - stream.avail_out;
+        }
+        dst.resize(out_offset);
+        deflateEnd(&stream);
+        return result == Z_STREAM_END;
+    }
+
+#ifdef AECL_WITH_ZSTD
+    static bool compress_zstd(int level, const Chunk &src, Chunk &dst)
+    {
+        dst.resize(ZSTD_compressBound(src.size()));
+        size_t size =
+            ZSTD_compress(dst.data(), dst.size(), src.data(), src.size(), level < 0 ? ZSTD_CLEVEL_DEFAULT : level);
+        if (ZSTD_isError(size)) return false;
+        dst.resize(size);
+        return true;
+    }
+#endif
+
+    bool compress_chunk(Compression type, int level, const Chunk &src, Chunk &dst)
+    {
+        switch (type)
+        {
+            case Compression::gzip:
+                return compress_gzip(level, src, dst);
+#ifdef AECL_WITH_ZSTD
+            case Compression::zstd:
+                return compress_zstd(level, src, dst);
+#endif
+            case Compression::none:
+                dst = src;
+                return true;
+            default:
+                return false;
+        }
+    }
+} // namespace aecl::io
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <acul/vector.hpp>
+
+namespace aecl::io
+{
+    using Chunk = acul::vector<char>;
+
+    enum class Compression
+    {
+        none,
+        gzip,
+        zstd
+    };
+
+    // Whether the codec was compiled in
+    bool is_compression_supported(Compression type);
+
+    /**
+     * Compress a chunk into a self-contained gzip member or zstd frame. Members of consecutive chunks
+     * concatenate into a valid stream, so chunks can be compressed independently and in parallel.
+     * @param level Codec compression level, the codec default if negative
+     **/
+    bool compress_chunk(Compression type, int level, const Chunk &src, Chunk &dst);
+} // namespace aecl::io
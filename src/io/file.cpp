@@ -0,0 +1,190 @@
+#include "file.hpp"
+#include <acul/io/fs/file.hpp>
+#include <cstring>
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/stat.h>
+#endif
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <linux/fs.h>
+    #include <sys/ioctl.h>
+    #include <unistd.h>
+#endif
+
+namespace aecl::io
+{
+#ifdef _WIN32
+    acul::vector<wchar_t> to_wide_path(const acul::string &path)
+    {
+        int size = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+        acul::vector<wchar_t> wide(size > 0 ? size : 1, L'\0');
+        if (size > 0) MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, wide.data(), size);
+        return wide;
+    }
+
+    u64 get_file_size(const acul::string &path)
+    {
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (!GetFileAttributesExW(to_wide_path(path).data(), GetFileExInfoStandard, &data)) return 0;
+        return (static_cast<u64>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    }
+#else
+    u64 get_file_size(const acul::string &path)
+    {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) return 0;
+        return static_cast<u64>(st.st_size);
+    }
+#endif
+
+#ifdef __linux__
+    // Copy the rest of in to out starting at the current offsets
+    static bool copy_range(int in, int out, off_t remaining)
+    {
+        // copy_file_range is unsupported across filesystems on older kernels, fall back to plain reads
+        while (remaining > 0)
+        {
+            ssize_t copied = copy_file_range(in, nullptr, out, nullptr, remaining, 0);
+            if (copied <= 0) break;
+            remaining -= copied;
+        }
+        char buffer[64 * 1024];
+        while (remaining > 0)
+        {
+            ssize_t size = read(in, buffer, sizeof(buffer));
+            if (size <= 0) return false;
+            for (ssize_t offset = 0; offset < size;)
+            {
+                ssize_t written = write(out, buffer + offset, size - offset);
+                if (written <= 0) return false;
+                offset += written;
+            }
+            remaining -= size;
+        }
+        return true;
+    }
+
+    bool copy_file(const acul::string &src, const acul::string &dst)
+    {
+        int in = open(src.c_str(), O_RDONLY | O_CLOEXEC);
+        if (in < 0) return false;
+        struct stat st;
+        if (fstat(in, &st) != 0)
+        {
+            close(in);
+            return false;
+        }
+        int out = open(dst.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 0777);
+        if (out < 0)
+        {
+            close(in);
+            return false;
+        }
+        bool success = false;
+    #ifdef FICLONE
+        success = ioctl(out, FICLONE, in) == 0;
+    #endif
+        if (!success) success = copy_range(in, out, st.st_size);
+        close(in);
+        return close(out) == 0 && success;
+    }
+#else
+    bool copy_file(const acul::string &src, const acul::string &dst)
+    {
+        return acul::fs::copy_file(src.c_str(), dst.c_str(), true);
+    }
+#endif
+
+    size_t read_file_head(const acul::string &path, void *dst, size_t size)
+    {
+#ifdef _WIN32
+        FILE *file = _wfopen(to_wide_path(path).data(), L"rb");
+#else
+        FILE *file = fopen(path.c_str(), "rb");
+#endif
+        if (!file) return 0;
+        size_t read = fread(dst, 1, size, file);
+        fclose(file);
+        return read;
+    }
+
+    bool read_line_blocks(const acul::string &path, size_t block_size,
+                          acul::unique_function<bool(char *, size_t)> callback)
+    {
+#ifdef _WIN32
+        FILE *file = _wfopen(to_wide_path(path).data(), L"rb");
+#else
+        FILE *file = fopen(path.c_str(), "rb");
+#endif
+        if (!file) return false;
+        acul::vector<char> buffer(block_size);
+        size_t carry = 0;
+        bool success = true;
+        for (;;)
+        {
+            if (carry == buffer.size()) buffer.resize(buffer.size() * 2); // A line longer than the block
+            const size_t read = fread(buffer.data() + carry, 1, buffer.size() - carry, file);
+            const size_t size = carry + read;
+            if (read == 0)
+            {
+                if (ferror(file)) success = false;
+                else if (size > 0) callback(buffer.data(), size);
+                break;
+            }
+
+            // End the block after its last complete line, the partial line is carried over to the next block
+            size_t end = size;
+            if (!feof(file))
+            {
+                while (end > 0 && buffer[end - 1] != '\n') --end;
+                if (end == 0)
+                {
+                    carry = size;
+                    continue;
+                }
+            }
+            if (!callback(buffer.data(), end)) break;
+            carry = size - end;
+            memmove(buffer.data(), buffer.data() + end, carry);
+        }
+        fclose(file);
+        return success;
+    }
+
+    acul::string make_unique_filename(const acul::string &name, acul::hashset<acul::string> &names)
+    {
+        if (names.insert(name).second) return name;
+        size_t dot = name.rfind('.');
+        if (dot == acul::string::npos || dot == 0) dot = name.size();
+        const acul::string stem(name.c_str(), dot);
+        const char *extension = name.c_str() + dot;
+        for (size_t n = 1;; ++n)
+        {
+            acul::string candidate = acul::format("%s_%zu%s", stem.c_str(), n, extension);
+            if (names.insert(candidate).second) return candidate;
+        }
+    }
+
+    bool FileSink::open(const acul::string &path)
+    {
+        close();
+#ifdef _WIN32
+        _file = _wfopen(to_wide_path(path).data(), L"wb");
+#else
+        _file = fopen(path.c_str(), "wb");
+#endif
+        if (!_file) return false;
+        setvbuf(_file, nullptr, _IONBF, 0);
+        return true;
+    }
+
+    bool FileSink::close()
+    {
+        if (!_file) return true;
+        bool success = fclose(_file) == 0;
+        _file = nullptr;
+        return success;
+    }
+} // namespace aecl::io
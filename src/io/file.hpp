@@ -0,0 +1,61 @@
+#pragma once
+
+#include <acul/functional/unique_function.hpp>
+#include <acul/hash/hashset.hpp>
+#include <acul/scalars.hpp>
+#include <acul/string/string.hpp>
+#include <acul/vector.hpp>
+#include <aecl/sink.hpp>
+#include <cstdio>
+
+namespace aecl::io
+{
+    // Get the size of a file in bytes. Returns 0 if the file can't be queried.
+    u64 get_file_size(const acul::string &path);
+
+    /**
+     * Copy a file, overwriting the destination. On Linux the copy is first attempted as a reflink (FICLONE),
+     * then with copy_file_range so the data does not pass through user space.
+     * @return true if the whole file was copied
+     **/
+    bool copy_file(const acul::string &src, const acul::string &dst);
+
+    // Read up to size bytes from the start of a file. Returns the number of bytes read, 0 on failure.
+    size_t read_file_head(const acul::string &path, void *dst, size_t size);
+
+    /**
+     * Read a file in blocks of about block_size bytes which end at line boundaries. A line longer than the
+     * block grows it. The callback returns false to stop the read before the next block.
+     * @return false if the file could not be read
+     **/
+    bool read_line_blocks(const acul::string &path, size_t block_size,
+                          acul::unique_function<bool(char *, size_t)> callback);
+
+    /**
+     * Get a file name not yet in names and add it to them. A taken name gets the first free counter before its
+     * extension, so "albedo.png" becomes "albedo_1.png", then "albedo_2.png".
+     **/
+    acul::string make_unique_filename(const acul::string &name, acul::hashset<acul::string> &names);
+
+    // Sink writing straight to a file. Callers pass large blocks, so the stdio buffer is disabled.
+    class FileSink final : public ISink
+    {
+    public:
+        ~FileSink() { close(); }
+
+        bool open(const acul::string &path);
+
+        bool write(const void *data, size_t size) override { return fwrite(data, 1, size, _file) == size; }
+
+        // Returns false if the file could not be flushed
+        bool close();
+
+    private:
+        FILE *_file = nullptr;
+    };
+
+#ifdef _WIN32
+    // Convert a UTF-8 path to a null-terminated wide path
+    acul::vector<wchar_t> to_wide_path(const acul::string &path);
+#endif
+} // namespace aecl::io
@@ -0,0 +1,246 @@
+#include "json.hpp"
+#include <charconv>
+
+namespace aecl::io
+{
+    const JsonValue JsonValue::null_value;
+
+    const JsonValue &JsonValue::operator[](acul::string_view key) const
+    {
+        for (size_t i = 0; i < keys.size(); ++i)
+            if (keys[i] == key) return items[i];
+        return null_value;
+    }
+
+    static void append_utf8(acul::string &dst, u32 code)
+    {
+        if (code < 0x80) dst.push_back(static_cast<char>(code));
+        else if (code < 0x800)
+        {
+            dst.push_back(static_cast<char>(0xC0 | (code >> 6)));
+            dst.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+        else if (code < 0x10000)
+        {
+            dst.push_back(static_cast<char>(0xE0 | (code >> 12)));
+            dst.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            dst.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+        else
+        {
+            dst.push_back(static_cast<char>(0xF0 | (code >> 18)));
+            dst.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+            dst.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            dst.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+    }
+
+    static bool parse_hex4(const char *src, u32 &value)
+    {
+        auto result = std::from_chars(src, src + 4, value, 16);
+        return result.ec == std::errc() && result.ptr == src + 4;
+    }
+
+    acul::string JsonValue::str() const
+    {
+        acul::string dst;
+        dst.reserve(text.size());
+        const char *it = text.data(), *end = it + text.size();
+        while (it < end)
+        {
+            if (*it != '\\')
+            {
+                dst.push_back(*it++);
+                continue;
+            }
+            if (++it == end) break;
+            switch (char c = *it++)
+            {
+                case 'b':
+                    dst.push_back('\b');
+                    break;
+                case 'f':
+                    dst.push_back('\f');
+                    break;
+                case 'n':
+                    dst.push_back('\n');
+                    break;
+                case 'r':
+                    dst.push_back('\r');
+                    break;
+                case 't':
+                    dst.push_back('\t');
+                    break;
+                case 'u':
+                {
+                    u32 code = 0;
+                    if (end - it < 4 || !parse_hex4(it, code)) return dst;
+                    it += 4;
+                    // Surrogate pair
+                    u32 low = 0;
+                    if (code >= 0xD800 && code < 0xDC00 && end - it >= 6 && it[0] == '\\' && it[1] == 'u' &&
+                        parse_hex4(it + 2, low) && low >= 0xDC00 && low < 0xE000)
+                    {
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        it += 6;
+                    }
+                    append_utf8(dst, code);
+                }
+                break;
+                default:
+                    dst.push_back(c);
+                    break;
+            }
+        }
+        return dst;
+    }
+
+    // Recursive descent parser over the whole text
+    class JsonParser
+    {
+    public:
+        JsonParser(const char *data, size_t size) : _begin(data), _it(data), _end(data + size) {}
+
+        bool parse(JsonValue &root, acul::string &error)
+        {
+            bool success = parse_value(root, 0);
+            if (success)
+            {
+                skip_space();
+                if (_it != _end) return fail(error, "Unexpected trailing data");
+            }
+            if (!success) return fail(error, _reason);
+            return true;
+        }
+
+    private:
+        // Nesting limit, protects the stack against malicious documents
+        static constexpr int max_depth = 256;
+
+        const char *_begin, *_it, *_end;
+        const char *_reason = "Unexpected end of data";
+
+        bool fail(acul::string &error, const char *reason)
+        {
+            error = acul::format("JSON: %s at offset %zu", reason, static_cast<size_t>(_it - _begin));
+            return false;
+        }
+
+        bool invalid(const char *reason)
+        {
+            _reason = reason;
+            return false;
+        }
+
+        void skip_space()
+        {
+            while (_it < _end && (*_it == ' ' || *_it == '\n' || *_it == '\r' || *_it == '\t')) ++_it;
+        }
+
+        bool consume(char c)
+        {
+            skip_space();
+            if (_it < _end && *_it == c)
+            {
+                ++_it;
+                return true;
+            }
+            return false;
+        }
+
+        bool match(acul::string_view word)
+        {
+            if (static_cast<size_t>(_end - _it) < word.size() || acul::string_view(_it, word.size()) != word)
+                return invalid("Invalid literal");
+            _it += word.size();
+            return true;
+        }
+
+        bool parse_string(acul::string_view &text)
+        {
+            const char *begin = ++_it;
+            while (_it < _end && *_it != '"')
+            {
+                if (static_cast<unsigned char>(*_it) < 0x20) return invalid("Control character in string");
+                if (*_it == '\\' && ++_it == _end) break;
+                ++_it;
+            }
+            if (_it >= _end) return invalid("Unterminated string");
+            text = acul::string_view(begin, _it - begin);
+            ++_it;
+            return true;
+        }
+
+        bool parse_number(JsonValue &value)
+        {
+            const char *begin = _it;
+            if (*begin == '+') return invalid("Invalid number");
+            auto result = std::from_chars(_it, _end, value.number);
+            if (result.ec != std::errc() || result.ptr == begin) return invalid("Invalid number");
+            _it = result.ptr;
+            value.type = JsonValue::Type::number;
+            return true;
+        }
+
+        bool parse_value(JsonValue &value, int depth)
+        {
+            if (depth > max_depth) return invalid("Nesting too deep");
+            skip_space();
+            if (_it >= _end) return invalid("Unexpected end of data");
+            switch (*_it)
+            {
+                case '{':
+                {
+                    ++_it;
+                    value.type = JsonValue::Type::object;
+                    if (consume('}')) return true;
+                    do
+                    {
+                        skip_space();
+                        if (_it >= _end || *_it != '"') return invalid("Expected a member name");
+                        acul::string_view key;
+                        if (!parse_string(key)) return false;
+                        if (!consume(':')) return invalid("Expected ':'");
+                        value.keys.push_back(key);
+                        value.items.emplace_back();
+                        if (!parse_value(value.items.back(), depth + 1)) return false;
+                    } while (consume(','));
+                    return consume('}') || invalid("Expected '}'");
+                }
+                case '[':
+                {
+                    ++_it;
+                    value.type = JsonValue::Type::array;
+                    if (consume(']')) return true;
+                    do
+                    {
+                        value.items.emplace_back();
+                        if (!parse_value(value.items.back(), depth + 1)) return false;
+                    } while (consume(','));
+                    return consume(']') || invalid("Expected ']'");
+                }
+                case '"':
+                    value.type = JsonValue::Type::string;
+                    return parse_string(value.text);
+                case 't':
+                    value.type = JsonValue::Type::boolean;
+                    value.boolean = true;
+                    return match("true");
+                case 'f':
+                    value.type = JsonValue::Type::boolean;
+                    return match("false");
+                case 'n':
+                    return match("null");
+                default:
+                    return parse_number(value);
+            }
+        }
+    };
+
+    bool parse_json(const char *data, size_t size, JsonValue &root, acul::string &error)
+    {
+        root = JsonValue();
+        JsonParser parser(data, size);
+        return parser.parse(root, error);
+    }
+} // namespace aecl::io
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <acul/scalars.hpp>
+#include <acul/string/string.hpp>
+#include <acul/string/string_view.hpp>
+#include <acul/vector.hpp>
+
+namespace aecl::io
+{
+    /**
+     * @brief Parsed JSON value.
+     *
+     * Strings and keys are views into the parsed text, so the text must outlive the values. String escapes
+     * are only decoded by str().
+     **/
+    class JsonValue
+    {
+    public:
+        enum class Type : u8
+        {
+            null,
+            boolean,
+            number,
+            string,
+            array,
+            object
+        };
+
+        Type type = Type::null;
+        bool boolean = false;
+        f64 number = 0.0;
+        acul::string_view text;               // Raw string contents
+        acul::vector<JsonValue> items;        // Array elements or object member values
+        acul::vector<acul::string_view> keys; // Object member keys, in the order of items
+
+        bool is_null() const { return type == Type::null; }
+
+        // Array length or object member count
+        size_t size() const { return items.size(); }
+
+        // Array element, a null value if out of range
+        const JsonValue &operator[](size_t index) const { return index < items.size() ? items[index] : null_value; }
+
+        // Object member, a null value if missing
+        const JsonValue &operator[](acul::string_view key) const;
+
+        f64 as_number(f64 fallback = 0.0) const { return type == Type::number ? number : fallback; }
+
+        // Non-negative integer number, the fallback otherwise
+        i64 as_index(i64 fallback = -1) const
+        {
+            return type == Type::number && number >= 0 && number <= 4294967295.0 ? static_cast<i64>(number) : fallback;
+        }
+
+        // Decoded string
+        acul::string str() const;
+
+    private:
+        static const JsonValue null_value;
+    };
+
+    /**
+     * Parse a JSON document.
+     * @param error Position and reason of the failure
+     * @return true if the whole text is a valid document
+     **/
+    bool parse_json(const char *data, size_t size, JsonValue &root, acul::string &error);
+} // namespace aecl::io
@@ -0,0 +1,92 @@
+#include "mapped_file.hpp"
+#include "file.hpp"
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace aecl::io
+{
+#ifdef _WIN32
+    bool MappedFile::open(const acul::string &path)
+    {
+        close();
+        _file = CreateFileW(to_wide_path(path).data(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (_file == INVALID_HANDLE_VALUE)
+        {
+            _file = nullptr;
+            return false;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(_file, &size))
+        {
+            close();
+            return false;
+        }
+        _size = static_cast<size_t>(size.QuadPart);
+        if (_size == 0) return true;
+        _mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!_mapping)
+        {
+            close();
+            return false;
+        }
+        _data = static_cast<const char *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!_data)
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (_data) UnmapViewOfFile(_data);
+        if (_mapping) CloseHandle(_mapping);
+        if (_file) CloseHandle(_file);
+        _data = nullptr;
+        _mapping = nullptr;
+        _file = nullptr;
+        _size = 0;
+    }
+#else
+    bool MappedFile::open(const acul::string &path)
+    {
+        close();
+        _fd = ::open(path.c_str(), O_RDONLY);
+        if (_fd == -1) return false;
+        struct stat st;
+        if (fstat(_fd, &st) != 0)
+        {
+            close();
+            return false;
+        }
+        _size = static_cast<size_t>(st.st_size);
+        if (_size == 0) return true;
+        void *data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+        if (data == MAP_FAILED)
+        {
+            close();
+            return false;
+        }
+        madvise(data, _size, MADV_SEQUENTIAL);
+        _data = static_cast<const char *>(data);
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (_data) munmap(const_cast<char *>(_data), _size);
+        if (_fd != -1) ::close(_fd);
+        _data = nullptr;
+        _fd = -1;
+        _size = 0;
+    }
+#endif
+} // namespace aecl::io
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <acul/string/string.hpp>
+
+namespace aecl::io
+{
+    // Read-only memory mapping of a whole file
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile() { close(); }
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        // Map the file. Sequential access is advised to the OS.
+        bool open(const acul::string &path);
+
+        void close();
+
+        const char *data() const { return _data; }
+
+        size_t size() const { return _size; }
+
+    private:
+        const char *_data = nullptr;
+        size_t _size = 0;
+#ifdef _WIN32
+        void *_file = nullptr;
+        void *_mapping = nullptr;
+#else
+        int _fd = -1;
+#endif
+    };
+} // namespace aecl::io
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <acul/string/string_view.hpp>
+#include <acul/vector.hpp>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace aecl::io
+{
+    namespace detail
+    {
+        constexpr char digit_pairs[201] =
+            "0001020304050607080910111213141516171819"
+            "2021222324252627282930313233343536373839"
+            "4041424344454647484950515253545556575859"
+            "6061626364656667686970717273747576777879"
+            "8081828384858687888990919293949596979899";
+    } // namespace detail
+
+    // Write an unsigned integer without a terminating null. Returns the end of the written text.
+    inline char *write_uint(char *dst, u32 value)
+    {
+        char buffer[10];
+        char *end = buffer + sizeof(buffer);
+        char *it = end;
+        while (value >= 100)
+        {
+            const u32 pair = (value % 100) * 2;
+            value /= 100;
+            it -= 2;
+            memcpy(it, detail::digit_pairs + pair, 2);
+        }
+        if (value >= 10)
+        {
+            it -= 2;
+            memcpy(it, detail::digit_pairs + value * 2, 2);
+        }
+        else *--it = static_cast<char>('0' + value);
+        const size_t size = end - it;
+        memcpy(dst, it, size);
+        return dst + size;
+    }
+
+    /**
+     * Write a float without a terminating null. Returns the end of the written text.
+     * @param precision Digits after the decimal point. Shortest round-trip representation if negative
+     **/
+    inline char *write_float(char *dst, f32 value, int precision)
+    {
+        // Enough for any f32 in fixed notation with up to 9 digits after the point
+        constexpr size_t max_size = 64;
+        auto result = precision < 0 ? std::to_chars(dst, dst + max_size, value)
+                                    : std::to_chars(dst, dst + max_size, value, std::chars_format::fixed,
+                                                    std::min(precision, 9));
+        return result.ptr;
+    }
+
+    /**
+     * @brief Growable text buffer with locale-free number formatting.
+     *
+     * Replaces stream formatting on hot export paths: numbers are written straight into the buffer
+     * and the result is taken out as a chunk without copying.
+     **/
+    class TextBuffer
+    {
+    public:
+        // Upper bound of the size of a single formatted number
+        static constexpr size_t max_number_size = 64;
+
+        explicit TextBuffer(int precision = -1) : _precision(precision) {}
+
+        size_t size() const { return _size; }
+
+        bool empty() const { return _size == 0; }
+
+        const char *data() const { return _data.data(); }
+
+        int precision() const { return _precision; }
+
+        // Get space for at least n more chars
+        char *ensure(size_t n)
+        {
+            if (_size + n > _data.size()) _data.resize(std::max(_data.size() * 2, _size + n));
+            return _data.data() + _size;
+        }
+
+        void reserve(size_t n) { ensure(n); }
+
+        // Mark n chars written past ensure() as used
+        void commit(size_t n) { _size += n; }
+
+        void append(const char *text, size_t size)
+        {
+            memcpy(ensure(size), text, size);
+            _size += size;
+        }
+
+        void append(acul::string_view text) { append(text.data(), text.size()); }
+
+        void append(char c)
+        {
+            *ensure(1) = c;
+            ++_size;
+        }
+
+        void append_uint(u32 value) { _size = write_uint(ensure(10), value) - _data.data(); }
+
+        void append_float(f32 value) { _size = write_float(ensure(max_number_size), value, _precision) - _data.data(); }
+
+        // Writes "<token> x y z\n"
+        template <typename V>
+        void append_vec3(acul::string_view token, const V &v)
+        {
+            char *dst = ensure(token.size() + max_number_size * 3 + 4);
+            memcpy(dst, token.data(), token.size());
+            dst += token.size();
+            *dst++ = ' ';
+            dst = write_float(dst, v.x, _precision);
+            *dst++ = ' ';
+            dst = write_float(dst, v.y, _precision);
+            *dst++ = ' ';
+            dst = write_float(dst, v.z, _precision);
+            *dst++ = '\n';
+            _size = dst - _data.data();
+        }
+
+        // Writes "<token> x y\n"
+        template <typename V>
+        void append_vec2(acul::string_view token, const V &v)
+        {
+            char *dst = ensure(token.size() + max_number_size * 2 + 3);
+            memcpy(dst, token.data(), token.size());
+            dst += token.size();
+            *dst++ = ' ';
+            dst = write_float(dst, v.x, _precision);
+            *dst++ = ' ';
+            dst = write_float(dst, v.y, _precision);
+            *dst++ = '\n';
+            _size = dst - _data.data();
+        }
+
+        // Move the text out as a chunk and reset the buffer
+        acul::vector<char> take()
+        {
+            _data.resize(_size);
+            _size = 0;
+            acul::vector<char> chunk = std::move(_data);
+            _data = acul::vector<char>();
+            return chunk;
+        }
+
+    private:
+        acul::vector<char> _data;
+        size_t _size = 0;
+        int _precision;
+    };
+} // namespace aecl::io
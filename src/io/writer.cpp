@@ -0,0 +1,151 @@
+#include "writer.hpp"
+#include <oneapi/tbb/task_arena.h>
+#ifdef _WIN32
+    #include "file.hpp"
+#else
+    #include <fcntl.h>
+#endif
+
+namespace aecl::io
+{
+    bool StreamWriter::open(const acul::string &path, size_t queue_depth, bool drop_cache, Compression compression,
+                            int level)
+    {
+        close();
+#ifdef _WIN32
+        _file = _wfopen(to_wide_path(path).data(), L"wb");
+#else
+        _file = fopen(path.c_str(), "wb");
+#endif
+        if (!_file) return false;
+        // Chunks are already large, skip the stdio buffer
+        setvbuf(_file, nullptr, _IONBF, 0);
+#if defined(__linux__)
+        posix_fadvise(fileno(_file), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        _drop_cache = drop_cache;
+        start(queue_depth, compression, level);
+        return true;
+    }
+
+    bool StreamWriter::open(ISink *sink, size_t queue_depth, Compression compression, int level)
+    {
+        close();
+        if (!sink) return false;
+        _sink = sink;
+        _drop_cache = false;
+        start(queue_depth, compression, level);
+        return true;
+    }
+
+    void StreamWriter::start(size_t queue_depth, Compression compression, int level)
+    {
+        _compression = compression;
+        _level = level;
+        _queue_depth = std::max<size_t>(1, queue_depth);
+        if (compression != Compression::none)
+            _queue_depth = std::max<size_t>(_queue_depth, oneapi::tbb::this_task_arena::max_concurrency() + 1);
+        _offset = 0;
+        _closing = false;
+        _failed = false;
+        _thread = std::thread(&StreamWriter::run, this);
+    }
+
+    void StreamWriter::push(Chunk &&chunk)
+    {
+        if (chunk.empty()) return;
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_compression != Compression::none && _queue.size() >= _queue_depth)
+        {
+            // The writer waits for the oldest chunk to be compressed. Help with the pending tasks instead of
+            // blocking, there may be no other thread to run them
+            lock.unlock();
+            _tasks.wait();
+            lock.lock();
+        }
+        _popped.wait(lock, [this] { return _queue.size() < _queue_depth; });
+        if (_compression == Compression::none)
+        {
+            _queue.push_back({std::move(chunk), true});
+            lock.unlock();
+            _pushed.notify_one();
+            return;
+        }
+        Slot *slot = &_queue.emplace_back(Slot{std::move(chunk), false});
+        lock.unlock();
+        _tasks.run([this, slot] {
+            Chunk compressed;
+            if (!compress_chunk(_compression, _level, slot->data, compressed)) _failed = true;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                slot->data = std::move(compressed);
+                slot->ready = true;
+            }
+            _pushed.notify_one();
+        });
+    }
+
+    bool StreamWriter::close()
+    {
+        if (!_file && !_sink) return !_failed;
+        _tasks.wait();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closing = true;
+        }
+        _pushed.notify_one();
+        if (_thread.joinable()) _thread.join();
+        if (_file && fclose(_file) != 0) _failed = true;
+        _file = nullptr;
+        _sink = nullptr;
+        return !_failed;
+    }
+
+    void StreamWriter::run()
+    {
+        size_t previous_offset = 0, previous_size = 0;
+        while (true)
+        {
+            Chunk chunk;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _pushed.wait(lock, [this] { return _queue.empty() ? _closing : _queue.front().ready; });
+                if (_queue.empty()) return;
+                chunk = std::move(_queue.front().data);
+                _queue.pop_front();
+            }
+            _popped.notify_one();
+            if (_failed) continue; // Keep draining so producers are never blocked
+            bool written = _sink ? _sink->write(chunk.data(), chunk.size())
+                                 : fwrite(chunk.data(), 1, chunk.size(), _file) == chunk.size();
+            if (!written)
+            {
+                _failed = true;
+                continue;
+            }
+            if (_drop_cache)
+            {
+                // Drop the previous chunk once it is on disk, while the current one is written back
+                drop_written(previous_offset, previous_size);
+                previous_offset = _offset;
+                previous_size = chunk.size();
+            }
+            _offset += chunk.size();
+        }
+    }
+
+    void StreamWriter::drop_written(size_t offset, size_t size)
+    {
+#if defined(__linux__)
+        const int fd = fileno(_file);
+        sync_file_range(fd, _offset, 0, SYNC_FILE_RANGE_WRITE);
+        if (size == 0) return;
+        sync_file_range(fd, offset, size,
+                        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+        posix_fadvise(fd, offset, size, POSIX_FADV_DONTNEED);
+#else
+        (void)offset;
+        (void)size;
+#endif
+    }
+} // namespace aecl::io
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <acul/string/string.hpp>
+#include <aecl/sink.hpp>
+#include <acul/vector.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <oneapi/tbb/task_group.h>
+#include <thread>
+#include "compress.hpp"
+
+namespace aecl::io
+{
+    /**
+     * @brief Writes chunks to a file or a sink on a dedicated thread.
+     *
+     * Chunks are passed through a bounded queue, so producers format the next chunk while the previous
+     * ones are written, and the memory in flight never exceeds (queue depth + 1) chunks.
+     * With compression enabled every queued chunk is compressed by its own task and the results are
+     * written in push order.
+     **/
+    class StreamWriter
+    {
+    public:
+        ~StreamWriter() { close(); }
+
+        /**
+         * @brief Open the file and start the writer thread
+         * @param path Path to the output file
+         * @param queue_depth Max count of queued chunks. Producers block while the queue is full
+         * @param drop_cache Drop the written pages from the OS page cache (Linux only)
+         * @param compression Codec applied to the chunks. The queue is deepened to keep all threads busy
+         * @param level Codec compression level, the codec default if negative
+         **/
+        bool open(const acul::string &path, size_t queue_depth = 3, bool drop_cache = false,
+                  Compression compression = Compression::none, int level = -1);
+
+        // Start the writer thread over a sink. The sink must outlive close()
+        bool open(ISink *sink, size_t queue_depth = 3, Compression compression = Compression::none, int level = -1);
+
+        // Queue a chunk for writing. Blocks while the queue is full.
+        void push(Chunk &&chunk);
+
+        // Write the remaining chunks and close the file. Returns false if any write failed.
+        bool close();
+
+        bool failed() const { return _failed; }
+
+    private:
+        FILE *_file = nullptr;
+        ISink *_sink = nullptr;
+        std::thread _thread;
+        std::mutex _mutex;
+        std::condition_variable _pushed, _popped;
+        struct Slot
+        {
+            Chunk data;
+            bool ready;
+        };
+
+        // Element references of a deque stay valid while other slots are pushed and popped
+        std::deque<Slot> _queue;
+        oneapi::tbb::task_group _tasks;
+        Compression _compression = Compression::none;
+        int _level = -1;
+        size_t _queue_depth = 3;
+        size_t _offset = 0;
+        bool _drop_cache = false;
+        bool _closing = false;
+        std::atomic<bool> _failed{false};
+
+        void start(size_t queue_depth, Compression compression, int level);
+        void run();
+        void drop_written(size_t offset, size_t size);
+    };
+} // namespace aecl::io
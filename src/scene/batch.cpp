@@ -0,0 +1,204 @@
+#include <acul/hash/hashmap.hpp>
+#include <aecl/scene/batch.hpp>
+#include <aecl/scene/registry.hpp>
+#include <algorithm>
+#include <memory>
+#include <oneapi/tbb/enumerable_thread_specific.h>
+#include <oneapi/tbb/parallel_for.h>
+#include "../io/file.hpp"
+
+namespace aecl::scene
+{
+    // Fixed point scale of the batch progress
+    constexpr u64 progress_scale = 1 << 24;
+
+    struct BatchTask
+    {
+        u64 size = 0;
+        u64 weight = 0; // Share of the batch progress in progress_scale units
+        ILoader *loader = nullptr;
+        ImportStats stats;
+        ProgressToken token;
+        std::atomic<u64> reported{0};
+
+        ~BatchTask() { acul::release(loader); }
+    };
+
+    BatchImporter::BatchImporter(const acul::vector<acul::string> &paths)
+    {
+        _entries.resize(paths.size());
+        for (size_t i = 0; i < paths.size(); ++i) _entries[i].path = paths[i];
+    }
+
+    static acul::string get_material_key(const umbf::MaterialInfo &info, const umbf::Material *material)
+    {
+        acul::string key = info.name;
+        key.push_back('\0');
+        if (material)
+        {
+            const auto &albedo = material->albedo;
+            key += acul::format("%a %a %a %d", albedo.rgb.x, albedo.rgb.y, albedo.rgb.z,
+                                albedo.textured ? albedo.texture_id : -1);
+        }
+        return key;
+    }
+
+    /**
+     * Moves the materials and textures of the loaders into the merged lists in path order. Texture ids of the
+     * materials are rewritten to the merged list, duplicated materials fold their assignments into the first one
+     * and the material ranges referencing them are redirected.
+     **/
+    static void merge_materials(BatchTask *tasks, acul::vector<BatchImporter::Entry> &entries,
+                                acul::vector<acul::shared_ptr<umbf::File>> &materials,
+                                acul::vector<acul::shared_ptr<umbf::Target>> &textures)
+    {
+        acul::hashmap<acul::string, u32> texture_map;
+        acul::hashmap<acul::string, acul::shared_ptr<umbf::MaterialInfo>> material_map;
+        acul::hashmap<u64, u64> id_map; // Material id of a duplicate to the id of the merged material
+        for (size_t t = 0; t < entries.size(); ++t)
+        {
+            auto *loader = tasks[t].loader;
+            if (!loader) continue;
+            auto &file_textures = loader->textures();
+            acul::vector<int> texture_ids(file_textures.size());
+            for (size_t i = 0; i < file_textures.size(); ++i)
+            {
+                auto [it, inserted] = texture_map.emplace(file_textures[i]->url, textures.size());
+                if (inserted) textures.push_back(file_textures[i]);
+                texture_ids[i] = it->second;
+            }
+
+            for (auto &file : loader->materials())
+            {
+                umbf::Material *material = nullptr;
+                acul::shared_ptr<umbf::MaterialInfo> info;
+                for (auto &block : file->blocks)
+                    if (block->signature() == umbf::sign_block::material)
+                        material = static_cast<umbf::Material *>(block.get());
+                    else if (block->signature() == umbf::sign_block::material_info)
+                        info = acul::static_pointer_cast<umbf::MaterialInfo>(block);
+                if (material && material->albedo.textured)
+                {
+                    const int id = material->albedo.texture_id;
+                    const bool valid = id >= 0 && id < (int)texture_ids.size();
+                    material->albedo.textured = valid;
+                    material->albedo.texture_id = valid ? texture_ids[id] : -1;
+                }
+                if (!info)
+                {
+                    materials.push_back(file);
+                    continue;
+                }
+                auto [it, inserted] = material_map.emplace(get_material_key(*info, material), info);
+                if (inserted)
+                {
+                    materials.push_back(file);
+                    continue;
+                }
+                id_map[info->id] = it->second->id;
+                auto &assignments = it->second->assignments;
+                assignments.insert(assignments.end(), info->assignments.begin(), info->assignments.end());
+            }
+        }
+        if (id_map.empty()) return;
+
+        oneapi::tbb::parallel_for(size_t(0), entries.size(), [&](size_t e) {
+            for (auto &object : entries[e].objects)
+                for (auto &block : object.meta)
+                {
+                    if (block->signature() != umbf::sign_block::material_range) continue;
+                    auto *range = static_cast<umbf::MaterialRange *>(block.get());
+                    auto it = id_map.find(range->mat_id);
+                    if (it != id_map.end()) range->mat_id = it->second;
+                }
+        });
+    }
+
+    acul::op_result BatchImporter::load()
+    {
+        MemoryScope memory(_stats);
+        _materials.clear();
+        _textures.clear();
+        _error.clear();
+        const size_t count = _entries.size();
+        auto tasks = std::make_unique<BatchTask[]>(count);
+        acul::vector<size_t> order(count);
+        u64 total_size = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            _entries[i].objects.clear();
+            tasks[i].size = io::get_file_size(_entries[i].path);
+            total_size += tasks[i].size;
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return tasks[a].size > tasks[b].size; });
+
+        std::atomic<u64> done{0};
+        for (size_t i = 0; i < count && _progress; ++i)
+        {
+            auto &task = tasks[i];
+            task.weight = total_size ? progress_scale * task.size / total_size : progress_scale / count;
+            task.token.callback = [this, &task, &done](f32 value) {
+                if (is_cancelled(_progress)) task.token.cancel();
+                const u64 units = static_cast<u64>(task.weight * value);
+                u64 previous = task.reported.load();
+                while (units > previous && !task.reported.compare_exchange_weak(previous, units));
+                if (units <= previous) return;
+                const u64 total = done.fetch_add(units - previous) + units - previous;
+                report_progress(_progress, static_cast<f32>(total) / progress_scale);
+            };
+        }
+
+        // Nested parallel loops of a task executed in a single slot arena run on the calling thread only
+        const oneapi::tbb::task_arena serial(1, 1);
+        oneapi::tbb::enumerable_thread_specific<oneapi::tbb::task_arena> serial_arenas(serial);
+        oneapi::tbb::task_arena arena(max_concurrency);
+        arena.execute([&] {
+            oneapi::tbb::parallel_for(
+                oneapi::tbb::blocked_range<size_t>(0, count, 1),
+                [&](const oneapi::tbb::blocked_range<size_t> &range) {
+                    for (size_t i = range.begin(); i != range.end(); ++i)
+                    {
+                        auto &task = tasks[order[i]];
+                        auto &entry = _entries[order[i]];
+                        if (is_cancelled(_progress)) continue;
+                        task.loader = get_importer_by_path(entry.path);
+                        if (!task.loader)
+                        {
+                            entry.error = acul::format("Unsupported scene format: %s", entry.path.c_str());
+                            entry.result = acul::op_result(ACUL_OP_READ_ERROR, AECL_OP_DOMAIN, 0);
+                            continue;
+                        }
+                        if (_stats) task.loader->stats(&task.stats);
+                        if (_progress) task.loader->progress(&task.token);
+                        if (task.size < small_file_size)
+                            serial_arenas.local().execute([&] { entry.result = task.loader->load(); });
+                        else entry.result = task.loader->load();
+                        entry.error = task.loader->error();
+                        entry.objects = std::move(task.loader->objects());
+                        task.token.report(1.0f);
+                    }
+                },
+                oneapi::tbb::simple_partitioner());
+        });
+
+        if (_stats)
+            for (size_t i = 0; i < count; ++i) _stats->merge(tasks[i].stats);
+        if (is_cancelled(_progress))
+        {
+            for (auto &entry : _entries) entry.objects.clear();
+            _error = "Import cancelled";
+            return acul::op_result(ACUL_OP_READ_ERROR, AECL_OP_DOMAIN, AECL_OP_CODE_CANCELLED);
+        }
+
+        merge_materials(tasks.get(), _entries, _materials, _textures);
+        report_progress(_progress, 1.0f);
+        for (auto &entry : _entries)
+            if (!entry.result.success())
+            {
+                _error = acul::format("%s: %s", entry.path.c_str(), entry.error.c_str());
+                return entry.result;
+            }
+        return acul::make_op_success();
+    }
+} // namespace aecl::scene
@@ -0,0 +1,664 @@
+#include <acul/hash/hashset.hpp>
+#include <acul/io/fs/file.hpp>
+#include <acul/io/fs/path.hpp>
+#include <aecl/scene/gltf/export.hpp>
+#include <aecl/status.hpp>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <inttypes.h>
+#include <limits>
+#include <oneapi/tbb/parallel_for.h>
+#include <umbf/utils.hpp>
+#include "../../io/file.hpp"
+#include "../../io/text_buffer.hpp"
+#include "../transform.hpp"
+#include "gltf.hpp"
+
+namespace aecl::scene::gltf
+{
+    using range_t = oneapi::tbb::blocked_range<size_t>;
+
+    // Writes a JSON string literal
+    static void write_string(io::TextBuffer &json, acul::string_view str)
+    {
+        json.append('"');
+        for (char c : str)
+        {
+            switch (c)
+            {
+                case '"':
+                    json.append("\\\"");
+                    break;
+                case '\\':
+                    json.append("\\\\");
+                    break;
+                case '\n':
+                    json.append("\\n");
+                    break;
+                case '\r':
+                    json.append("\\r");
+                    break;
+                case '\t':
+                    json.append("\\t");
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        char escaped[8];
+                        snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        json.append(escaped, 6);
+                    }
+                    else json.append(c);
+            }
+        }
+        json.append('"');
+    }
+
+    // Writes `"key":` with the separator of the previous member
+    static void write_key(io::TextBuffer &json, acul::string_view key, bool first = false)
+    {
+        if (!first) json.append(',');
+        json.append('"');
+        json.append(key);
+        json.append("\":");
+    }
+
+    static void write_member(io::TextBuffer &json, acul::string_view key, u32 value, bool first = false)
+    {
+        write_key(json, key, first);
+        json.append_uint(value);
+    }
+
+    static void write_floats(io::TextBuffer &json, const f32 *values, size_t count)
+    {
+        json.append('[');
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (i) json.append(',');
+            json.append_float(values[i]);
+        }
+        json.append(']');
+    }
+
+    // Per-object export state. Buffer views point into the source model or into the arrays owned here.
+    struct Exporter::MeshSegment
+    {
+        struct Primitive
+        {
+            const u32 *indices = nullptr; // Contiguous range of the model indices, used in place
+            acul::vector<u32> owned;      // Gathered indices otherwise
+            size_t count = 0;
+            i64 material = -1;
+            u32 accessor = 0;
+
+            const u32 *data() const { return indices ? indices : owned.data(); }
+        };
+
+        acul::shared_ptr<umbf::mesh::Mesh> mesh;
+        acul::string name;
+        bool in_place = false; // Vertices are written as stored in the model
+        acul::vector<amal::vec3> positions;
+        acul::vector<amal::vec3> normals;
+        acul::vector<amal::vec2> uvs;
+        amal::vec3 min, max;
+        acul::vector<Primitive> primitives;
+        u32 position_accessor = 0;
+        u32 normal_accessor = 0;
+        u32 uv_accessor = 0;
+        u32 op_code = 0;
+        acul::string error;
+    };
+
+    /**
+     * Index run of a material range. The model indices are used in place when the faces cover one contiguous
+     * run of the index buffer and the winding is kept, otherwise they are gathered into `owned`.
+     * @return Index count
+     **/
+    static size_t gather_indices(const umbf::mesh::Model &model, const acul::vector<u32> &faces, bool flip,
+                                 const u32 *&indices, acul::vector<u32> &owned)
+    {
+        const u32 first = model.faces[faces.front()].first_vertex;
+        u32 next = first;
+        bool contiguous = !flip;
+        size_t count = 0;
+        for (u32 f : faces)
+        {
+            auto &face = model.faces[f];
+            contiguous = contiguous && face.first_vertex == next && face.count % 3 == 0;
+            next = face.first_vertex + face.count;
+            count += face.count - face.count % 3;
+        }
+        if (contiguous)
+        {
+            indices = model.indices.data() + first;
+            return count;
+        }
+
+        owned.resize(count);
+        u32 *dst = owned.data();
+        for (u32 f : faces)
+        {
+            auto &face = model.faces[f];
+            const u32 *ids = model.indices.data() + face.first_vertex;
+            for (u32 t = 0; t < face.count / 3; ++t, ids += 3, dst += 3)
+            {
+                dst[0] = ids[0];
+                dst[1] = ids[flip ? 2 : 1];
+                dst[2] = ids[flip ? 1 : 2];
+            }
+        }
+        return count;
+    }
+
+    void Exporter::prepare_mesh(const umbf::Object &object, MeshSegment &segment)
+    {
+        acul::vector<acul::shared_ptr<umbf::MaterialRange>> assignes;
+        for (auto &block : object.meta)
+        {
+            switch (block->signature())
+            {
+                case umbf::sign_block::mesh:
+                    segment.mesh = acul::static_pointer_cast<umbf::mesh::Mesh>(block);
+                    break;
+                case umbf::sign_block::material_range:
+                    assignes.push_back(acul::static_pointer_cast<umbf::MaterialRange>(block));
+                    break;
+            }
+        }
+        if (!segment.mesh)
+        {
+            segment.error = acul::format("Mesh block not found in object: 0x%" PRIx64, object.id);
+            segment.op_code = AECL_OP_CODE_MESH_ERROR;
+            return;
+        }
+        segment.name = object.name;
+        const auto &model = segment.mesh->model;
+        auto &vertices = model.vertices;
+        if (vertices.empty() || model.faces.empty()) return;
+
+        AxisTransform transform(mesh_flags);
+        const bool uv = mesh_flags & MeshExportFlagBits::export_uv;
+        const bool normals = mesh_flags & MeshExportFlagBits::export_normals;
+        segment.in_place = transform.identity() && !(uv && flip_uv);
+        if (!segment.in_place)
+        {
+            segment.positions.resize(vertices.size());
+            if (normals) segment.normals.resize(vertices.size());
+            if (uv) segment.uvs.resize(vertices.size());
+            oneapi::tbb::parallel_for(range_t(0, vertices.size()), [&](const range_t &range) {
+                const size_t begin = range.begin();
+                transform.apply(
+                    range.size(), [&](size_t i) -> const amal::vec3 & { return vertices[begin + i].pos; },
+                    segment.positions.data() + begin);
+                if (normals)
+                    transform.apply(
+                        range.size(), [&](size_t i) -> const amal::vec3 & { return vertices[begin + i].normal; },
+                        segment.normals.data() + begin);
+                if (uv)
+                    for (size_t i = begin; i != range.end(); ++i)
+                    {
+                        auto &src = vertices[i].uv;
+                        segment.uvs[i] = {src.x, flip_uv ? 1.0f - src.y : src.y};
+                    }
+            });
+        }
+
+        // POSITION accessors require bounds
+        auto position = [&](size_t i) -> const amal::vec3 & {
+            return segment.in_place ? vertices[i].pos : segment.positions[i];
+        };
+        segment.min = segment.max = position(0);
+        for (size_t i = 1; i < vertices.size(); ++i)
+        {
+            segment.min = amal::min(segment.min, position(i));
+            segment.max = amal::max(segment.max, position(i));
+        }
+
+        acul::vector<acul::shared_ptr<umbf::MaterialRange>> assignes_attr;
+        auto default_mat_id_it =
+            std::find_if(assignes.begin(), assignes.end(),
+                         [](const acul::shared_ptr<umbf::MaterialRange> &range) { return range->faces.empty(); });
+        u64 default_mat_id = default_mat_id_it == assignes.end() ? 0 : (*default_mat_id_it)->mat_id;
+        umbf::utils::filter_mat_assignments(assignes, model.faces.size(), default_mat_id, assignes_attr);
+        for (auto &assign : assignes_attr)
+        {
+            if (assign->faces.empty()) continue;
+            MeshSegment::Primitive primitive;
+            if (material_flags != MaterialExportFlags::none && assign->mat_id != 0)
+            {
+                auto it = _material_ids.find(assign->mat_id);
+                if (it == _material_ids.end())
+                {
+                    segment.error = acul::format("Material not found: 0x%" PRIx64, assign->mat_id);
+                    segment.op_code |= AECL_OP_CODE_MATERIAL_ERROR;
+                }
+                else primitive.material = it->second;
+            }
+            primitive.count =
+                gather_indices(model, assign->faces, transform.flip_winding, primitive.indices, primitive.owned);
+            if (primitive.count > 0) segment.primitives.push_back(std::move(primitive));
+        }
+    }
+
+    void Exporter::collect_materials()
+    {
+        _material_ids.clear();
+        _materials.clear();
+        _images.clear();
+        if (material_flags == MaterialExportFlags::none) return;
+
+        acul::hashmap<u32, u32> image_ids; // Texture index to the index in _images
+        for (auto &material : materials)
+        {
+            acul::shared_ptr<umbf::Material> ptr;
+            for (auto &block : material.blocks)
+            {
+                switch (block->signature())
+                {
+                    case umbf::sign_block::material:
+                        ptr = acul::static_pointer_cast<umbf::Material>(block);
+                        break;
+                    case umbf::sign_block::material_info:
+                    {
+                        MaterialEntry entry{acul::static_pointer_cast<umbf::MaterialInfo>(block), ptr};
+                        if (ptr && ptr->albedo.textured && material_flags != MaterialExportFlags::texture_none)
+                        {
+                            u32 texture_id = ptr->albedo.texture_id;
+                            auto [it, inserted] = image_ids.emplace(texture_id, _images.size());
+                            if (inserted) _images.push_back({textures[texture_id], {}, {}, true});
+                            entry.image = it->second;
+                        }
+                        auto [it, inserted] = _material_ids.emplace(entry.info->id, _materials.size());
+                        if (inserted) _materials.push_back(entry);
+                        else _materials[it->second] = entry;
+                    }
+                    break;
+                    default:
+                        break;
+                }
+            }
+        }
+    }
+
+    void Exporter::copy_textures(oneapi::tbb::task_group &tasks)
+    {
+        if (material_flags != MaterialExportFlags::texture_copy || _images.empty()) return;
+
+        // Images are named in their order, a name already taken by another source gets a counter
+        acul::path tex_dir = acul::path(path).parent_path() / "tex";
+        acul::hashset<acul::string> names;
+        for (auto &image : _images)
+        {
+            acul::string name = io::make_unique_filename(acul::fs::get_filename(image.uri), names);
+            image.source = image.uri;
+            image.target = (tex_dir / name).str();
+            image.uri = "tex/" + name;
+            image.done = false;
+        }
+
+        tasks.run([this] {
+            oneapi::tbb::parallel_for(size_t(0), _images.size(), [this](size_t i) {
+                auto &image = _images[i];
+                image.done = io::copy_file(image.source, image.target);
+            });
+        });
+    }
+
+    void Exporter::write_materials(io::TextBuffer &json)
+    {
+        if (_materials.empty()) return;
+
+        // Images that failed to copy are dropped along with their textures
+        acul::vector<i64> texture_ids(_images.size(), -1);
+        u32 texture_count = 0;
+        for (size_t i = 0; i < _images.size(); ++i)
+            if (_images[i].done) texture_ids[i] = texture_count++;
+
+        write_key(json, "materials");
+        json.append('[');
+        for (size_t i = 0; i < _materials.size(); ++i)
+        {
+            auto &entry = _materials[i];
+            if (i) json.append(',');
+            json.append('{');
+            write_key(json, "name", true);
+            write_string(json, entry.info->name);
+            write_key(json, "pbrMetallicRoughness");
+            json.append('{');
+            write_key(json, "baseColorFactor", true);
+            const amal::vec3 color = entry.mat ? entry.mat->albedo.rgb : amal::vec3(1.0f);
+            const f32 factor[4] = {color.x, color.y, color.z, 1.0f};
+            write_floats(json, factor, 4);
+            if (entry.image >= 0 && texture_ids[entry.image] >= 0)
+            {
+                write_key(json, "baseColorTexture");
+                json.append('{');
+                write_member(json, "index", texture_ids[entry.image], true);
+                json.append('}');
+            }
+            write_member(json, "metallicFactor", 0);
+            json.append("}}");
+        }
+        json.append(']');
+
+        if (texture_count == 0) return;
+        write_key(json, "textures");
+        json.append('[');
+        for (u32 i = 0; i < texture_count; ++i)
+        {
+            if (i) json.append(',');
+            json.append('{');
+            write_member(json, "source", i, true);
+            json.append('}');
+        }
+        json.append(']');
+
+        write_key(json, "images");
+        json.append('[');
+        bool first = true;
+        for (auto &image : _images)
+        {
+            if (!image.done) continue;
+            if (!first) json.append(',');
+            first = false;
+            json.append('{');
+            write_key(json, "uri", true);
+            write_string(json, image.uri);
+            json.append('}');
+        }
+        json.append(']');
+    }
+
+    // Byte range of the binary chunk
+    struct BufferView
+    {
+        const void *data;
+        size_t size;
+        size_t offset;
+        u32 stride; // Not written if 0
+        u32 target;
+    };
+
+    struct Accessor
+    {
+        u32 view;
+        size_t offset;
+        size_t count;
+        u32 component;
+        const char *type;
+        const amal::vec3 *min = nullptr;
+        const amal::vec3 *max = nullptr;
+    };
+
+    // Placement of the buffer views in the binary chunk. Every view starts at a 4 byte boundary.
+    struct Exporter::Layout
+    {
+        acul::vector<BufferView> views;
+        acul::vector<Accessor> accessors;
+        size_t size = 0;
+
+        u32 add_view(const void *data, size_t size, u32 stride, u32 target)
+        {
+            this->size = (this->size + 3) & ~size_t(3);
+            views.push_back({data, size, this->size, stride, target});
+            this->size += size;
+            return views.size() - 1;
+        }
+
+        u32 add_accessor(u32 view, size_t offset, size_t count, u32 component, const char *type)
+        {
+            accessors.push_back({view, offset, count, component, type});
+            return accessors.size() - 1;
+        }
+
+        void add_mesh(MeshSegment &segment, MeshExportFlags flags)
+        {
+            using Vertex = umbf::mesh::Vertex;
+            const bool uv = flags & MeshExportFlagBits::export_uv;
+            const bool normals = flags & MeshExportFlagBits::export_normals;
+            auto &vertices = segment.mesh->model.vertices;
+            const size_t count = vertices.size();
+            if (segment.in_place)
+            {
+                // One interleaved view over the model vertices, the attributes are addressed by their offsets
+                u32 view = add_view(vertices.data(), count * sizeof(Vertex), sizeof(Vertex), target_array_buffer);
+                segment.position_accessor = add_accessor(view, offsetof(Vertex, pos), count, component_f32, "VEC3");
+                if (normals)
+                    segment.normal_accessor =
+                        add_accessor(view, offsetof(Vertex, normal), count, component_f32, "VEC3");
+                if (uv) segment.uv_accessor = add_accessor(view, offsetof(Vertex, uv), count, component_f32, "VEC2");
+            }
+            else
+            {
+                const u32 vec3_size = sizeof(amal::vec3);
+                segment.position_accessor =
+                    add_accessor(add_view(segment.positions.data(), count * vec3_size, vec3_size, target_array_buffer),
+                                 0, count, component_f32, "VEC3");
+                if (normals)
+                    segment.normal_accessor = add_accessor(
+                        add_view(segment.normals.data(), count * vec3_size, vec3_size, target_array_buffer), 0, count,
+                        component_f32, "VEC3");
+                if (uv)
+                    segment.uv_accessor = add_accessor(add_view(segment.uvs.data(), count * sizeof(amal::vec2),
+                                                                sizeof(amal::vec2), target_array_buffer),
+                                                       0, count, component_f32, "VEC2");
+            }
+            accessors[segment.position_accessor].min = &segment.min;
+            accessors[segment.position_accessor].max = &segment.max;
+
+            for (auto &primitive : segment.primitives)
+            {
+                const size_t bytes = primitive.count * sizeof(u32);
+                u32 view = add_view(primitive.data(), bytes, 0, target_element_array_buffer);
+                primitive.accessor = add_accessor(view, 0, primitive.count, component_u32, "SCALAR");
+            }
+        }
+    };
+
+    void Exporter::write_meshes(io::TextBuffer &json, const acul::vector<MeshSegment *> &meshes, MeshExportFlags flags)
+    {
+        if (meshes.empty()) return;
+        write_key(json, "nodes");
+        json.append('[');
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            if (i) json.append(',');
+            json.append('{');
+            write_key(json, "name", true);
+            write_string(json, meshes[i]->name);
+            write_member(json, "mesh", i);
+            json.append('}');
+        }
+        json.append(']');
+
+        write_key(json, "meshes");
+        json.append('[');
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            auto &segment = *meshes[i];
+            if (i) json.append(',');
+            json.append('{');
+            write_key(json, "name", true);
+            write_string(json, segment.name);
+            write_key(json, "primitives");
+            json.append('[');
+            for (size_t p = 0; p < segment.primitives.size(); ++p)
+            {
+                auto &primitive = segment.primitives[p];
+                if (p) json.append(',');
+                json.append('{');
+                write_key(json, "attributes", true);
+                json.append('{');
+                write_member(json, "POSITION", segment.position_accessor, true);
+                if (flags & MeshExportFlagBits::export_normals) write_member(json, "NORMAL", segment.normal_accessor);
+                if (flags & MeshExportFlagBits::export_uv) write_member(json, "TEXCOORD_0", segment.uv_accessor);
+                json.append('}');
+                write_member(json, "indices", primitive.accessor);
+                if (primitive.material >= 0) write_member(json, "material", primitive.material);
+                write_member(json, "mode", mode_triangles);
+                json.append('}');
+            }
+            json.append("]}");
+        }
+        json.append(']');
+    }
+
+    static void write_buffers(io::TextBuffer &json, const acul::vector<BufferView> &views,
+                              const acul::vector<Accessor> &accessors, size_t size)
+    {
+        if (size == 0) return;
+        write_key(json, "accessors");
+        json.append('[');
+        for (size_t i = 0; i < accessors.size(); ++i)
+        {
+            auto &accessor = accessors[i];
+            if (i) json.append(',');
+            json.append('{');
+            write_member(json, "bufferView", accessor.view, true);
+            write_member(json, "byteOffset", accessor.offset);
+            write_member(json, "componentType", accessor.component);
+            write_member(json, "count", accessor.count);
+            write_key(json, "type");
+            write_string(json, accessor.type);
+            if (accessor.min)
+            {
+                write_key(json, "min");
+                write_floats(json, &accessor.min->x, 3);
+                write_key(json, "max");
+                write_floats(json, &accessor.max->x, 3);
+            }
+            json.append('}');
+        }
+        json.append(']');
+
+        write_key(json, "bufferViews");
+        json.append('[');
+        for (size_t i = 0; i < views.size(); ++i)
+        {
+            auto &view = views[i];
+            if (i) json.append(',');
+            json.append('{');
+            write_member(json, "buffer", 0, true);
+            write_member(json, "byteOffset", view.offset);
+            write_member(json, "byteLength", view.size);
+            if (view.stride) write_member(json, "byteStride", view.stride);
+            write_member(json, "target", view.target);
+            json.append('}');
+        }
+        json.append(']');
+
+        write_key(json, "buffers");
+        json.append("[{");
+        write_member(json, "byteLength", size, true);
+        json.append("}]");
+    }
+
+    acul::op_result Exporter::save()
+    {
+        io::FileSink file;
+        if (!file.open(path))
+        {
+            _error = acul::format("Failed to open glb file. Error: %s", std::strerror(errno));
+            return acul::op_result(ACUL_OP_WRITE_ERROR, AECL_OP_DOMAIN, 0);
+        }
+        auto result = write_scene(file);
+        if (!file.close() && result.success())
+        {
+            _error = "Failed to write glb file";
+            return acul::op_result(ACUL_OP_WRITE_ERROR, AECL_OP_DOMAIN, result.code);
+        }
+        return result;
+    }
+
+    acul::op_result Exporter::save(ISink &sink) { return write_scene(sink); }
+
+    acul::op_result Exporter::write_scene(ISink &sink)
+    {
+        _error.clear();
+        collect_materials();
+        // Textures are copied while the vertex data is prepared
+        oneapi::tbb::task_group texture_tasks;
+        copy_textures(texture_tasks);
+        acul::vector<MeshSegment> segments(objects.size());
+        oneapi::tbb::parallel_for(size_t(0), objects.size(),
+                                  [&](size_t i) { prepare_mesh(objects[i], segments[i]); });
+        texture_tasks.wait();
+
+        u32 op_code = 0;
+        Layout layout;
+        acul::vector<MeshSegment *> meshes;
+        for (auto &segment : segments)
+        {
+            op_code |= segment.op_code;
+            if (!segment.error.empty()) _error = segment.error;
+            if (!segment.mesh || segment.primitives.empty()) continue;
+            layout.add_mesh(segment, mesh_flags);
+            meshes.push_back(&segment);
+        }
+        if (layout.size > std::numeric_limits<u32>::max() / 2)
+        {
+            _error = "Binary data exceeds the GLB size limit";
+            return acul::op_result(ACUL_OP_WRITE_ERROR, AECL_OP_DOMAIN, op_code);
+        }
+        const size_t bin_size = (layout.size + 3) & ~size_t(3);
+
+        io::TextBuffer json;
+        json.append("{\"asset\":{\"version\":\"2.0\",\"generator\":\"App3D ECL glTF Exporter\"}");
+        write_member(json, "scene", 0);
+        write_key(json, "scenes");
+        json.append("[{");
+        if (!meshes.empty())
+        {
+            write_key(json, "nodes", true);
+            json.append('[');
+            for (u32 i = 0; i < meshes.size(); ++i)
+            {
+                if (i) json.append(',');
+                json.append_uint(i);
+            }
+            json.append(']');
+        }
+        json.append("}]");
+        write_meshes(json, meshes, mesh_flags);
+        write_materials(json);
+        write_buffers(json, layout.views, layout.accessors, layout.size);
+        json.append('}');
+        while (json.size() % 4) json.append(' ');
+
+        const size_t total = sizeof(GlbHeader) + sizeof(ChunkHeader) + json.size() +
+                             (bin_size ? sizeof(ChunkHeader) + bin_size : 0);
+        if (total > std::numeric_limits<u32>::max())
+        {
+            _error = "Scene exceeds the GLB size limit";
+            return acul::op_result(ACUL_OP_WRITE_ERROR, AECL_OP_DOMAIN, op_code);
+        }
+
+        // Buffer views are written straight from their source, padded to their aligned offsets
+        static const char padding[4] = {};
+        GlbHeader header{glb_magic, glb_version, static_cast<u32>(total)};
+        ChunkHeader json_chunk{static_cast<u32>(json.size()), chunk_json};
+        bool success = sink.write(&header, sizeof(header)) && sink.write(&json_chunk, sizeof(json_chunk)) &&
+                       sink.write(json.data(), json.size());
+        if (success && bin_size)
+        {
+            ChunkHeader bin_chunk{static_cast<u32>(bin_size), chunk_bin};
+            success = sink.write(&bin_chunk, sizeof(bin_chunk));
+            size_t offset = 0;
+            for (auto &view : layout.views)
+            {
+                if (!success) break;
+                if (view.offset > offset) success = sink.write(padding, view.offset - offset);
+                success = success && sink.write(view.data, view.size);
+                offset = view.offset + view.size;
+            }
+            if (success && bin_size > offset) success = sink.write(padding, bin_size - offset);
+        }
+        if (!success)
+        {
+            _error = "Failed to write glb data";
+            return acul::op_result(ACUL_OP_WRITE_ERROR, AECL_OP_DOMAIN, op_code);
+        }
+        return acul::op_result(ACUL_OP_SUCCESS, AECL_OP_DOMAIN, op_code);
+    }
+} // namespace aecl::scene::gltf
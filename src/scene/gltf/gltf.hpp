@@ -0,0 +1,40 @@
+#pragma once
+
+#include <acul/scalars.hpp>
+
+namespace aecl::scene::gltf
+{
+    // GLB container: a 12 byte header followed by a JSON chunk and an optional binary chunk
+    constexpr u32 glb_magic = 0x46546C67; // "glTF"
+    constexpr u32 glb_version = 2;
+    constexpr u32 chunk_json = 0x4E4F534A; // "JSON"
+    constexpr u32 chunk_bin = 0x004E4942;  // "BIN\0"
+
+    struct GlbHeader
+    {
+        u32 magic;
+        u32 version;
+        u32 length;
+    };
+
+    struct ChunkHeader
+    {
+        u32 length;
+        u32 type;
+    };
+
+    // Accessor component types
+    constexpr u32 component_i8 = 5120;
+    constexpr u32 component_u8 = 5121;
+    constexpr u32 component_i16 = 5122;
+    constexpr u32 component_u16 = 5123;
+    constexpr u32 component_u32 = 5125;
+    constexpr u32 component_f32 = 5126;
+
+    // Buffer view targets
+    constexpr u32 target_array_buffer = 34962;
+    constexpr u32 target_element_array_buffer = 34963;
+
+    // Primitive topology
+    constexpr u32 mode_triangles = 4;
+} // namespace aecl::scene::gltf
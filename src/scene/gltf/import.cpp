@@ -0,0 +1,803 @@
+#include <acul/hash/hl_hashmap.hpp>
+#include <acul/io/fs/path.hpp>
+#include <aecl/image/import.hpp>
+#include <aecl/scene/gltf/import.hpp>
+#include <aecl/status.hpp>
+#include <amal/geometric.hpp>
+#include <charconv>
+#include <cstring>
+#include <memory>
+#include <oneapi/tbb/parallel_for.h>
+#include <umbf/version.h>
+#include "../../io/json.hpp"
+#include "../../io/mapped_file.hpp"
+#include "gltf.hpp"
+
+namespace aecl::scene::gltf
+{
+    using namespace umbf::mesh;
+    using io::JsonValue;
+
+    // Column-major 4x4 matrix
+    struct Matrix
+    {
+        f32 m[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+
+        Matrix operator*(const Matrix &rhs) const
+        {
+            Matrix result;
+            for (int c = 0; c < 4; ++c)
+                for (int r = 0; r < 4; ++r)
+                {
+                    f32 sum = 0.0f;
+                    for (int k = 0; k < 4; ++k) sum += m[k * 4 + r] * rhs.m[c * 4 + k];
+                    result.m[c * 4 + r] = sum;
+                }
+            return result;
+        }
+
+        bool identity() const { return std::memcmp(m, Matrix().m, sizeof(m)) == 0; }
+
+        f32 at(int r, int c) const { return m[c * 4 + r]; }
+
+        amal::vec3 point(const amal::vec3 &p) const
+        {
+            return {m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12], m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13],
+                    m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14]};
+        }
+
+        f32 determinant() const
+        {
+            return at(0, 0) * (at(1, 1) * at(2, 2) - at(1, 2) * at(2, 1)) -
+                   at(0, 1) * (at(1, 0) * at(2, 2) - at(1, 2) * at(2, 0)) +
+                   at(0, 2) * (at(1, 0) * at(2, 1) - at(1, 1) * at(2, 0));
+        }
+
+        /**
+         * Normal transform: the cofactor matrix of the upper 3x3, equal to the inverse transpose up to the
+         * determinant. Scaled by the sign of the determinant, so mirrored normals keep pointing outwards.
+         **/
+        void normal_matrix(f32 out[9]) const
+        {
+            const f32 sign = determinant() < 0.0f ? -1.0f : 1.0f;
+            for (int r = 0; r < 3; ++r)
+                for (int c = 0; c < 3; ++c)
+                {
+                    const int r1 = (r + 1) % 3, r2 = (r + 2) % 3, c1 = (c + 1) % 3, c2 = (c + 2) % 3;
+                    out[r * 3 + c] = sign * (at(r1, c1) * at(r2, c2) - at(r1, c2) * at(r2, c1));
+                }
+        }
+    };
+
+    static Matrix node_matrix(const JsonValue &node)
+    {
+        Matrix result;
+        auto &matrix = node["matrix"];
+        if (matrix.size() == 16)
+        {
+            for (size_t i = 0; i < 16; ++i) result.m[i] = matrix[i].as_number();
+            return result;
+        }
+
+        // T * R * S
+        auto &t = node["translation"];
+        auto &r = node["rotation"];
+        auto &s = node["scale"];
+        const f32 x = r[0].as_number(), y = r[1].as_number(), z = r[2].as_number(), w = r[3].as_number(1.0);
+        const f32 sx = s[0].as_number(1.0), sy = s[1].as_number(1.0), sz = s[2].as_number(1.0);
+        const f32 rotation[9] = {1 - 2 * (y * y + z * z), 2 * (x * y + w * z),     2 * (x * z - w * y),
+                                 2 * (x * y - w * z),     1 - 2 * (x * x + z * z), 2 * (y * z + w * x),
+                                 2 * (x * z + w * y),     2 * (y * z - w * x),     1 - 2 * (x * x + y * y)};
+        const f32 scale[3] = {sx, sy, sz};
+        for (int c = 0; c < 3; ++c)
+            for (int row = 0; row < 3; ++row) result.m[c * 4 + row] = rotation[c * 3 + row] * scale[c];
+        for (int row = 0; row < 3; ++row) result.m[12 + row] = t[row].as_number();
+        return result;
+    }
+
+    // Mesh placed by a node
+    struct Instance
+    {
+        u32 mesh;
+        Matrix matrix;
+        acul::string name;
+    };
+
+    // Faces of an object decoded from one primitive
+    struct FaceRange
+    {
+        i64 material;
+        u32 begin;
+        u32 end;
+    };
+
+    struct BufferRange
+    {
+        const u8 *data = nullptr;
+        size_t size = 0;
+    };
+
+    struct ImportCtx
+    {
+        io::MappedFile file;
+        acul::vector<std::unique_ptr<io::MappedFile>> buffer_files;
+        acul::vector<BufferRange> buffers;
+        JsonValue root;
+        acul::vector<acul::vector<FaceRange>> ranges; // Per imported object
+    };
+
+    // Decodes the %XX escapes of a relative URI
+    static acul::string decode_uri(const acul::string &uri)
+    {
+        acul::string result;
+        result.reserve(uri.size());
+        for (size_t i = 0; i < uri.size(); ++i)
+        {
+            u32 code;
+            if (uri[i] == '%' && i + 2 < uri.size() &&
+                std::from_chars(uri.data() + i + 1, uri.data() + i + 3, code, 16).ptr == uri.data() + i + 3)
+            {
+                result.push_back(static_cast<char>(code));
+                i += 2;
+            }
+            else result.push_back(uri[i]);
+        }
+        return result;
+    }
+
+    static bool is_data_uri(const JsonValue &uri) { return uri.text.substr(0, 5) == "data:"; }
+
+    // Progress shares of the import stages
+    constexpr f32 progress_read_end = 0.1f;
+    constexpr f32 progress_geometry_end = 0.95f;
+
+    Importer::~Importer() { acul::release(_ctx); }
+
+    acul::op_result Importer::cancel()
+    {
+        acul::release(_ctx);
+        _ctx = nullptr;
+        return ILoader::cancel();
+    }
+
+    static bool validate_meshes(const ImportCtx &ctx, acul::string &error);
+
+    acul::op_result Importer::read_source()
+    {
+        acul::release(_ctx);
+        _ctx = acul::alloc<ImportCtx>();
+        _error.clear();
+        StageTimer timer(_stats, Stage::read);
+        auto read_error = [this](const acul::string &error) {
+            _error = error;
+            return acul::op_result(ACUL_OP_READ_ERROR, AECL_OP_DOMAIN, 0);
+        };
+
+        auto &file = _ctx->file;
+        if (!file.open(_path)) return read_error("Failed to open file");
+        if (_stats) _stats->bytes_read += file.size();
+        const char *json = file.data();
+        size_t json_size = file.size();
+        BufferRange bin;
+        if (file.size() >= sizeof(GlbHeader) && std::memcmp(file.data(), "glTF", 4) == 0)
+        {
+            GlbHeader header;
+            std::memcpy(&header, file.data(), sizeof(header));
+            if (header.version != glb_version || header.length < sizeof(header) || header.length > file.size())
+                return read_error("Invalid GLB header");
+            json = nullptr;
+            size_t offset = sizeof(header);
+            while (header.length - offset >= sizeof(ChunkHeader))
+            {
+                ChunkHeader chunk;
+                std::memcpy(&chunk, file.data() + offset, sizeof(chunk));
+                offset += sizeof(chunk);
+                if (chunk.length > header.length - offset) return read_error("Truncated GLB chunk");
+                const char *data = file.data() + offset;
+                if (chunk.type == chunk_json && !json)
+                {
+                    json = data;
+                    json_size = chunk.length;
+                }
+                else if (chunk.type == chunk_bin && !bin.data) bin = {reinterpret_cast<const u8 *>(data), chunk.length};
+                offset = std::min<size_t>(header.length, offset + ((chunk.length + 3) & ~size_t(3)));
+            }
+            if (!json) return read_error("GLB has no JSON chunk");
+        }
+
+        auto &root = _ctx->root;
+        if (!io::parse_json(json, json_size, root, _error))
+            return acul::op_result(ACUL_OP_READ_ERROR, AECL_OP_DOMAIN, 0);
+        if (root["asset"]["version"].text.substr(0, 2) != "2.") return read_error("Unsupported glTF version");
+
+        auto &buffers = root["buffers"];
+        acul::path base = acul::path(_path).parent_path();
+        _ctx->buffers.resize(buffers.size());
+        for (size_t i = 0; i < buffers.size(); ++i)
+        {
+            auto &uri = buffers[i]["uri"];
+            BufferRange range;
+            if (uri.is_null())
+            {
+                if (i != 0 || !bin.data) return read_error(acul::format("Buffer %zu has no data", i));
+                range = bin;
+            }
+            else if (is_data_uri(uri)) return read_error("Embedded data URIs are not supported");
+            else
+            {
+                auto buffer_file = std::make_unique<io::MappedFile>();
+                acul::string buffer_path = (base / decode_uri(uri.str())).str();
+                if (!buffer_file->open(buffer_path))
+                    return read_error(acul::format("Failed to open buffer: %s", buffer_path.c_str()));
+                if (_stats) _stats->bytes_read += buffer_file->size();
+                range = {reinterpret_cast<const u8 *>(buffer_file->data()), buffer_file->size()};
+                _ctx->buffer_files.push_back(std::move(buffer_file));
+            }
+            const size_t length = buffers[i]["byteLength"].as_index(0);
+            if (range.size < length) return read_error(acul::format("Buffer %zu is truncated", i));
+            range.size = length;
+            _ctx->buffers[i] = range;
+        }
+        if (!validate_meshes(*_ctx, _error)) return acul::op_result(ACUL_OP_READ_ERROR, AECL_OP_DOMAIN, 0);
+        report_progress(_progress, progress_read_end);
+        return acul::make_op_success();
+    }
+
+    // Strided view of an accessor in a mapped buffer
+    struct Accessor
+    {
+        const u8 *data = nullptr;
+        size_t count = 0;
+        size_t stride = 0;
+        u32 component = 0;
+        u32 components = 0;
+        bool normalized = false;
+    };
+
+    static u32 get_component_size(u32 component)
+    {
+        switch (component)
+        {
+            case component_i8:
+            case component_u8:
+                return 1;
+            case component_i16:
+            case component_u16:
+                return 2;
+            case component_u32:
+            case component_f32:
+                return 4;
+            default:
+                return 0;
+        }
+    }
+
+    static u32 get_component_count(acul::string_view type)
+    {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        return 0;
+    }
+
+    // Resolves an accessor and checks that all of its elements lie inside the buffer view
+    static bool get_accessor(const ImportCtx &ctx, i64 index, Accessor &out)
+    {
+        auto &root = ctx.root;
+        if (index < 0) return false;
+        auto &accessor = root["accessors"][index];
+        auto &view = root["bufferViews"][accessor["bufferView"].as_index()];
+        const i64 buffer_id = view["buffer"].as_index();
+        if (accessor.is_null() || view.is_null() || buffer_id < 0 || buffer_id >= (i64)ctx.buffers.size())
+            return false;
+
+        out.component = accessor["componentType"].as_index(0);
+        out.components = get_component_count(accessor["type"].text);
+        out.normalized = accessor["normalized"].boolean;
+        out.count = accessor["count"].as_index(0);
+        const size_t element_size = get_component_size(out.component) * out.components;
+        out.stride = view["byteStride"].as_index(0);
+        if (out.stride == 0) out.stride = element_size;
+        if (element_size == 0 || out.stride < element_size) return false;
+
+        auto &buffer = ctx.buffers[buffer_id];
+        const size_t view_offset = view["byteOffset"].as_index(0);
+        const size_t view_length = view["byteLength"].as_index(0);
+        const size_t offset = accessor["byteOffset"].as_index(0);
+        if (view_offset > buffer.size || view_length > buffer.size - view_offset || offset > view_length) return false;
+        const size_t available = view_length - offset;
+        if (out.count > 0 && (element_size > available || out.count - 1 > (available - element_size) / out.stride))
+            return false;
+        out.data = buffer.data + view_offset + offset;
+        return true;
+    }
+
+    static f32 read_component(const u8 *src, u32 component, bool normalized)
+    {
+        switch (component)
+        {
+            case component_f32:
+            {
+                f32 value;
+                std::memcpy(&value, src, sizeof(value));
+                return value;
+            }
+            case component_u8:
+                return normalized ? src[0] / 255.0f : src[0];
+            case component_i8:
+            {
+                const f32 value = static_cast<i8>(src[0]);
+                return normalized ? std::max(value / 127.0f, -1.0f) : value;
+            }
+            case component_u16:
+            {
+                u16 value;
+                std::memcpy(&value, src, sizeof(value));
+                return normalized ? value / 65535.0f : value;
+            }
+            case component_i16:
+            {
+                i16 value;
+                std::memcpy(&value, src, sizeof(value));
+                return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+            }
+            case component_u32:
+            {
+                u32 value;
+                std::memcpy(&value, src, sizeof(value));
+                return static_cast<f32>(value);
+            }
+            default:
+                return 0.0f;
+        }
+    }
+
+    static bool is_index_component(u32 component)
+    {
+        return component == component_u8 || component == component_u16 || component == component_u32;
+    }
+
+    static u32 read_index(const u8 *src, u32 component)
+    {
+        switch (component)
+        {
+            case component_u8:
+                return src[0];
+            case component_u16:
+            {
+                u16 value;
+                std::memcpy(&value, src, sizeof(value));
+                return value;
+            }
+            default:
+            {
+                u32 value;
+                std::memcpy(&value, src, sizeof(value));
+                return value;
+            }
+        }
+    }
+
+    // Checks everything decode_primitive relies on, so a malformed primitive fails the load instead of being dropped
+    static bool validate_primitive(const ImportCtx &ctx, const JsonValue &primitive, acul::string &error)
+    {
+        if (primitive["mode"].as_index(mode_triangles) != mode_triangles)
+        {
+            error = "Only triangle primitives are supported";
+            return false;
+        }
+        Accessor positions, indices;
+        if (!get_accessor(ctx, primitive["attributes"]["POSITION"].as_index(), positions) || positions.components != 3)
+        {
+            error = "Primitive has no valid POSITION accessor";
+            return false;
+        }
+        auto &index_ref = primitive["indices"];
+        if (index_ref.is_null()) return true;
+        if (!get_accessor(ctx, index_ref.as_index(), indices) || indices.components != 1 ||
+            !is_index_component(indices.component))
+        {
+            error = "Primitive has an invalid indices accessor";
+            return false;
+        }
+        for (size_t i = 0; i < indices.count - indices.count % 3; ++i)
+            if (read_index(indices.data + i * indices.stride, indices.component) >= positions.count)
+            {
+                error = "Primitive index out of range";
+                return false;
+            }
+        return true;
+    }
+
+    static bool validate_meshes(const ImportCtx &ctx, acul::string &error)
+    {
+        acul::vector<const JsonValue *> primitives;
+        for (auto &mesh : ctx.root["meshes"].items)
+            for (auto &primitive : mesh["primitives"].items) primitives.push_back(&primitive);
+        acul::vector<acul::string> errors(primitives.size());
+        oneapi::tbb::parallel_for(size_t(0), primitives.size(),
+                                  [&](size_t i) { validate_primitive(ctx, *primitives[i], errors[i]); });
+        for (auto &e : errors)
+            if (!e.empty())
+            {
+                error = e;
+                return false;
+            }
+        return true;
+    }
+
+    static amal::vec3 safe_normalize(const amal::vec3 &v)
+    {
+        return amal::dot(v, v) > 0.0f ? amal::normalize(v) : v;
+    }
+
+    template <int N>
+    static void read_vector(const Accessor &accessor, size_t index, f32 *dst)
+    {
+        const u8 *src = accessor.data + index * accessor.stride;
+        const u32 size = get_component_size(accessor.component);
+        for (int k = 0; k < N; ++k) dst[k] = read_component(src + k * size, accessor.component, accessor.normalized);
+    }
+
+    // Vertices and triangles decoded from one primitive
+    struct PrimitiveData
+    {
+        acul::vector<Vertex> vertices;
+        acul::vector<u32> indices;
+        acul::vector<u32> groups; // Vertex group of every vertex: vertices sharing a position share the group
+        u32 group_count = 0;
+        i64 material = -1;
+    };
+
+    // Decodes a primitive accepted by validate_primitive
+    static void decode_primitive(const ImportCtx &ctx, const JsonValue &primitive, const Matrix &matrix, bool flip_uv,
+                                 PrimitiveData &out)
+    {
+        auto &attributes = primitive["attributes"];
+        Accessor positions, normals, uvs, indices;
+        if (!get_accessor(ctx, attributes["POSITION"].as_index(), positions)) return;
+        const size_t count = positions.count;
+        const bool has_normals = get_accessor(ctx, attributes["NORMAL"].as_index(), normals) &&
+                                 normals.components == 3 && normals.count == count;
+        const bool has_uv = get_accessor(ctx, attributes["TEXCOORD_0"].as_index(), uvs) && uvs.components == 2 &&
+                            uvs.count == count;
+
+        const bool identity = matrix.identity();
+        f32 nm[9];
+        matrix.normal_matrix(nm);
+        out.vertices.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto &vertex = out.vertices[i];
+            f32 value[3];
+            read_vector<3>(positions, i, value);
+            vertex.pos = {value[0], value[1], value[2]};
+            if (!identity) vertex.pos = matrix.point(vertex.pos);
+            if (has_normals)
+            {
+                read_vector<3>(normals, i, value);
+                vertex.normal = {value[0], value[1], value[2]};
+                if (!identity)
+                    vertex.normal = safe_normalize(amal::vec3{nm[0] * value[0] + nm[1] * value[1] + nm[2] * value[2],
+                                                              nm[3] * value[0] + nm[4] * value[1] + nm[5] * value[2],
+                                                              nm[6] * value[0] + nm[7] * value[1] + nm[8] * value[2]});
+            }
+            if (has_uv)
+            {
+                read_vector<2>(uvs, i, value);
+                vertex.uv = {value[0], flip_uv ? 1.0f - value[1] : value[1]};
+            }
+        }
+
+        auto &index_ref = primitive["indices"];
+        if (!index_ref.is_null())
+        {
+            if (!get_accessor(ctx, index_ref.as_index(), indices)) return;
+            out.indices.resize(indices.count - indices.count % 3);
+            for (size_t i = 0; i < out.indices.size(); ++i)
+                out.indices[i] = read_index(indices.data + i * indices.stride, indices.component);
+        }
+        else
+        {
+            out.indices.resize(count - count % 3);
+            for (size_t i = 0; i < out.indices.size(); ++i) out.indices[i] = i;
+        }
+        // Mirroring transforms reverse the winding
+        if (matrix.determinant() < 0.0f)
+            for (size_t i = 0; i < out.indices.size(); i += 3) std::swap(out.indices[i + 1], out.indices[i + 2]);
+
+        if (!has_normals)
+        {
+            // Area weighted vertex normals
+            for (size_t i = 0; i < out.indices.size(); i += 3)
+            {
+                auto &a = out.vertices[out.indices[i]], &b = out.vertices[out.indices[i + 1]],
+                     &c = out.vertices[out.indices[i + 2]];
+                amal::vec3 normal = amal::cross(b.pos - a.pos, c.pos - a.pos);
+                a.normal += normal;
+                b.normal += normal;
+                c.normal += normal;
+            }
+            for (auto &vertex : out.vertices) vertex.normal = safe_normalize(vertex.normal);
+        }
+
+        acul::hl_hashmap<amal::vec3, u32> position_ids;
+        position_ids.reserve(count);
+        out.groups.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto [it, inserted] = position_ids.emplace(out.vertices[i].pos, static_cast<u32>(position_ids.size()));
+            out.groups[i] = it->second;
+        }
+        out.group_count = position_ids.size();
+        out.material = primitive["material"].as_index();
+    }
+
+    // Meshes placed by the nodes of the default scene with their world transforms
+    static void collect_instances(const JsonValue &root, acul::vector<Instance> &instances)
+    {
+        auto &nodes = root["nodes"];
+        auto &meshes = root["meshes"];
+        acul::vector<u32> roots;
+        auto &scene = root["scenes"][root["scene"].as_index(0)];
+        if (!scene.is_null())
+            for (auto &node : scene["nodes"].items)
+                if (node.as_index() >= 0) roots.push_back(node.as_index());
+        if (scene.is_null())
+        {
+            // No scene: every node without a parent is a root
+            acul::vector<bool> is_child(nodes.size(), false);
+            for (auto &node : nodes.items)
+                for (auto &child : node["children"].items)
+                {
+                    const i64 id = child.as_index();
+                    if (id >= 0 && id < (i64)nodes.size()) is_child[id] = true;
+                }
+            for (size_t i = 0; i < nodes.size(); ++i)
+                if (!is_child[i]) roots.push_back(i);
+        }
+
+        struct Entry
+        {
+            u32 node;
+            Matrix parent;
+        };
+        acul::vector<Entry> stack;
+        for (auto it = roots.rbegin(); it != roots.rend(); ++it) stack.push_back({*it, Matrix()});
+        acul::vector<bool> visited(nodes.size(), false);
+        while (!stack.empty())
+        {
+            Entry entry = stack.back();
+            stack.pop_back();
+            // A node has a single parent, revisits only come from malformed hierarchies
+            if (entry.node >= nodes.size() || visited[entry.node]) continue;
+            visited[entry.node] = true;
+            auto &node = nodes[entry.node];
+            Matrix world = entry.parent * node_matrix(node);
+            const i64 mesh = node["mesh"].as_index();
+            if (mesh >= 0 && mesh < (i64)meshes.size())
+            {
+                acul::string name = node["name"].str();
+                if (name.empty()) name = meshes[mesh]["name"].str();
+                instances.push_back({static_cast<u32>(mesh), world, name});
+            }
+            auto &children = node["children"].items;
+            for (auto it = children.rbegin(); it != children.rend(); ++it)
+                if (it->as_index() >= 0) stack.push_back({static_cast<u32>(it->as_index()), world});
+        }
+
+        // Files without nodes still carry their meshes
+        if (nodes.size() == 0)
+            for (size_t i = 0; i < meshes.size(); ++i)
+                instances.push_back({static_cast<u32>(i), Matrix(), meshes[i]["name"].str()});
+    }
+
+    // Concatenates the decoded primitives of an instance into one model
+    static void merge_primitives(PrimitiveData *primitives, size_t count, Model &model, acul::vector<FaceRange> &ranges)
+    {
+        size_t vertex_count = 0, index_count = 0;
+        for (size_t p = 0; p < count; ++p)
+        {
+            vertex_count += primitives[p].vertices.size();
+            index_count += primitives[p].indices.size();
+        }
+        model.vertices.reserve(vertex_count);
+        model.indices.reserve(index_count);
+        model.faces.reserve(index_count / 3);
+        for (size_t p = 0; p < count; ++p)
+        {
+            auto &primitive = primitives[p];
+            if (primitive.indices.empty()) continue;
+            const u32 vertex_base = model.vertices.size();
+            const u32 group_base = model.group_count;
+            const u32 face_begin = model.faces.size();
+            model.vertices.insert(model.vertices.end(), primitive.vertices.begin(), primitive.vertices.end());
+            for (size_t i = 0; i < primitive.indices.size(); i += 3)
+            {
+                Face face;
+                face.first_vertex = model.indices.size();
+                face.count = 3;
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    const u32 id = primitive.indices[i + k];
+                    face.vertices.emplace_back(group_base + primitive.groups[id], vertex_base + id);
+                    model.indices.push_back(vertex_base + id);
+                }
+                auto &a = primitive.vertices[primitive.indices[i]].pos;
+                face.normal = safe_normalize(amal::cross(primitive.vertices[primitive.indices[i + 1]].pos - a,
+                                                         primitive.vertices[primitive.indices[i + 2]].pos - a));
+                model.faces.push_back(std::move(face));
+            }
+            model.group_count += primitive.group_count;
+            ranges.push_back({primitive.material, face_begin, static_cast<u32>(model.faces.size())});
+        }
+        if (model.vertices.empty()) return;
+        model.aabb.min = model.aabb.max = model.vertices.front().pos;
+        for (auto &vertex : model.vertices)
+        {
+            model.aabb.min = amal::min(model.aabb.min, vertex.pos);
+            model.aabb.max = amal::max(model.aabb.max, vertex.pos);
+        }
+    }
+
+    void Importer::build_geometry()
+    {
+        StageTimer timer(_stats, Stage::index);
+        auto &root = _ctx->root;
+        acul::vector<Instance> instances;
+        collect_instances(root, instances);
+
+        // Every primitive of every instance is an independent task
+        acul::vector<size_t> first_primitive(instances.size() + 1, 0);
+        for (size_t i = 0; i < instances.size(); ++i)
+            first_primitive[i + 1] = first_primitive[i] + root["meshes"][instances[i].mesh]["primitives"].size();
+        acul::vector<PrimitiveData> primitives(first_primitive.back());
+        oneapi::tbb::parallel_for(size_t(0), instances.size(), [&](size_t i) {
+            auto &source = root["meshes"][instances[i].mesh]["primitives"];
+            oneapi::tbb::parallel_for(size_t(0), source.size(), [&](size_t p) {
+                if (is_cancelled(_progress)) return;
+                decode_primitive(*_ctx, source[p], instances[i].matrix, flip_uv, primitives[first_primitive[i] + p]);
+            });
+        });
+        if (is_cancelled(_progress)) return;
+
+        acul::vector<umbf::Object> objects(instances.size());
+        acul::vector<acul::vector<FaceRange>> ranges(instances.size());
+        oneapi::tbb::parallel_for(size_t(0), instances.size(), [&](size_t i) {
+            if (is_cancelled(_progress)) return;
+            auto mesh = acul::make_shared<Mesh>();
+            const size_t first = first_primitive[i];
+            merge_primitives(primitives.data() + first, first_primitive[i + 1] - first, mesh->model, ranges[i]);
+            if (mesh->model.faces.empty()) return;
+            objects[i].name = instances[i].name;
+            objects[i].meta.push_back(mesh);
+        });
+        if (is_cancelled(_progress)) return;
+
+        if (_stats)
+            for (auto &primitive : primitives)
+            {
+                _stats->vertices += primitive.vertices.size();
+                _stats->unique_vertices += primitive.vertices.size();
+                _stats->faces += primitive.indices.size() / 3;
+            }
+        for (size_t i = 0; i < objects.size(); ++i)
+        {
+            if (objects[i].meta.empty()) continue;
+            objects[i].id = acul::id_gen()();
+            _objects.push_back(std::move(objects[i]));
+            _ctx->ranges.push_back(std::move(ranges[i]));
+        }
+        report_progress(_progress, progress_geometry_end);
+    }
+
+    acul::op_result Importer::load_materials()
+    {
+        auto &root = _ctx->root;
+        auto &materials = root["materials"];
+        if (materials.size() == 0)
+        {
+            acul::release(_ctx);
+            _ctx = nullptr;
+            return acul::make_op_success();
+        }
+        StageTimer timer(_stats, Stage::material_resolve);
+        acul::path base = acul::path(_path).parent_path();
+
+        // glTF image to the index of its texture target, -1 if it can't be resolved
+        acul::hl_hashmap<i64, int> image_ids;
+        auto resolve_image = [&](i64 image) -> int {
+            auto [it, inserted] = image_ids.emplace(image, -1);
+            if (!inserted) return it->second;
+            auto &uri = root["images"][image]["uri"];
+            if (uri.is_null() || is_data_uri(uri))
+            {
+                _error = "Embedded images are not supported";
+                return -1;
+            }
+            acul::string path = (base / decode_uri(uri.str())).str();
+            auto *loader = image::get_importer_by_path(path);
+            if (!loader)
+            {
+                _error = acul::format("Unsupported texture format: %s", path.c_str());
+                return -1;
+            }
+            acul::release(loader);
+            auto target = acul::make_shared<umbf::Target>();
+            target->header.vendor_sign = UMBF_VENDOR_ID;
+            target->header.vendor_version = UMBF_VERSION;
+            target->header.type_sign = umbf::sign_block::format::target;
+            target->header.spec_version = UMBF_VERSION;
+            target->header.flags = 0;
+            target->url = path;
+            target->checksum = 0;
+            it->second = _textures.size();
+            _textures.push_back(target);
+            return it->second;
+        };
+
+        acul::vector<acul::shared_ptr<umbf::MaterialInfo>> infos(materials.size());
+        auto generator = acul::id_gen();
+        for (size_t i = 0; i < materials.size(); ++i)
+        {
+            auto &source = materials[i];
+            auto &pbr = source["pbrMetallicRoughness"];
+            auto &factor = pbr["baseColorFactor"];
+            auto mat = acul::make_shared<umbf::Material>();
+            mat->albedo.rgb = {(f32)factor[0].as_number(1.0), (f32)factor[1].as_number(1.0),
+                               (f32)factor[2].as_number(1.0)};
+            const i64 texture = pbr["baseColorTexture"]["index"].as_index();
+            const i64 image = texture < 0 ? -1 : root["textures"][texture]["source"].as_index();
+            const int texture_id = image < 0 ? -1 : resolve_image(image);
+            if (texture_id >= 0)
+            {
+                mat->albedo.textured = true;
+                mat->albedo.texture_id = texture_id;
+            }
+            acul::string name = source["name"].str();
+            if (name.empty()) name = acul::format("material_%zu", i);
+            infos[i] = acul::make_shared<umbf::MaterialInfo>(generator(), name);
+            auto file = acul::make_shared<umbf::File>();
+            file->header.vendor_sign = UMBF_VENDOR_ID;
+            file->header.vendor_version = UMBF_VERSION;
+            file->header.spec_version = UMBF_VERSION;
+            file->header.type_sign = umbf::sign_block::format::material;
+            file->blocks.push_back(mat);
+            file->blocks.push_back(infos[i]);
+            _materials.push_back(file);
+        }
+
+        // Primitives of a material are merged into one range. An object covered by a single material receives
+        // a range without faces, which denotes the default material of the object.
+        for (size_t o = 0; o < _objects.size(); ++o)
+        {
+            acul::hl_hashmap<i64, size_t> slots;
+            acul::vector<acul::shared_ptr<umbf::MaterialRange>> object_ranges;
+            for (auto &range : _ctx->ranges[o])
+            {
+                if (range.material < 0 || range.material >= (i64)infos.size()) continue;
+                auto [it, inserted] = slots.emplace(range.material, object_ranges.size());
+                if (inserted)
+                {
+                    object_ranges.push_back(acul::make_shared<umbf::MaterialRange>());
+                    object_ranges.back()->mat_id = infos[range.material]->id;
+                    infos[range.material]->assignments.push_back(_objects[o].id);
+                }
+                auto &faces = object_ranges[it->second]->faces;
+                for (u32 f = range.begin; f < range.end; ++f) faces.push_back(f);
+            }
+            if (object_ranges.size() == 1)
+            {
+                auto &mesh = static_cast<umbf::mesh::Mesh &>(*_objects[o].meta.front());
+                auto &faces = object_ranges.front()->faces;
+                if (faces.size() == mesh.model.faces.size()) faces.clear();
+            }
+            auto &meta = _objects[o].meta;
+            meta.insert(meta.end(), object_ranges.begin(), object_ranges.end());
+        }
+        acul::release(_ctx);
+        _ctx = nullptr;
+        return acul::make_op_success();
+    }
+} // namespace aecl::scene::gltf
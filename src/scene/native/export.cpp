@@ -0,0 +1,95 @@
+#include <acul/hash/hashset.hpp>
+#include <acul/io/fs/file.hpp>
+#include <acul/io/fs/path.hpp>
+#include <aecl/scene/native/export.hpp>
+#include <aecl/status.hpp>
+#include <oneapi/tbb/parallel_for.h>
+#include <umbf/version.h>
+#include "../../io/file.hpp"
+
+namespace aecl::scene::native
+{
+    // Copy of the material file without texture references
+    static umbf::File strip_textures(const umbf::File &material)
+    {
+        umbf::File result = material;
+        for (auto &block : result.blocks)
+        {
+            if (block->signature() != umbf::sign_block::material) continue;
+            auto mat = acul::make_shared<umbf::Material>(static_cast<const umbf::Material &>(*block));
+            mat->albedo.textured = false;
+            block = mat;
+        }
+        return result;
+    }
+
+    acul::op_result Exporter::save()
+    {
+        _error.clear();
+        auto scene = acul::make_shared<umbf::Scene>();
+        scene->objects = objects;
+        if (material_flags != MaterialExportFlags::none)
+        {
+            scene->materials.reserve(materials.size());
+            for (auto &material : materials)
+                scene->materials.push_back(material_flags == MaterialExportFlags::texture_none
+                                               ? strip_textures(material)
+                                               : material);
+        }
+
+        if (material_flags == MaterialExportFlags::texture_origin ||
+            material_flags == MaterialExportFlags::texture_copy)
+        {
+            // Copied textures are referenced relative to the file, a name already taken gets a counter
+            const bool copy = material_flags == MaterialExportFlags::texture_copy;
+            acul::path tex_dir = acul::path(path).parent_path() / "tex";
+            acul::hashset<acul::string> names;
+            acul::vector<acul::string> targets(textures.size());
+            scene->textures.resize(textures.size());
+            for (size_t i = 0; i < textures.size(); ++i)
+            {
+                auto &target = scene->textures[i];
+                target.header.vendor_sign = UMBF_VENDOR_ID;
+                target.header.vendor_version = UMBF_VERSION;
+                target.header.type_sign = umbf::sign_block::format::target;
+                target.header.spec_version = UMBF_VERSION;
+                target.header.flags = 0;
+                target.checksum = 0;
+                target.url = textures[i];
+                if (!copy) continue;
+                acul::string name = io::make_unique_filename(acul::fs::get_filename(textures[i]), names);
+                targets[i] = (tex_dir / name).str();
+                target.url = "tex/" + name;
+            }
+            if (copy)
+            {
+                acul::vector<char> copied(textures.size(), false);
+                oneapi::tbb::parallel_for(size_t(0), textures.size(),
+                                          [&](size_t i) { copied[i] = io::copy_file(textures[i], targets[i]); });
+                for (size_t i = 0; i < textures.size(); ++i)
+                    if (!copied[i])
+                    {
+                        _error = acul::format("Failed to copy texture: %s", textures[i].c_str());
+                        scene->textures[i].url = textures[i];
+                    }
+            }
+        }
+
+        umbf::File file;
+        file.header.vendor_sign = UMBF_VENDOR_ID;
+        file.header.vendor_version = UMBF_VERSION;
+        file.header.spec_version = UMBF_VERSION;
+        file.header.type_sign = umbf::sign_block::format::scene;
+        file.header.flags = 0;
+        if (compression > 0) file.header.flags |= UMBF_COMPRESSION_PAYLOAD_BIT;
+        file.blocks.push_back(scene);
+        file.checksum = checksum;
+        if (!file.save(path, compression))
+        {
+            _error = "Failed to write umbf file";
+            return acul::op_result(ACUL_OP_WRITE_ERROR, AECL_OP_DOMAIN, 0);
+        }
+        return acul::op_result(ACUL_OP_SUCCESS, AECL_OP_DOMAIN,
+                               _error.empty() ? 0 : AECL_OP_CODE_MATERIAL_ERROR);
+    }
+} // namespace aecl::scene::native
@@ -0,0 +1,76 @@
+#include <acul/io/fs/path.hpp>
+#include <aecl/scene/native/import.hpp>
+#include <aecl/status.hpp>
+#include <inttypes.h>
+#include "../../io/file.hpp"
+
+namespace aecl::scene::native
+{
+    acul::op_result Importer::cancel()
+    {
+        _scene.reset();
+        return ILoader::cancel();
+    }
+
+    acul::op_result Importer::read_source()
+    {
+        _scene.reset();
+        _error.clear();
+        StageTimer timer(_stats, Stage::read);
+        acul::shared_ptr<umbf::File> asset;
+        auto res = umbf::File::read_from_disk(_path, asset);
+        if (!res.success())
+        {
+            _error = acul::format("Failed to load file. Error code: 0x%016" PRIx64, static_cast<u64>(res));
+            return acul::op_result(ACUL_OP_READ_ERROR, AECL_OP_DOMAIN, 0);
+        }
+        if (_stats) _stats->bytes_read += io::get_file_size(_path);
+        if (asset->header.type_sign != umbf::sign_block::format::scene || asset->blocks.empty() ||
+            asset->blocks.front()->signature() != umbf::sign_block::scene)
+        {
+            _error = "Provided file is not a scene";
+            return acul::op_result(ACUL_OP_READ_ERROR, AECL_OP_DOMAIN, 0);
+        }
+        _scene = acul::static_pointer_cast<umbf::Scene>(asset->blocks.front());
+        return acul::make_op_success();
+    }
+
+    void Importer::build_geometry()
+    {
+        if (!_scene) return;
+        _objects = std::move(_scene->objects);
+        if (!_stats) return;
+        for (auto &object : _objects)
+            for (auto &block : object.meta)
+            {
+                if (block->signature() != umbf::sign_block::mesh) continue;
+                auto &model = static_cast<umbf::mesh::Mesh &>(*block).model;
+                _stats->vertices += model.vertices.size();
+                _stats->unique_vertices += model.vertices.size();
+                _stats->faces += model.faces.size();
+            }
+    }
+
+    static bool is_absolute_path(const acul::string &path)
+    {
+        return !path.empty() && (path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'));
+    }
+
+    acul::op_result Importer::load_materials()
+    {
+        if (!_scene) return acul::make_op_success();
+        StageTimer timer(_stats, Stage::material_resolve);
+        _materials.reserve(_materials.size() + _scene->materials.size());
+        for (auto &material : _scene->materials)
+            _materials.push_back(acul::make_shared<umbf::File>(std::move(material)));
+        acul::path base = acul::path(_path).parent_path();
+        for (auto &texture : _scene->textures)
+        {
+            auto target = acul::make_shared<umbf::Target>(std::move(texture));
+            if (!is_absolute_path(target->url)) target->url = (base / target->url).str();
+            _textures.push_back(target);
+        }
+        _scene.reset();
+        return acul::make_op_success();
+    }
+} // namespace aecl::scene::native
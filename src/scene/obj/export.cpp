@@ -1,177 +1,513 @@
+#include <acul/hash/hashset.hpp>
 #include <acul/io/fs/file.hpp>
 #include <acul/io/fs/path.hpp>
 #include <acul/string/string.hpp>
 #include <aecl/scene/obj/export.hpp>
 #include <aecl/status.hpp>
+#include <cctype>
+#include <cstring>
 #include <fstream>
 #include <inttypes.h>
+#include <limits>
+#include <oneapi/tbb/concurrent_unordered_map.h>
 #include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/parallel_pipeline.h>
+#include <oneapi/tbb/parallel_scan.h>
+#include <oneapi/tbb/task_arena.h>
+#include <oneapi/tbb/task_group.h>
 #include <umbf/utils.hpp>
+#include "../../io/file.hpp"
+#include "../../io/text_buffer.hpp"
+#include "../../io/writer.hpp"
+#include "../transform.hpp"
 
 namespace aecl::scene::obj
 {
-    void transform_vertex(amal::vec3 &pos, MeshExportFlags flags)
-    {
-        if (flags & MeshExportFlagBits::transform_reverse_x) pos.x = -pos.x;
-        if (flags & MeshExportFlagBits::transform_reverse_y) pos.y = -pos.y;
-        if (flags & MeshExportFlagBits::transform_reverse_z) pos.z = -pos.z;
-        if (flags & MeshExportFlagBits::transform_swap_xy) std::swap(pos.x, pos.y);
-        if (flags & MeshExportFlagBits::transform_swap_xz) std::swap(pos.x, pos.z);
-        if (flags & MeshExportFlagBits::transform_swap_yz) std::swap(pos.y, pos.z);
-    }
+    // Min size of a chunk handed over to the writer thread
+    constexpr size_t write_chunk_size = 4 * 1024 * 1024;
 
-    void Exporter::write_vertices(umbf::mesh::Model &model, const acul::vector<umbf::mesh::VertexGroup> &groups,
-                                  acul::stringstream &ss)
+    void Exporter::flush(Output &out, io::TextBuffer &buffer)
     {
-        // v
-        for (auto &group : groups)
+        if (buffer.size() >= write_chunk_size)
         {
-            auto &vertex_id = group.vertices.front();
-            amal::vec3 &pos = model.vertices[vertex_id].pos;
-            transform_vertex(pos, mesh_flags);
-            ss << "v " << pos.x << " " << pos.y << " " << pos.z << "\n";
+            flush_pending(out);
+            out.writer->push(buffer.take());
+            return;
         }
+        out.pending.insert(out.pending.end(), buffer.data(), buffer.data() + buffer.size());
+        buffer.take();
+        if (out.pending.size() >= write_chunk_size) flush_pending(out);
+    }
+
+    void Exporter::flush_pending(Output &out)
+    {
+        if (out.pending.empty()) return;
+        out.writer->push(std::move(out.pending));
+        out.pending = acul::vector<char>();
+    }
+
+    inline void write_line(io::TextBuffer &buffer, acul::string_view token, const acul::string &value)
+    {
+        buffer.append(token);
+        buffer.append(' ');
+        buffer.append(value.c_str(), value.size());
+        buffer.append('\n');
+    }
+
+    // Attribute value compared by its bits: NaN is collapsed to one pattern and -0 to +0, so every value finds itself
+    template <int N>
+    struct AttributeKey
+    {
+        u32 bits[N];
 
-        // vt and vn
-        for (auto &vertex : model.vertices)
+        template <typename V>
+        explicit AttributeKey(const V &value)
         {
-            if (mesh_flags & MeshExportFlagBits::export_uv)
+            static_assert(sizeof(V) == N * sizeof(f32));
+            f32 components[N];
+            std::memcpy(components, &value, sizeof(components));
+            for (int i = 0; i < N; ++i)
             {
-                auto [it, inserted] = _vt_map.emplace(vertex.uv, _vt_map.size());
-                if (inserted) ss << "vt " << vertex.uv.x << " " << vertex.uv.y << "\n";
+                const f32 c = components[i];
+                const f32 canonical = c != c ? std::numeric_limits<f32>::quiet_NaN() : c + 0.0f;
+                std::memcpy(bits + i, &canonical, sizeof(canonical));
             }
-            if (mesh_flags & MeshExportFlagBits::export_normals)
+        }
+
+        bool operator==(const AttributeKey &rhs) const { return std::memcmp(bits, rhs.bits, sizeof(bits)) == 0; }
+    };
+
+    struct AttributeKeyHash
+    {
+        template <int N>
+        size_t operator()(const AttributeKey<N> &key) const
+        {
+            u64 hash = 0xcbf29ce484222325ull;
+            for (int i = 0; i < N; ++i) hash = (hash ^ key.bits[i]) * 0x100000001b3ull;
+            return static_cast<size_t>(hash ^ (hash >> 32));
+        }
+    };
+
+    /**
+     * Deduplicates a per-vertex attribute of N components in parallel.
+     *
+     * Unique values are numbered in the order of their first occurrence, so the result does not depend on
+     * scheduling. Fills remap with the unique index of every vertex and returns the first vertex of every
+     * unique value.
+     */
+    template <int N, typename Get>
+    acul::vector<u32> dedup_attribute(size_t count, Get &&get, acul::vector<u32> &remap)
+    {
+        using range_t = oneapi::tbb::blocked_range<size_t>;
+        remap.resize(count);
+
+        // Owner of a value is the lowest vertex index holding it. The map does not move its entries on insertion,
+        // so every vertex keeps a pointer to the owner of its value.
+        oneapi::tbb::concurrent_unordered_map<AttributeKey<N>, std::atomic<u32>, AttributeKeyHash> owners;
+        acul::vector<std::atomic<u32> *> owner_of(count);
+        oneapi::tbb::parallel_for(range_t(0, count), [&](const range_t &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i)
             {
-                auto &normal = vertex.normal;
-                transform_vertex(normal, mesh_flags);
-                auto [it, inserted] = _vn_map.emplace(normal, _vn_map.size());
-                if (inserted) ss << "vn " << normal.x << " " << normal.y << " " << normal.z << "\n";
+                u32 index = static_cast<u32>(i);
+                auto [it, inserted] = owners.emplace(AttributeKey<N>(get(i)), index);
+                owner_of[i] = &it->second;
+                if (inserted) continue;
+                u32 current = it->second.load(std::memory_order_relaxed);
+                while (index < current &&
+                       !it->second.compare_exchange_weak(current, index, std::memory_order_relaxed));
             }
-        }
+        });
+        oneapi::tbb::parallel_for(range_t(0, count), [&](const range_t &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i)
+                remap[i] = owner_of[i]->load(std::memory_order_relaxed);
+        });
 
-        if ((mesh_flags & MeshExportFlagBits::transform_reverse_x) ||
-            (mesh_flags & MeshExportFlagBits::transform_reverse_y) ||
-            (mesh_flags & MeshExportFlagBits::transform_reverse_z))
-            for (auto &face : model.faces) std::reverse(face.vertices.begin(), face.vertices.end());
+        // Exclusive prefix sum over first occurrences gives the unique index of every owner
+        acul::vector<u32> rank(count);
+        u32 unique_count = oneapi::tbb::parallel_scan(
+            range_t(0, count), 0u,
+            [&](const range_t &range, u32 sum, bool is_final) {
+                for (size_t i = range.begin(); i != range.end(); ++i)
+                {
+                    if (is_final) rank[i] = sum;
+                    sum += remap[i] == i;
+                }
+                return sum;
+            },
+            std::plus<u32>());
+
+        acul::vector<u32> unique(unique_count);
+        oneapi::tbb::parallel_for(range_t(0, count), [&](const range_t &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i)
+            {
+                u32 owner = remap[i];
+                if (owner == i) unique[rank[i]] = i;
+                remap[i] = rank[owner];
+            }
+        });
+        return unique;
     }
 
-    void Exporter::write_triangles(umbf::mesh::Mesh *meta, acul::stringstream &os, const acul::vector<u32> &faces,
-                                   const acul::vector<umbf::mesh::VertexGroup> &groups)
+    // Per-object export state. Indices stay local to the object until the global offsets are known.
+    struct Exporter::ObjectSegment
     {
-        const auto &m = meta->model;
-        acul::vector<u32> positions(m.vertices.size());
-        for (size_t g = 0; g < groups.size(); g++)
-            for (auto id : groups[g].vertices) positions[id] = g;
+        acul::shared_ptr<umbf::mesh::Mesh> mesh;
+        acul::string name;
+        acul::vector<umbf::mesh::VertexGroup> groups;
+        acul::vector<u32> positions; // Position index of every vertex, triangulated export only
+        AttributeRemap remap;
+        acul::vector<u32> unique_uv;     // First vertex of every unique uv
+        acul::vector<u32> unique_normal; // First vertex of every unique normal
+        acul::vector<acul::shared_ptr<umbf::MaterialRange>> assignments;
+        acul::vector<const acul::string *> usemtl; // Material name per assignment, null if not written
+        u32 v_offset = 0;
+        u32 vt_offset = 0;
+        u32 vn_offset = 0;
+        bool uses_default_material = false;
+        u32 op_code = 0;
+        acul::string error;
+    };
+
+    static const acul::string default_material_name = "default";
+
+    void Exporter::prepare_object(const umbf::Object &object, ObjectSegment &segment)
+    {
+        acul::vector<acul::shared_ptr<umbf::MaterialRange>> assignes;
+        for (auto &block : object.meta)
+        {
+            switch (block->signature())
+            {
+                case umbf::sign_block::mesh:
+                    segment.mesh = acul::static_pointer_cast<umbf::mesh::Mesh>(block);
+                    break;
+                case umbf::sign_block::material_range:
+                    assignes.push_back(acul::static_pointer_cast<umbf::MaterialRange>(block));
+                    break;
+            }
+        }
+        if (!segment.mesh)
+        {
+            segment.error = acul::format("Mesh block not found in object: 0x%" PRIx64, object.id);
+            segment.op_code = AECL_OP_CODE_MESH_ERROR;
+            return;
+        }
+        segment.name = object.name;
+        const auto &model = segment.mesh->model;
+        auto &vertices = model.vertices;
+        umbf::utils::mesh::fill_vertex_groups(model, segment.groups);
+        if (mesh_flags & MeshExportFlagBits::export_uv)
+            segment.unique_uv = dedup_attribute<2>(
+                vertices.size(), [&](size_t i) -> const amal::vec2 & { return vertices[i].uv; }, segment.remap.uv);
+        if (mesh_flags & MeshExportFlagBits::export_normals)
+            segment.unique_normal = dedup_attribute<3>(
+                vertices.size(), [&](size_t i) -> const amal::vec3 & { return vertices[i].normal; },
+                segment.remap.normal);
+        if (mesh_flags & MeshExportFlagBits::export_triangulated)
+        {
+            segment.positions.resize(vertices.size());
+            for (size_t g = 0; g < segment.groups.size(); g++)
+                for (auto id : segment.groups[g].vertices) segment.positions[id] = g;
+        }
 
-        size_t thread_count = oneapi::tbb::this_task_arena::max_concurrency();
-        acul::vector<acul::stringstream> blocks(thread_count);
-        oneapi::tbb::parallel_for(
-            oneapi::tbb::blocked_range<size_t>(0, faces.size()), [&](const tbb::blocked_range<size_t> &range) {
-                size_t thread_id = oneapi::tbb::this_task_arena::current_thread_index();
-                for (size_t r = range.begin(); r != range.end(); ++r)
+        acul::vector<acul::shared_ptr<umbf::MaterialRange>> assignes_attr;
+        auto default_mat_id_it =
+            std::find_if(assignes.begin(), assignes.end(),
+                         [](const acul::shared_ptr<umbf::MaterialRange> &range) { return range->faces.empty(); });
+        u64 default_mat_id = default_mat_id_it == assignes.end() ? 0 : (*default_mat_id_it)->mat_id;
+        umbf::utils::filter_mat_assignments(assignes, model.faces.size(), default_mat_id, assignes_attr);
+        for (auto &assign : assignes_attr)
+        {
+            if (assign->faces.empty()) continue;
+            const acul::string *usemtl = nullptr;
+            if (material_flags != MaterialExportFlags::none)
+            {
+                if (assign->mat_id == 0)
+                {
+                    usemtl = &default_material_name;
+                    segment.uses_default_material = true;
+                }
+                else
                 {
-                    auto &face = m.faces[faces[r]];
-                    for (u32 iter = 0, current_id = face.first_vertex; iter < face.count / 3; ++iter)
+                    auto it = _material_map.find(assign->mat_id);
+                    if (it == _material_map.end())
                     {
-                        blocks[thread_id] << "f ";
-                        for (size_t vertex_id = 0; vertex_id < 3; ++vertex_id)
-                        {
-                            auto id = m.indices[current_id + vertex_id];
-                            blocks[thread_id] << positions[id] + 1 << "/";
-                            if (mesh_flags & MeshExportFlagBits::export_uv)
-                                blocks[thread_id] << _vt_map[m.vertices[id].uv] + 1;
-                            if (mesh_flags & MeshExportFlagBits::export_normals)
-                                blocks[thread_id] << "/" << _vn_map[m.vertices[id].normal] + 1;
-                            blocks[thread_id] << " ";
-                        }
-                        blocks[thread_id] << "\n";
-                        current_id += 3;
+                        segment.error = acul::format("Material not found: 0x%" PRIx64, assign->mat_id);
+                        segment.op_code |= AECL_OP_CODE_MATERIAL_ERROR;
                     }
+                    else usemtl = &it->second.name;
                 }
-            });
-        for (const auto &block : blocks) os << block.str();
+            }
+            segment.assignments.push_back(assign);
+            segment.usemtl.push_back(usemtl);
+        }
     }
 
-    void Exporter::write_faces(umbf::mesh::Mesh *meta, acul::stringstream &os, const acul::vector<u32> &faces)
-    {
-        size_t thread_count = oneapi::tbb::this_task_arena::max_concurrency();
-        acul::vector<acul::stringstream> blocks(thread_count);
-        auto &origin_faces = meta->model.faces;
-        oneapi::tbb::parallel_for(oneapi::tbb::blocked_range<size_t>(0, faces.size()),
-                                  [&](const tbb::blocked_range<size_t> &range) {
-                                      size_t thread_id = oneapi::tbb::this_task_arena::current_thread_index();
-                                      for (size_t i = range.begin(); i != range.end(); ++i)
-                                      {
-                                          blocks[thread_id] << "f ";
-                                          for (auto &ref : origin_faces[faces[i]].vertices)
-                                          {
-                                              blocks[thread_id] << ref.group + 1 << "/";
-                                              auto &vertex = meta->model.vertices[ref.vertex];
-                                              if (mesh_flags & MeshExportFlagBits::export_uv)
-                                                  blocks[thread_id] << _vt_map[vertex.uv] + 1;
-                                              if (mesh_flags & MeshExportFlagBits::export_normals)
-                                                  blocks[thread_id] << "/" << _vn_map[vertex.normal] + 1;
-                                              blocks[thread_id] << " ";
-                                          }
-                                          blocks[thread_id] << "\n";
-                                      }
-                                  });
-
-        for (const auto &block : blocks) os << block.str();
+    void Exporter::write_vertices(const ObjectSegment &segment, size_t begin, size_t end, io::TextBuffer &buffer)
+    {
+        if (begin == 0)
+        {
+            if (obj_flags & ObjExportFlagBits::object_policy_groups) write_line(buffer, "g", segment.name);
+            else if (obj_flags & ObjExportFlagBits::object_policy_objects) write_line(buffer, "o", segment.name);
+        }
+
+        AxisTransform transform(mesh_flags);
+        auto &vertices = segment.mesh->model.vertices;
+        auto &groups = segment.groups;
+        const size_t v_end = groups.size();
+        const size_t vt_end = v_end + segment.unique_uv.size();
+        acul::vector<amal::vec3> transformed;
+
+        // v
+        if (begin < v_end)
+        {
+            const size_t first = begin, count = std::min(end, v_end) - begin;
+            transformed.resize(count);
+            transform.apply(
+                count, [&](size_t i) -> const amal::vec3 & { return vertices[groups[first + i].vertices.front()].pos; },
+                transformed.data());
+            for (auto &pos : transformed) buffer.append_vec3("v", pos);
+        }
+
+        // vt
+        for (size_t i = std::max(begin, v_end); i < std::min(end, vt_end); ++i)
+            buffer.append_vec2("vt", vertices[segment.unique_uv[i - v_end]].uv);
+
+        // vn. The transform is a bijection, so source normals are deduplicated and only unique ones are transformed
+        if (end > vt_end)
+        {
+            const u32 *unique = segment.unique_normal.data() + (std::max(begin, vt_end) - vt_end);
+            const size_t count = end - std::max(begin, vt_end);
+            transformed.resize(count);
+            transform.apply(
+                count, [&](size_t i) -> const amal::vec3 & { return vertices[unique[i]].normal; },
+                transformed.data());
+            for (auto &normal : transformed) buffer.append_vec3("vn", normal);
+        }
     }
 
-    inline void write_vec3_as_rgb(acul::stringstream &os, const acul::string &token, const amal::vec3 &vec)
+    // Upper bound of the size of one " v/vt/vn" face reference
+    constexpr size_t max_face_ref_size = 34;
+
+    // Writes a " v/vt/vn" face reference with 1-based indices
+    template <bool uv, bool normals>
+    inline char *write_face_ref(char *it, u32 pos, u32 uv_id, u32 normal_id)
     {
-        os << token << " " << vec.x << " " << vec.y << " " << vec.z << "\n";
+        *it++ = ' ';
+        it = io::write_uint(it, pos + 1);
+        if constexpr (uv)
+        {
+            *it++ = '/';
+            it = io::write_uint(it, uv_id + 1);
+        }
+        if constexpr (normals)
+        {
+            if constexpr (!uv) *it++ = '/';
+            *it++ = '/';
+            it = io::write_uint(it, normal_id + 1);
+        }
+        return it;
     }
 
+    // Faces formatted by one task before its text goes to the in-order sink
+    constexpr size_t face_chunk_size = 4096;
+
+    // v/vt/vn lines formatted by one task, so the text of a large mesh is never held at once
+    constexpr size_t vertex_chunk_size = 16384;
+
     /**
-     * Writes a number to the output stream with a given token.
+     * Formats [0, count) in fixed chunks on all threads and hands the buffers to the sink in chunk order,
+     * so the output does not depend on scheduling or thread count. The number of chunks in flight is bounded.
+     */
+    template <typename Format, typename Sink>
+    void format_ordered(size_t count, size_t chunk_size, int precision, Format &&format, Sink &&sink)
+    {
+        const size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+        const size_t max_tokens = oneapi::tbb::this_task_arena::max_concurrency() * 2;
+        size_t next = 0;
+        auto input = [&](oneapi::tbb::flow_control &fc) -> size_t {
+            if (next == chunk_count)
+            {
+                fc.stop();
+                return 0;
+            }
+            return next++;
+        };
+        auto transform = [&](size_t chunk) {
+            io::TextBuffer buffer(precision);
+            size_t begin = chunk * chunk_size;
+            format(buffer, begin, std::min(begin + chunk_size, count));
+            return buffer;
+        };
+        auto output = [&](io::TextBuffer buffer) { sink(buffer); };
+        oneapi::tbb::parallel_pipeline(
+            max_tokens,
+            oneapi::tbb::make_filter<void, size_t>(oneapi::tbb::filter_mode::serial_in_order, input) &
+                oneapi::tbb::make_filter<size_t, io::TextBuffer>(oneapi::tbb::filter_mode::parallel, transform) &
+                oneapi::tbb::make_filter<io::TextBuffer, void>(oneapi::tbb::filter_mode::serial_in_order, output));
+    }
+
+    template <bool uv, bool normals, bool flip>
+    void Exporter::write_triangles(const ObjectSegment &segment, const acul::vector<u32> &faces, size_t begin,
+                                   size_t end, io::TextBuffer &block)
+    {
+        const auto &m = segment.mesh->model;
+        const u32 *positions = segment.positions.data();
+        const u32 *uv_remap = segment.remap.uv.data();
+        const u32 *normal_remap = segment.remap.normal.data();
+        for (size_t r = begin; r != end; ++r)
+        {
+            auto &face = m.faces[faces[r]];
+            const u32 triangle_count = face.count / 3;
+            char *dst = block.ensure(triangle_count * (3 * max_face_ref_size + 2));
+            char *it = dst;
+            for (u32 iter = 0, current_id = face.first_vertex; iter < triangle_count; ++iter, current_id += 3)
+            {
+                const u32 *ids = m.indices.data() + current_id;
+                *it++ = 'f';
+                for (u32 k = 0; k < 3; ++k)
+                {
+                    const u32 id = ids[flip ? 2 - k : k];
+                    it = write_face_ref<uv, normals>(it, segment.v_offset + positions[id],
+                                                     uv ? segment.vt_offset + uv_remap[id] : 0,
+                                                     normals ? segment.vn_offset + normal_remap[id] : 0);
+                }
+                *it++ = '\n';
+            }
+            block.commit(it - dst);
+        }
+    }
+
+    template <bool uv, bool normals, bool flip>
+    void Exporter::write_faces(const ObjectSegment &segment, const acul::vector<u32> &faces, size_t begin,
+                               size_t end, io::TextBuffer &block)
+    {
+        auto &origin_faces = segment.mesh->model.faces;
+        const u32 *uv_remap = segment.remap.uv.data();
+        const u32 *normal_remap = segment.remap.normal.data();
+        for (size_t i = begin; i != end; ++i)
+        {
+            auto &refs = origin_faces[faces[i]].vertices;
+            const size_t count = refs.size();
+            char *dst = block.ensure(count * max_face_ref_size + 2);
+            char *it = dst;
+            *it++ = 'f';
+            for (size_t v = 0; v < count; ++v)
+            {
+                auto &ref = refs[flip ? count - 1 - v : v];
+                it = write_face_ref<uv, normals>(it, segment.v_offset + ref.group,
+                                                 uv ? segment.vt_offset + uv_remap[ref.vertex] : 0,
+                                                 normals ? segment.vn_offset + normal_remap[ref.vertex] : 0);
+            }
+            *it++ = '\n';
+            block.commit(it - dst);
+        }
+    }
+
+    Exporter::FaceKernel Exporter::select_face_kernel(MeshExportFlags flags, bool flip_winding)
+    {
+        // Indexed by uv | normals << 1 | flip << 2
+        static constexpr FaceKernel polygons[8] = {
+            &write_faces<false, false, false>, &write_faces<true, false, false>, &write_faces<false, true, false>,
+            &write_faces<true, true, false>,   &write_faces<false, false, true>, &write_faces<true, false, true>,
+            &write_faces<false, true, true>,   &write_faces<true, true, true>};
+        static constexpr FaceKernel triangles[8] = {
+            &write_triangles<false, false, false>, &write_triangles<true, false, false>,
+            &write_triangles<false, true, false>,  &write_triangles<true, true, false>,
+            &write_triangles<false, false, true>,  &write_triangles<true, false, true>,
+            &write_triangles<false, true, true>,   &write_triangles<true, true, true>};
+        size_t index = (flags & MeshExportFlagBits::export_uv ? 1 : 0) |
+                       (flags & MeshExportFlagBits::export_normals ? 2 : 0) | (flip_winding ? 4 : 0);
+        return flags & MeshExportFlagBits::export_triangulated ? triangles[index] : polygons[index];
+    }
+
+    inline void write_vec3_as_rgb(io::TextBuffer &buffer, acul::string_view token, const amal::vec3 &vec)
+    {
+        buffer.append_vec3(token, vec);
+    }
+
+    /**
+     * Writes a number to the output buffer with a given token.
      *
-     * @param os The output stream to write to.
+     * @param buffer The output buffer to write to.
      * @param token The token to write before the number.
      * @param value The number to write.
      */
-    template <typename T>
-    inline void write_number(acul::stringstream &os, const acul::string &token, const T &value)
+    inline void write_number(io::TextBuffer &buffer, acul::string_view token, f32 value)
+    {
+        buffer.append(token);
+        buffer.append(' ');
+        buffer.append_float(value);
+        buffer.append('\n');
+    }
+
+    inline void write_number(io::TextBuffer &buffer, acul::string_view token, u32 value)
     {
-        os << token << " " << value << "\n";
+        buffer.append(token);
+        buffer.append(' ');
+        buffer.append_uint(value);
+        buffer.append('\n');
     }
 
-    void Exporter::write_texture(acul::stringstream &os, const acul::string &token, const acul::string &tex)
+    void Exporter::write_texture(io::TextBuffer &buffer, const acul::string &token, const acul::string &tex)
     {
-        if (material_flags == MaterialExportFlags::texture_origin) os << token << " " << tex << "\n";
+        if (material_flags == MaterialExportFlags::texture_origin) write_line(buffer, token, tex);
         else if (material_flags == MaterialExportFlags::texture_copy)
         {
-            acul::path parent = acul::path(path).parent_path();
-            acul::path tex_path = parent / "tex" / tex;
-            if (acul::fs::copy_file(tex.c_str(), tex_path.str().c_str(), true))
-                os << token << " ./tex/" << tex_path.filename() << "\n";
+            auto it = _texture_refs.find(tex);
+            if (it != _texture_refs.end()) write_line(buffer, token, it->second);
+        }
+    }
+
+    void Exporter::copy_textures(oneapi::tbb::task_group &tasks)
+    {
+        _texture_refs.clear();
+        _texture_copies.clear();
+        if (material_flags != MaterialExportFlags::texture_copy) return;
+
+        // Every used source is copied once. Names are given in texture order, so they don't depend on the
+        // iteration order of the material map.
+        acul::vector<char> used(textures.size(), false);
+        for (auto &[id, ref] : _material_map)
+            if (ref.mat && ref.mat->albedo.textured) used[ref.mat->albedo.texture_id] = true;
+        acul::path tex_dir = acul::path(path).parent_path() / "tex";
+        acul::hashset<acul::string> names;
+        for (size_t i = 0; i < textures.size(); ++i)
+        {
+            auto &tex = textures[i];
+            if (!used[i] || _texture_refs.find(tex) != _texture_refs.end()) continue;
+            acul::string name = io::make_unique_filename(acul::fs::get_filename(tex), names);
+            _texture_refs[tex] = "./tex/" + name;
+            _texture_copies.push_back({tex, (tex_dir / name).str(), false});
         }
+
+        tasks.run([this] {
+            oneapi::tbb::parallel_for(size_t(0), _texture_copies.size(), [this](size_t i) {
+                auto &copy = _texture_copies[i];
+                copy.done = io::copy_file(copy.source, copy.target);
+            });
+        });
     }
 
-    void write_default_material(std::ofstream &os, bool use_pbr)
+    void write_default_material(io::TextBuffer &mat_block, bool use_pbr)
     {
-        acul::stringstream mat_block;
-        mat_block << "newmtl default\n";
+        mat_block.append("\nnewmtl default\n");
         write_vec3_as_rgb(mat_block, "Ka", {1, 1, 1});
         write_vec3_as_rgb(mat_block, "Kd", {1, 1, 1});
         write_vec3_as_rgb(mat_block, "Ks", {1, 1, 1});
-        write_number(mat_block, "Ns", 80);
+        write_number(mat_block, "Ns", 80.0f);
         if (use_pbr)
         {
-            write_number(mat_block, "Pr", 0.33);
-            write_number(mat_block, "Pm", 1);
+            write_number(mat_block, "Pr", 0.33f);
+            write_number(mat_block, "Pm", 1.0f);
         }
-        write_number(mat_block, "illum", 7);
-        os << "\n" << mat_block.str().c_str();
+        write_number(mat_block, "illum", 7u);
     }
 
-    void Exporter::write_material(const acul::shared_ptr<umbf::MaterialInfo> &material_info,
-                                  const acul::shared_ptr<umbf::Material> &material, std::ostream &os)
+    void Exporter::write_material(const MaterialRef &ref, io::TextBuffer &mat_block)
     {
-        acul::stringstream mat_block;
-        mat_block << "newmtl " << material_info->name << "\n";
+        auto &material = ref.mat;
+        mat_block.append('\n');
+        write_line(mat_block, "newmtl", ref.name);
         write_vec3_as_rgb(mat_block, "Ka", {1, 1, 1});
         write_vec3_as_rgb(mat_block, "Kd", material->albedo.rgb);
         if (material->albedo.textured)
@@ -180,34 +516,69 @@ namespace aecl::scene::obj
             write_texture(mat_block, "map_Kd", tex);
         }
         write_vec3_as_rgb(mat_block, "Ks", {1, 1, 1});
-        write_number(mat_block, "Ns", 80);
+        write_number(mat_block, "Ns", 80.0f);
         if (obj_flags & ObjExportFlagBits::materials_pbr)
         {
-            write_number(mat_block, "Pr", 0.33);
-            write_number(mat_block, "Pm", 1);
+            write_number(mat_block, "Pr", 0.33f);
+            write_number(mat_block, "Pm", 1.0f);
         }
-        write_number(mat_block, "illum", 7);
-        os << "\n" << mat_block.str().c_str();
+        write_number(mat_block, "illum", 7u);
     }
 
-    bool Exporter::write_mtllib_info(std::ofstream &mtl_stream, acul::stringstream &obj_stream)
+    inline const char *get_compression_suffix(ObjCompression compression)
     {
-        if (material_flags != MaterialExportFlags::none)
+        return compression == ObjCompression::gzip ? ".gz" : compression == ObjCompression::zstd ? ".zst" : "";
+    }
+
+    // MTL path: the output path without the compression suffix and with the .mtl extension
+    acul::string get_mtl_path(const acul::string &path, ObjCompression compression)
+    {
+        const char *suffix = get_compression_suffix(compression);
+        size_t size = strlen(suffix);
+        if (size > 0 && path.size() > size && memcmp(path.c_str() + path.size() - size, suffix, size) == 0)
+            return acul::fs::replace_extension(acul::string(path.c_str(), path.size() - size), ".mtl");
+        return acul::fs::replace_extension(path, ".mtl");
+    }
+
+    /**
+     * Paths of the split export: one file per object next to the output path. Characters unsafe in file names
+     * are replaced and repeated object names get an index suffix.
+     */
+    static acul::vector<acul::string> get_split_paths(const acul::string &path,
+                                                      const acul::vector<umbf::Object> &objects,
+                                                      ObjCompression compression)
+    {
+        const acul::path dir = acul::path(path).parent_path();
+        const char *suffix = get_compression_suffix(compression);
+        acul::hashset<acul::string> names;
+        acul::vector<acul::string> paths(objects.size());
+        for (size_t i = 0; i < objects.size(); ++i)
         {
-            acul::string mtl_path = acul::fs::replace_extension(path, ".mtl");
-            mtl_stream.open(mtl_path.c_str());
-            if (!mtl_stream.is_open())
-            {
-                _error = acul::format("Failed to write mtl file. Error: %s", std::strerror(errno));
-                return false;
-            }
-            else
-            {
-                obj_stream << "mtllib ./" << acul::fs::get_filename(mtl_path) << "\n";
-                mtl_stream << "# App3D ECL MTL Exporter\n";
-            }
+            acul::string stem = objects[i].name.empty() ? acul::string("object") : objects[i].name;
+            for (auto &c : stem)
+                if (!isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_' && c != '.') c = '_';
+            acul::string name = stem;
+            for (size_t n = 1; !names.insert(name).second; ++n) name = acul::format("%s_%zu", stem.c_str(), n);
+            paths[i] = (dir / (name + ".obj" + suffix)).str();
         }
+        return paths;
+    }
 
+    bool Exporter::open_mtl(std::ofstream &mtl_stream)
+    {
+        mtl_stream.open(get_mtl_path(path, compression).c_str());
+        if (mtl_stream.is_open()) return true;
+        _error = acul::format("Failed to write mtl file. Error: %s", std::strerror(errno));
+        return false;
+    }
+
+    void Exporter::build_material_map()
+    {
+        _material_map.clear();
+        _all_materials_exist = true;
+        // Materials are referenced by name, so repeated names get an index suffix in material order
+        acul::hashset<acul::string> names;
+        names.insert(default_material_name);
         for (auto &material : Exporter::materials)
         {
             acul::shared_ptr<umbf::Material> ptr;
@@ -221,7 +592,10 @@ namespace aecl::scene::obj
                     case umbf::sign_block::material_info:
                     {
                         auto info = acul::static_pointer_cast<umbf::MaterialInfo>(block);
-                        _material_map[info->id] = {info, ptr};
+                        acul::string name = info->name;
+                        for (size_t n = 1; !names.insert(name).second; ++n)
+                            name = acul::format("%s_%zu", info->name.c_str(), n);
+                        _material_map[info->id] = {info, ptr, std::move(name)};
                     }
                     break;
                     default:
@@ -229,95 +603,241 @@ namespace aecl::scene::obj
                 }
             }
         }
-        return true;
     }
 
-    u32 Exporter::write_object(const umbf::Object &object, acul::stringstream &stream)
+    // Unit of ordered output: a run of the v/vt/vn lines of an object or of the faces of one material range
+    struct Section
     {
-        acul::shared_ptr<umbf::mesh::Mesh> mesh;
-        acul::vector<acul::shared_ptr<umbf::MaterialRange>> assignes;
-        for (auto &block : object.meta)
+        u32 segment;
+        u32 assignment;
+        size_t begin;
+        size_t end;
+    };
+
+    constexpr u32 vertex_section = std::numeric_limits<u32>::max();
+
+    u32 Exporter::write_objects(const umbf::Object *objects, size_t count, Output &out)
+    {
+        // Objects are prepared independently with local indices
+        acul::vector<ObjectSegment> segments(count);
+        oneapi::tbb::parallel_for(size_t(0), count, [&](size_t i) { prepare_object(objects[i], segments[i]); });
+
+        // Exclusive prefix sum of the element counts gives the global index offsets
+        u32 op_code = 0;
+        u32 v_count = 0, vt_count = 0, vn_count = 0;
+        acul::vector<Section> sections;
+        for (u32 i = 0; i < segments.size(); ++i)
         {
-            switch (block->signature())
+            auto &segment = segments[i];
+            op_code |= segment.op_code;
+            if (!segment.error.empty()) out.error = segment.error;
+            if (!segment.mesh) continue;
+            if (segment.uses_default_material) out.uses_default_material = true;
+            segment.v_offset = v_count;
+            segment.vt_offset = vt_count;
+            segment.vn_offset = vn_count;
+            v_count += segment.groups.size();
+            vt_count += segment.unique_uv.size();
+            vn_count += segment.unique_normal.size();
+
+            // The v, vt and vn lines are numbered over the three blocks in order
+            const size_t vertex_lines = segment.groups.size() + segment.unique_uv.size() + segment.unique_normal.size();
+            size_t first = 0;
+            do
             {
-                case umbf::sign_block::mesh:
-                    mesh = acul::static_pointer_cast<umbf::mesh::Mesh>(block);
-                    break;
-                case umbf::sign_block::material_range:
-                    assignes.push_back(acul::static_pointer_cast<umbf::MaterialRange>(block));
-                    break;
+                sections.push_back({i, vertex_section, first, std::min(first + vertex_chunk_size, vertex_lines)});
+                first += vertex_chunk_size;
+            } while (first < vertex_lines);
+            for (u32 a = 0; a < segment.assignments.size(); ++a)
+            {
+                size_t face_count = segment.assignments[a]->faces.size();
+                for (size_t begin = 0; begin < face_count; begin += face_chunk_size)
+                    sections.push_back({i, a, begin, std::min(begin + face_chunk_size, face_count)});
             }
         }
-        if (!mesh)
-        {
-            _error = acul::format("Mesh block not found in object: 0x%" PRIx64, object.id);
-            return AECL_OP_CODE_MESH_ERROR;
-        }
-        acul::vector<umbf::mesh::VertexGroup> vertex_groups;
-        umbf::utils::mesh::fill_vertex_groups(mesh->model, vertex_groups);
-        if (obj_flags & ObjExportFlagBits::object_policy_groups) stream << "g " << object.name << "\n";
-        else if (obj_flags & ObjExportFlagBits::object_policy_objects) stream << "o " << object.name << "\n";
-        auto &model = mesh->model;
-        write_vertices(model, vertex_groups, stream);
-        acul::vector<acul::shared_ptr<umbf::MaterialRange>> assignes_attr;
-        auto default_mat_id_it =
-            std::find_if(assignes.begin(), assignes.end(),
-                         [](const acul::shared_ptr<umbf::MaterialRange> &range) { return range->faces.empty(); });
-        u64 default_mat_id = default_mat_id_it == assignes.end() ? 0 : (*default_mat_id_it)->mat_id;
-        umbf::utils::filter_mat_assignments(assignes, model.faces.size(), default_mat_id, assignes_attr);
-        u32 op_code = 0;
-        for (auto &assign : assignes_attr)
+
+        // Batch small sections so that scenes of many tiny objects still give tasks of useful size
+        acul::vector<size_t> batches{0};
+        size_t cost = 0;
+        for (size_t i = 0; i < sections.size(); ++i)
         {
-            if (assign->faces.empty()) continue;
-            if (material_flags != MaterialExportFlags::none)
+            auto &section = sections[i];
+            cost += section.end - section.begin;
+            if (cost >= face_chunk_size)
             {
-                if (assign->mat_id == 0)
-                {
-                    stream << "usemtl default\n";
-                    _all_materials_exist = false;
-                }
-                else
-                {
-                    auto it = _material_map.find(assign->mat_id);
-                    if (it == _material_map.end())
-                    {
-                        _error = acul::format("Material not found: 0x%" PRIx64, assign->mat_id);
-                        op_code |= AECL_OP_CODE_MATERIAL_ERROR;
-                    }
-                    else stream << "usemtl " << it->second.info->name << "\n";
-                }
+                batches.push_back(i + 1);
+                cost = 0;
             }
-            if (mesh_flags & MeshExportFlagBits::export_triangulated)
-                write_triangles(mesh.get(), stream, assign->faces, vertex_groups);
-            else write_faces(mesh.get(), stream, assign->faces);
         }
+        if (batches.back() != sections.size()) batches.push_back(sections.size());
+
+        auto write_section = [&](const Section &section, io::TextBuffer &buffer) {
+            auto &segment = segments[section.segment];
+            if (section.assignment == vertex_section)
+                return write_vertices(segment, section.begin, section.end, buffer);
+            auto &faces = segment.assignments[section.assignment]->faces;
+            auto *usemtl = segment.usemtl[section.assignment];
+            if (section.begin == 0 && usemtl) write_line(buffer, "usemtl", *usemtl);
+            _face_kernel(segment, faces, section.begin, section.end, buffer);
+        };
+        format_ordered(
+            batches.size() - 1, 1, float_precision,
+            [&](io::TextBuffer &buffer, size_t begin, size_t end) {
+                for (size_t b = begin; b != end; ++b)
+                    for (size_t i = batches[b]; i != batches[b + 1]; ++i) write_section(sections[i], buffer);
+            },
+            [&](io::TextBuffer &buffer) { flush(out, buffer); });
         return op_code;
     }
 
-    void Exporter::write_mtl(std::ofstream &stream)
+    void Exporter::write_mtl(io::TextBuffer &buffer)
+    {
+        buffer.append("# App3D ECL MTL Exporter\n");
+        if (!_all_materials_exist) write_default_material(buffer, obj_flags & ObjExportFlagBits::materials_pbr);
+        for (auto it = _material_map.begin(); it != _material_map.end(); it++) write_material(it->second, buffer);
+    }
+
+    u32 Exporter::write_mtl_file(std::ofstream &mtl_stream, ISink *mtl_sink)
     {
-        if (!stream) return;
-        if (!_all_materials_exist) write_default_material(stream, obj_flags & ObjExportFlagBits::materials_pbr);
-        for (auto it = _material_map.begin(); it != _material_map.end(); it++)
+        io::TextBuffer mtl(float_precision);
+        write_mtl(mtl);
+        if (mtl_stream.is_open())
+        {
+            mtl_stream.write(mtl.data(), mtl.size());
+            mtl_stream.close();
+            if (!mtl_stream) return AECL_OP_CODE_MATERIAL_ERROR;
+        }
+        else if (mtl_sink && !mtl_sink->write(mtl.data(), mtl.size()))
         {
-            auto &ref = it->second;
-            write_material(ref.info, ref.mat, stream);
+            _error = "Failed to write mtl data";
+            return AECL_OP_CODE_MATERIAL_ERROR;
         }
-        stream.close();
+        return 0;
     }
 
-    acul::op_result Exporter::save()
+    acul::op_result Exporter::save() { return split_objects ? write_split_scene() : write_scene(nullptr, nullptr); }
+
+    acul::op_result Exporter::save(ISink &obj_sink, ISink *mtl_sink) { return write_scene(&obj_sink, mtl_sink); }
+
+    acul::op_result Exporter::write_scene(ISink *obj_sink, ISink *mtl_sink)
     {
         _error.clear();
-        acul::stringstream ss;
-        ss << "# App3D ECL OBJ Exporter\n";
+        _split_paths.clear();
+        auto codec = static_cast<io::Compression>(compression);
+        if (!io::is_compression_supported(codec))
+        {
+            _error = "Compression is not supported by this build";
+            return acul::op_result(ACUL_OP_WRITE_ERROR, AECL_OP_DOMAIN, 0);
+        }
+        io::StreamWriter writer;
+        bool opened = obj_sink ? writer.open(obj_sink, 3, codec, compression_level)
+                               : writer.open(path, 3, drop_page_cache, codec, compression_level);
+        if (!opened)
+        {
+            _error = acul::format("Failed to open obj file. Error: %s", std::strerror(errno));
+            return acul::op_result(ACUL_OP_WRITE_ERROR, AECL_OP_DOMAIN, 0);
+        }
+        Output out;
+        out.writer = &writer;
+        _face_kernel = select_face_kernel(mesh_flags, AxisTransform(mesh_flags).flip_winding);
+        io::TextBuffer ss;
+        ss.append("# App3D ECL OBJ Exporter\n");
         std::ofstream mtl_stream;
-        u32 op_code = write_mtllib_info(mtl_stream, ss) ? 0 : AECL_OP_CODE_MATERIAL_ERROR;
-        for (auto &object : objects) op_code |= write_object(object, ss);
+        u32 op_code = 0;
+        build_material_map();
+        if (material_flags != MaterialExportFlags::none)
+        {
+            if (obj_sink || open_mtl(mtl_stream))
+                write_line(ss, "mtllib", "./" + acul::fs::get_filename(get_mtl_path(path, compression)));
+            else op_code = AECL_OP_CODE_MATERIAL_ERROR;
+        }
+        flush(out, ss);
+        // Textures are copied while the body is formatted
+        oneapi::tbb::task_group texture_tasks;
+        copy_textures(texture_tasks);
+        op_code |= write_objects(objects.data(), objects.size(), out);
+        texture_tasks.wait();
+        for (auto &copy : _texture_copies)
+            if (!copy.done) _texture_refs.erase(copy.source);
+        flush_pending(out);
+        if (out.uses_default_material) _all_materials_exist = false;
+        if (!out.error.empty()) _error = out.error;
+
+        if (!writer.close())
+        {
+            _error = "Failed to write obj file";
+            return acul::op_result(ACUL_OP_WRITE_ERROR, AECL_OP_DOMAIN, op_code);
+        }
 
-        auto wr = acul::fs::write_by_block(path, ss.str().c_str(), 1024 * 1024);
-        if (!wr.success()) return wr;
-        write_mtl(mtl_stream);
+        if (material_flags == MaterialExportFlags::none)
+            return acul::op_result(ACUL_OP_SUCCESS, AECL_OP_DOMAIN, op_code);
+        op_code |= write_mtl_file(mtl_stream, mtl_sink);
+        return acul::op_result(ACUL_OP_SUCCESS, AECL_OP_DOMAIN, op_code);
+    }
+
+    acul::op_result Exporter::write_split_scene()
+    {
+        _error.clear();
+        auto codec = static_cast<io::Compression>(compression);
+        if (!io::is_compression_supported(codec))
+        {
+            _error = "Compression is not supported by this build";
+            return acul::op_result(ACUL_OP_WRITE_ERROR, AECL_OP_DOMAIN, 0);
+        }
+        _face_kernel = select_face_kernel(mesh_flags, AxisTransform(mesh_flags).flip_winding);
+        std::ofstream mtl_stream;
+        u32 op_code = 0;
+        build_material_map();
+        acul::string mtllib;
+        if (material_flags != MaterialExportFlags::none)
+        {
+            if (open_mtl(mtl_stream)) mtllib = "./" + acul::fs::get_filename(get_mtl_path(path, compression));
+            else op_code = AECL_OP_CODE_MATERIAL_ERROR;
+        }
+        _split_paths = get_split_paths(path, objects, compression);
+
+        // Every object is written by its own task and writer, the material table is only read
+        oneapi::tbb::task_group texture_tasks;
+        copy_textures(texture_tasks);
+        acul::vector<Output> outputs(objects.size());
+        acul::vector<u32> codes(objects.size(), 0);
+        acul::vector<u8> written(objects.size(), 0);
+        oneapi::tbb::parallel_for(size_t(0), objects.size(), [&](size_t i) {
+            auto &out = outputs[i];
+            io::StreamWriter writer;
+            if (!writer.open(_split_paths[i], 3, drop_page_cache, codec, compression_level))
+            {
+                out.error = acul::format("Failed to open obj file %s. Error: %s", _split_paths[i].c_str(),
+                                         std::strerror(errno));
+                return;
+            }
+            out.writer = &writer;
+            io::TextBuffer header;
+            header.append("# App3D ECL OBJ Exporter\n");
+            if (!mtllib.empty()) write_line(header, "mtllib", mtllib);
+            flush(out, header);
+            codes[i] = write_objects(&objects[i], 1, out);
+            flush_pending(out);
+            written[i] = writer.close();
+            if (!written[i] && out.error.empty())
+                out.error = acul::format("Failed to write obj file %s", _split_paths[i].c_str());
+        });
+        texture_tasks.wait();
+        for (auto &copy : _texture_copies)
+            if (!copy.done) _texture_refs.erase(copy.source);
+
+        bool success = true;
+        for (size_t i = 0; i < objects.size(); ++i)
+        {
+            op_code |= codes[i];
+            success = success && written[i];
+            if (outputs[i].uses_default_material) _all_materials_exist = false;
+            if (!outputs[i].error.empty()) _error = outputs[i].error;
+        }
+        if (!success) return acul::op_result(ACUL_OP_WRITE_ERROR, AECL_OP_DOMAIN, op_code);
+        if (material_flags == MaterialExportFlags::none)
+            return acul::op_result(ACUL_OP_SUCCESS, AECL_OP_DOMAIN, op_code);
+        op_code |= write_mtl_file(mtl_stream, nullptr);
         return acul::op_result(ACUL_OP_SUCCESS, AECL_OP_DOMAIN, op_code);
     }
-} // namespace aecl::scene::obj
\ No newline at end of file
+} // namespace aecl::scene::obj
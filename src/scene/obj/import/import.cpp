@@ -6,20 +6,15 @@
 #include <aecl/scene/obj/import.hpp>
 #include <aecl/scene/utils.hpp>
 #include <aecl/status.hpp>
+#include <oneapi/tbb/parallel_for.h>
 #include <oneapi/tbb/parallel_sort.h>
 #include <umbf/version.h>
+#include "../../../io/file.hpp"
 #include "geom.cpp_"
 #include "mat.cpp_"
 
 namespace aecl::scene::obj
 {
-    inline int get_group_range_end(int start_index, int range_end, ParseDataRead &data)
-    {
-        for (size_t i = start_index; i < data.f.size(); ++i)
-            if (data.f[i].index >= range_end) return i;
-        return data.f.size();
-    }
-
     using namespace umbf::mesh;
 
     struct GroupRange
@@ -28,6 +23,9 @@ namespace aecl::scene::obj
         int range_end;
         acul::string name;
         acul::shared_ptr<Mesh> mesh;
+        int first_line = 0; // Source lines of the group
+        int end_line = 0;
+        u64 object_id = 0; // Object id of a group reused from the manifest
     };
 
     amal::vec3 calculate_normal(const ParseDataRead &data, const acul::vector<amal::ivec3> &__restrict in_face)
@@ -82,7 +80,7 @@ namespace aecl::scene::obj
         else face.vertices.emplace_back(vertex_group_id, *it);
     }
 
-    void index_mesh(size_t face_count, const ParseDataRead &data, GroupRange &group)
+    void index_mesh(size_t face_count, const ParseDataRead &data, GroupRange &group, const ProgressToken *token)
     {
         acul::hl_hashmap<amal::ivec3, u32> vtn_map;
         acul::vector<VertexGroup> vertex_groups;
@@ -94,6 +92,7 @@ namespace aecl::scene::obj
         acul::vector<int> pos_map(data.v.size(), -1);
         for (size_t f = 0; f < face_count; ++f)
         {
+            if ((f & 0xFFF) == 0 && is_cancelled(token)) return;
             auto &in_face = data.f[group.start_index + f].value;
             auto &face = m.faces[f];
             face.normal = calculate_normal(data, *in_face);
@@ -129,11 +128,13 @@ namespace aecl::scene::obj
     void convert_to_materials(const acul::string &base_path, const acul::vector<Material> &mtl_list,
                               acul::hl_hashmap<acul::string, int> &mat_map,
                               acul::vector<acul::shared_ptr<umbf::File>> &materials,
+                              acul::vector<acul::shared_ptr<umbf::MaterialInfo>> &infos,
                               acul::vector<acul::shared_ptr<umbf::Target>> &textures)
     {
         acul::hl_hashmap<acul::string, size_t> tex_map;
         mat_map.reserve(mtl_list.size());
         materials.resize(mtl_list.size());
+        infos.resize(mtl_list.size());
         auto generator = acul::id_gen();
         for (size_t i = 0; i < mtl_list.size(); ++i)
         {
@@ -153,20 +154,21 @@ namespace aecl::scene::obj
                     target->header.type_sign = umbf::sign_block::format::target;
                     target->header.spec_version = UMBF_VERSION;
                     target->header.flags = 0;
-                    target->url = base_path;
+                    target->url = parsed_path;
                     target->checksum = 0;
                     textures.push_back(target);
                 }
                 mat->albedo.textured = true;
                 mat->albedo.texture_id = it->second;
             }
+            infos[i] = acul::make_shared<umbf::MaterialInfo>(generator(), mat_it->first);
             materials[i] = acul::make_shared<umbf::File>();
             materials[i]->header.vendor_sign = UMBF_VENDOR_ID;
             materials[i]->header.vendor_version = UMBF_VERSION;
             materials[i]->header.spec_version = UMBF_VERSION;
             materials[i]->header.type_sign = umbf::sign_block::format::material;
             materials[i]->blocks.push_back(mat);
-            materials[i]->blocks.push_back(acul::make_shared<umbf::MaterialInfo>(generator(), mat_it->first));
+            materials[i]->blocks.push_back(infos[i]);
         }
     }
 
@@ -186,104 +188,177 @@ namespace aecl::scene::obj
         dst.use_mtl.assign(src.use_mtl.begin(), src.use_mtl.end());
     }
 
-    void create_group_ranges(ParseDataRead &data, acul::vector<GroupRange> &groups)
+    void create_group_ranges(ParseDataRead &data, int line_count, acul::vector<GroupRange> &groups)
     {
         groups.reserve(data.g.size() + 1);
 
         if (data.f.size() == 0) return;
 
+        // Faces and group lines are both sorted by line index, so a single merged sweep splits the faces
+        const int face_count = static_cast<int>(data.f.size());
         int lfi = 0;
+        auto advance_to = [&](int range_end) {
+            while (lfi < face_count && data.f[lfi].index < range_end) ++lfi;
+            return lfi;
+        };
+
         if (data.g.empty() || data.f.front().index < data.g.front().index)
         {
             int range_end = data.g.size() == 0 ? data.f.back().index + 1 : data.g.front().index;
-            lfi = get_group_range_end(0, range_end, data);
-            groups.emplace_back(0, lfi, "default");
+            groups.emplace_back(0, advance_to(range_end), "default");
+            groups.back().end_line = data.g.empty() ? line_count : data.g.front().index;
         }
 
         for (size_t g = 0; g < data.g.size(); ++g)
         {
             int range_end = (g < data.g.size() - 1) ? data.g[g + 1].index : data.f.back().index + 1;
-            int temp = get_group_range_end(lfi, range_end, data);
-            groups.emplace_back(lfi, temp, data.g[g].value);
-            lfi = temp;
+            int start = lfi;
+            groups.emplace_back(start, advance_to(range_end), data.g[g].value);
+            groups.back().first_line = data.g[g].index;
+            groups.back().end_line = (g < data.g.size() - 1) ? data.g[g + 1].index : line_count;
         }
     }
 
-    static void assign_materials_to_groups(
-        // in
-        const ParseDataRead &data, const acul::vector<GroupRange> &groups,
-        const acul::hl_hashmap<acul::string, int> &mat_map,
-        // out
-        acul::vector<acul::shared_ptr<umbf::File>> &materials, acul::vector<acul::vector<u32>> &ranges,
-        acul::string &error)
+    constexpr u64 fnv_offset_basis = 0xcbf29ce484222325ull;
+    constexpr u64 fnv_prime = 0x100000001b3ull;
+
+    inline u64 hash_line(acul::string_view line)
     {
-        if (data.use_mtl.size() == 0) return;
-        int um_id = 0;
-        ranges.resize(groups.size());
-        for (size_t g = 0; g < groups.size(); ++g)
-        {
-            auto &group = groups[g];
-            const auto first = data.f[group.start_index].index;
-            const auto last = data.f[group.range_end - 1].index;
-            if (data.use_mtl[um_id].index < first)
+        u64 hash = fnv_offset_basis;
+        for (char c : line) hash = (hash ^ static_cast<u8>(c)) * fnv_prime;
+        return hash;
+    }
+
+    inline u64 hash_lines(const acul::vector<u64> &line_hashes, int begin, int end)
+    {
+        u64 hash = fnv_offset_basis;
+        for (int i = begin; i < end; ++i) hash = (hash ^ line_hashes[i]) * fnv_prime;
+        return hash;
+    }
+
+    // Count of the elements declared before the line
+    template <typename T>
+    inline u32 count_before(const acul::vector<Line<T>> &elements, int line)
+    {
+        auto it = std::lower_bound(elements.begin(), elements.end(), line,
+                                   [](const Line<T> &element, int value) { return element.index < value; });
+        return static_cast<u32>(it - elements.begin());
+    }
+
+    /**
+     * Computes the manifest signature of a group: the hash of its source lines, the element counts
+     * declared before it and whether its faces only reference its own elements or the preamble
+     * (the lines before the first group). Only such groups can be reused on reload.
+     **/
+    void sign_group(const ParseDataRead &data, const acul::vector<u64> &line_hashes, int preamble_end,
+                    const GroupRange &group, ImportManifest::Group &signature)
+    {
+        signature.name = group.name;
+        signature.hash = hash_lines(line_hashes, group.first_line, group.end_line);
+        signature.base[0] = count_before(data.v, group.first_line);
+        signature.base[1] = count_before(data.vt, group.first_line);
+        signature.base[2] = count_before(data.vn, group.first_line);
+        const u32 end[3] = {count_before(data.v, group.end_line), count_before(data.vt, group.end_line),
+                            count_before(data.vn, group.end_line)};
+        const u32 preamble[3] = {count_before(data.v, preamble_end), count_before(data.vt, preamble_end),
+                                 count_before(data.vn, preamble_end)};
+        signature.reusable = true;
+        signature.uses_preamble = false;
+        for (int f = group.start_index; f < group.range_end && signature.reusable; ++f)
+            for (const auto &vtn : *data.f[f].value)
             {
-                while (um_id < (int)data.use_mtl.size() && data.use_mtl[um_id].index <= first) ++um_id;
-                for (--um_id; um_id < (int)data.use_mtl.size() && data.use_mtl[um_id].index <= last; ++um_id)
+                const int ids[3] = {vtn.x, vtn.y, vtn.z};
+                for (int e = 0; e < 3; ++e)
                 {
-                    ranges[g].emplace_back(um_id);
-                    auto it = mat_map.find(data.use_mtl[um_id].value);
-                    if (it == mat_map.end())
-                        error = acul::format("Can't find material in library: %s", data.use_mtl[um_id].value.c_str());
-                    else
-                    {
-                        auto meta = materials[it->second]->blocks;
-                        auto m_it = std::find_if(meta.begin(), meta.end(), [](auto &block) {
-                            return block->signature() == umbf::sign_block::material_info;
-                        });
-                        if (m_it == meta.end())
-                        {
-                            error = "Can't find material info block";
-                            continue;
-                        }
-                        auto assignments = acul::static_pointer_cast<umbf::MaterialInfo>(*m_it)->assignments;
-                        if (std::find(assignments.begin(), assignments.end(), g) == assignments.end())
-                            assignments.push_back(g);
-                    }
+                    const int id = ids[e];
+                    if (id == 0) continue;
+                    if (id > (int)signature.base[e] && id <= (int)end[e]) continue;
+                    if (id <= (int)preamble[e]) signature.uses_preamble = true;
+                    else signature.reusable = false;
                 }
             }
-        }
     }
 
-    void assign_ranges_to_objects(ParseDataRead &data, const acul::vector<acul::vector<u32>> &ranges,
-                                  acul::hl_hashmap<acul::string, int> &mat_map, const acul::vector<GroupRange> &groups,
-                                  acul::vector<umbf::Object> &objects)
+    // Interns every 'usemtl' line into the index of its material in the library, -1 if unknown
+    static void intern_use_mtl(const ParseDataRead &data, const acul::hl_hashmap<acul::string, int> &mat_map,
+                               acul::vector<int> &mtl_ids, acul::string &error)
     {
-        for (size_t gr = 0; gr < ranges.size(); ++gr)
+        mtl_ids.resize(data.use_mtl.size());
+        for (size_t i = 0; i < data.use_mtl.size(); ++i)
         {
-            auto &group_range = ranges[gr];
-            if (group_range.size() > 1)
+            auto it = mat_map.find(data.use_mtl[i].value);
+            if (it == mat_map.end())
             {
-                auto &group = groups[gr];
-                int f = group.start_index;
-                for (size_t i = 0; i < group_range.size(); ++i)
-                {
-                    int m_next = (i == group_range.size() - 1) ? data.f[group.range_end - 1].index + 1
-                                                               : data.use_mtl[group_range[i + 1]].index;
+                error = acul::format("Can't find material in library: %s", data.use_mtl[i].value.c_str());
+                mtl_ids[i] = -1;
+            }
+            else mtl_ids[i] = it->second;
+        }
+    }
+
+    /**
+     * Sweeps the faces of every group together with the 'usemtl' lines and emits one MaterialRange
+     * per material used by the group. A group covered by a single material receives a range without
+     * faces, which denotes the default material of the object.
+     **/
+    static void assign_material_ranges(
+        // in
+        const ParseDataRead &data, const acul::vector<GroupRange> &groups, const acul::vector<int> &mtl_ids,
+        const acul::vector<acul::shared_ptr<umbf::MaterialInfo>> &infos,
+        // out
+        acul::vector<umbf::Object> &objects)
+    {
+        if (data.use_mtl.empty()) return;
+        acul::vector<acul::vector<int>> group_materials(groups.size());
+        oneapi::tbb::parallel_for(size_t(0), groups.size(), [&](size_t g) {
+            auto &group = groups[g];
+            if (group.start_index == group.range_end) return;
+
+            // The material active at the first face is the last 'usemtl' placed before it
+            const int first_line = data.f[group.start_index].index;
+            auto um_it = std::upper_bound(data.use_mtl.begin(), data.use_mtl.end(), first_line,
+                                          [](int line, const Line<acul::string> &um) { return line < um.index; });
+            size_t um = um_it - data.use_mtl.begin();
+            int current = um == 0 ? -1 : mtl_ids[um - 1];
 
-                    auto it = mat_map.find(data.use_mtl[group_range[i]].value);
-                    if (it == mat_map.end())
-                        for (; f < (int)data.f.size() && data.f[f].index < m_next; ++f);
-                    else
+            acul::hl_hashmap<int, size_t> slots;
+            acul::vector<acul::shared_ptr<umbf::MaterialRange>> ranges;
+            umbf::MaterialRange *range = nullptr;
+            int range_mtl = -1;
+            for (int f = group.start_index; f < group.range_end; ++f)
+            {
+                while (um < data.use_mtl.size() && data.use_mtl[um].index < data.f[f].index) current = mtl_ids[um++];
+                if (current == -1) continue;
+                if (current != range_mtl)
+                {
+                    auto [it, inserted] = slots.emplace(current, ranges.size());
+                    if (inserted)
                     {
-                        auto meta = acul::make_shared<umbf::MaterialRange>();
-                        meta->mat_id = it->second;
-                        for (; f < (int)data.f.size() && data.f[f].index < m_next; ++f)
-                            meta->faces.push_back(f - group.start_index);
-                        objects[gr].meta.push_back(meta);
+                        ranges.push_back(acul::make_shared<umbf::MaterialRange>());
+                        ranges.back()->mat_id = infos[current]->id;
+                        group_materials[g].push_back(current);
                     }
+                    range = ranges[it->second].get();
+                    range_mtl = current;
                 }
+                range->faces.push_back(f - group.start_index);
             }
-        }
+
+            if (ranges.size() == 1 && ranges.front()->faces.size() == (size_t)(group.range_end - group.start_index))
+                ranges.front()->faces.clear();
+            auto &meta = objects[g].meta;
+            meta.insert(meta.end(), ranges.begin(), ranges.end());
+        });
+
+        for (size_t g = 0; g < groups.size(); ++g)
+            for (int mtl : group_materials[g]) infos[mtl]->assignments.push_back(objects[g].id);
+    }
+
+    template <typename Container>
+    void release_faces(Container &faces)
+    {
+        for (auto &face : faces) acul::release(face.value);
+        faces.clear();
     }
 
     struct ImportCtx
@@ -291,43 +366,159 @@ namespace aecl::scene::obj
         ParseDataRead data;
         acul::string mtllib;
         acul::vector<GroupRange> groups;
+        int line_count = 0;
+        acul::vector<u64> line_hashes; // Filled only for incremental imports
+        ImportManifest manifest;       // Signatures of this import, committed once the geometry is built
+
+        ~ImportCtx() { release_faces(data.f); }
     };
 
+    // Size of the source blocks split and parsed at once
+    constexpr size_t read_block_size = 16 << 20;
+
+    // Progress shares of the import stages
+    constexpr f32 progress_parse_end = 0.5f;
+    constexpr f32 progress_geometry_end = 0.95f;
+
     Importer::~Importer() { acul::release(_ctx); }
 
+    acul::op_result Importer::cancel()
+    {
+        acul::release(_ctx);
+        _ctx = nullptr;
+        return ILoader::cancel();
+    }
+
     acul::op_result Importer::read_source()
     {
+        acul::release(_ctx);
         _ctx = acul::alloc<ImportCtx>();
         ParseDataWrite parsed;
-        auto result = acul::fs::read_by_block(_path, [&parsed](char *data, size_t size) {
+        StageTimer read_timer(_stats, Stage::read);
+        const u64 file_size = _progress ? io::get_file_size(_path) : 0;
+        u64 bytes_done = 0;
+        int line_base = 0;
+        const bool read = io::read_line_blocks(_path, read_block_size, [&, this](char *data, size_t size) {
             acul::string_view_pool<char> pool;
-            pool.reserve(size / 40);
-            acul::fill_line_buffer(data, size, pool);
+            {
+                StageTimer timer(_stats, Stage::line_split);
+                pool.reserve(size / 40);
+                acul::fill_line_buffer(data, size, pool);
+            }
+            StageTimer timer(_stats, Stage::parse);
+            auto &line_hashes = _ctx->line_hashes;
+            if (_manifest) line_hashes.resize(line_base + pool.size());
             oneapi::tbb::parallel_for(oneapi::tbb::blocked_range<size_t>(0, pool.size(), 512),
                                       [&](const oneapi::tbb::blocked_range<size_t> &range) {
+                                          if (is_cancelled(_progress)) return;
                                           for (size_t i = range.begin(); i != range.end(); ++i)
-                                              parse_line(parsed, pool[i], i);
+                                          {
+                                              parse_line(parsed, pool[i], line_base + i);
+                                              if (_manifest) line_hashes[line_base + i] = hash_line(pool[i]);
+                                          }
                                       });
+            line_base += pool.size();
+            bytes_done += size;
+            if (file_size > 0) report_progress(_progress, progress_parse_end * bytes_done / file_size);
+            if (_stats)
+            {
+                _stats->bytes_read += size;
+                _stats->lines += pool.size();
+            }
+            return !is_cancelled(_progress); // Stop before the next block
         });
-        if (!result.success()) return result;
-        copy_write_data(parsed, _ctx->data);
+        if (is_cancelled(_progress))
+        {
+            release_faces(parsed.f);
+            return cancel();
+        }
+        if (!read)
+        {
+            release_faces(parsed.f);
+            _error = "Failed to read source file";
+            return acul::op_result(ACUL_OP_READ_ERROR, AECL_OP_DOMAIN, AECL_OP_CODE_MESH_ERROR);
+        }
+        {
+            StageTimer timer(_stats, Stage::sort_merge);
+            copy_write_data(parsed, _ctx->data);
+        }
         _ctx->mtllib = parsed.mtllib;
-        return result;
+        _ctx->line_count = line_base;
+        if (_stats)
+        {
+            _stats->faces += _ctx->data.f.size();
+            _stats->vertices += _ctx->data.v.size();
+        }
+        return acul::make_op_success();
+    }
+
+    void Importer::match_manifest()
+    {
+        auto &data = _ctx->data;
+        auto &groups = _ctx->groups;
+        const int preamble_end = data.g.empty() ? _ctx->line_count : data.g.front().index;
+        ImportManifest &current = _ctx->manifest;
+        current.preamble_hash = hash_lines(_ctx->line_hashes, 0, preamble_end);
+        current.use_normals = !data.vn.empty();
+        current.groups.resize(groups.size());
+        oneapi::tbb::parallel_for(size_t(0), groups.size(), [&](size_t g) {
+            sign_group(data, _ctx->line_hashes, preamble_end, groups[g], current.groups[g]);
+        });
+
+        // The vn lines of any group switch every group to another indexing path
+        if (current.use_normals != _manifest->use_normals) return;
+
+        // Groups are matched by name and occurrence, as names may repeat
+        acul::hl_hashmap<acul::string, acul::vector<size_t>> previous;
+        for (size_t g = 0; g < _manifest->groups.size(); ++g) previous[_manifest->groups[g].name].push_back(g);
+        acul::hl_hashmap<acul::string, size_t> occurrences;
+        for (size_t g = 0; g < groups.size(); ++g)
+        {
+            auto &signature = current.groups[g];
+            size_t occurrence = occurrences[signature.name]++;
+            auto it = previous.find(signature.name);
+            if (it == previous.end() || occurrence >= it->second.size()) continue;
+            auto &old = _manifest->groups[it->second[occurrence]];
+            if (!signature.reusable || !old.mesh || old.hash != signature.hash ||
+                !std::equal(old.base, old.base + 3, signature.base) || old.uses_preamble != signature.uses_preamble)
+                continue;
+            if (signature.uses_preamble && current.preamble_hash != _manifest->preamble_hash) continue;
+            groups[g].mesh = signature.mesh = old.mesh;
+            groups[g].object_id = signature.object_id = old.object_id;
+            ++current.reused;
+        }
     }
 
     void Importer::build_geometry()
     {
-        create_group_ranges(_ctx->data, _ctx->groups);
+        create_group_ranges(_ctx->data, _ctx->line_count, _ctx->groups);
+        if (_manifest) match_manifest();
+        const size_t total_faces = _ctx->data.f.size();
         // Index Groups
-        for (auto &group : _ctx->groups)
+        for (size_t g = 0; g < _ctx->groups.size(); ++g)
         {
+            if (is_cancelled(_progress)) return;
+            auto &group = _ctx->groups[g];
+            if (group.mesh)
+            {
+                // Unchanged since the previous import
+                _objects.emplace_back(group.object_id, group.name);
+                _objects.back().meta.push_back(group.mesh);
+                continue;
+            }
             const size_t face_count = group.range_end - group.start_index;
             group.mesh = acul::make_shared<Mesh>();
             auto &m = group.mesh->model;
-            index_mesh(face_count, _ctx->data, group);
+            {
+                StageTimer timer(_stats, Stage::index);
+                index_mesh(face_count, _ctx->data, group, _progress);
+            }
+            if (_stats) _stats->unique_vertices += m.vertices.size();
+            StageTimer timer(_stats, Stage::triangulate);
             acul::vector<acul::vector<u32>> ires(face_count);
             oneapi::tbb::parallel_for(oneapi::tbb::blocked_range<size_t>(0, face_count),
                                       [&](const oneapi::tbb::blocked_range<size_t> &range) {
+                                          if (is_cancelled(_progress)) return;
                                           for (size_t i = range.begin(); i < range.end(); ++i)
                                           {
                                               ires[i] = utils::triangulate(m.faces[i], m.vertices);
@@ -343,13 +534,24 @@ namespace aecl::scene::obj
             }
             _objects.emplace_back(acul::id_gen()(), group.name);
             _objects.back().meta.push_back(group.mesh);
+            if (_manifest)
+            {
+                _ctx->manifest.groups[g].object_id = _objects.back().id;
+                _ctx->manifest.groups[g].mesh = group.mesh;
+            }
+            report_progress(_progress, progress_parse_end + (progress_geometry_end - progress_parse_end) *
+                                                                group.range_end / total_faces);
         }
+
+        // A cancelled import keeps the previous manifest, which still holds the meshes of every group
+        if (_manifest && !is_cancelled(_progress)) *_manifest = std::move(_ctx->manifest);
     }
 
     acul::op_result Importer::load_materials()
     {
         if (_ctx->mtllib.empty()) return acul::make_op_success();
         _error.clear();
+        StageTimer timer(_stats, Stage::material_resolve);
         acul::vector<Material> mtl_materials;
         acul::path mtl_path = acul::path(_path).parent_path() / _ctx->mtllib;
         if (!parse_mtl(mtl_path, mtl_materials))
@@ -358,10 +560,11 @@ namespace aecl::scene::obj
             return acul::op_result(ACUL_OP_READ_ERROR, AECL_OP_DOMAIN, AECL_OP_CODE_MATERIAL_ERROR);
         }
         acul::hl_hashmap<acul::string, int> mat_map;
-        acul::vector<acul::vector<u32>> face_mat_ranges;
-        convert_to_materials(_path, mtl_materials, mat_map, _materials, _textures);
-        assign_materials_to_groups(_ctx->data, _ctx->groups, mat_map, _materials, face_mat_ranges, _error);
-        assign_ranges_to_objects(_ctx->data, face_mat_ranges, mat_map, _ctx->groups, _objects);
+        acul::vector<acul::shared_ptr<umbf::MaterialInfo>> infos;
+        acul::vector<int> mtl_ids;
+        convert_to_materials(_path, mtl_materials, mat_map, _materials, infos, _textures);
+        intern_use_mtl(_ctx->data, mat_map, mtl_ids, _error);
+        assign_material_ranges(_ctx->data, _ctx->groups, mtl_ids, infos, _objects);
         return acul::make_op_success();
     }
 } // namespace aecl::scene::obj
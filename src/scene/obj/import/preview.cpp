@@ -0,0 +1,126 @@
+#include <acul/hash/hl_hashmap.hpp>
+#include <aecl/scene/obj/import.hpp>
+#include <aecl/status.hpp>
+#include <amal/integration/acul/string.hpp>
+#include <oneapi/tbb/parallel_for.h>
+#include "../../../io/mapped_file.hpp"
+
+namespace aecl::scene::obj
+{
+    struct PreviewChunk
+    {
+        acul::vector<acul::pair<size_t, acul::string>> groups; // Index of the first point of a group, group name
+        acul::vector<amal::vec3> points;
+    };
+
+    // Average length of a 'v' line, used to estimate the vertex count from the file size
+    constexpr size_t preview_vertex_line_size = 32;
+    constexpr size_t preview_chunk_size = 1024 * 1024;
+
+    // The mapping is not null-terminated, so the position is parsed from a terminated copy of the line
+    static bool parse_position(const char *token, const char *line_end, amal::vec3 &v)
+    {
+        char buffer[128];
+        const size_t size = std::min<size_t>(line_end - token, sizeof(buffer) - 1);
+        memcpy(buffer, token, size);
+        buffer[size] = '\0';
+        const char *it = buffer;
+        return acul::stov3(it, v);
+    }
+
+    static bool is_blank(char c) { return c == ' ' || c == '\t'; }
+
+    static void sample_chunk(const char *begin, const char *end, const char *file_end, size_t stride,
+                             PreviewChunk &chunk)
+    {
+        size_t vertex_index = 0;
+        // Each line belongs to the chunk it starts in
+        for (const char *line = begin; line < end;)
+        {
+            const char *line_end = static_cast<const char *>(memchr(line, '\n', file_end - line));
+            if (!line_end) line_end = file_end;
+            if (line_end - line > 2)
+            {
+                if (line[0] == 'v' && is_blank(line[1]))
+                {
+                    amal::vec3 v;
+                    if (vertex_index++ % stride == 0 && parse_position(line + 2, line_end, v))
+                        chunk.points.push_back(v);
+                }
+                else if ((line[0] == 'g' || line[0] == 'o') && is_blank(line[1]))
+                {
+                    const char *token = line + 1;
+                    while (token < line_end && is_blank(*token)) ++token;
+                    if (token < line_end)
+                        chunk.groups.emplace_back(chunk.points.size(),
+                                                  acul::trim_end(token, static_cast<size_t>(line_end - token)));
+                }
+            }
+            line = line_end + 1;
+        }
+    }
+
+    acul::op_result Importer::load_preview(Preview &preview, size_t max_points)
+    {
+        io::MappedFile file;
+        if (!file.open(_path))
+        {
+            _error = "Failed to map source file";
+            return acul::op_result(ACUL_OP_READ_ERROR, AECL_OP_DOMAIN, AECL_OP_CODE_MESH_ERROR);
+        }
+        const char *data = file.data();
+        const size_t size = file.size();
+        const size_t stride = std::max<size_t>(1, size / preview_vertex_line_size / std::max<size_t>(1, max_points));
+        const size_t chunk_count = (size + preview_chunk_size - 1) / preview_chunk_size;
+
+        acul::vector<PreviewChunk> chunks(chunk_count);
+        oneapi::tbb::parallel_for(size_t(0), chunk_count, [&](size_t c) {
+            const char *file_end = data + size;
+            const char *begin = data + c * preview_chunk_size;
+            const char *end = std::min(begin + preview_chunk_size, file_end);
+            // Skip the tail of a line started in the previous chunk
+            if (c > 0 && begin[-1] != '\n')
+            {
+                begin = static_cast<const char *>(memchr(begin, '\n', file_end - begin));
+                if (!begin || ++begin >= end) return;
+            }
+            sample_chunk(begin, end, file_end, stride, chunks[c]);
+        });
+
+        // Merge the chunks in file order, resolving groups which continue from a previous chunk
+        preview.groups.clear();
+        preview.points.clear();
+        acul::hl_hashmap<acul::string, size_t> group_map;
+        int current = -1;
+        auto switch_group = [&](const acul::string &name) {
+            auto [it, inserted] = group_map.emplace(name, preview.groups.size());
+            if (inserted) preview.groups.push_back({name});
+            current = static_cast<int>(it->second);
+        };
+        for (auto &chunk : chunks)
+        {
+            size_t next_group = 0;
+            for (size_t p = 0; p <= chunk.points.size(); ++p)
+            {
+                while (next_group < chunk.groups.size() && chunk.groups[next_group].first == p)
+                    switch_group(chunk.groups[next_group++].second);
+                if (p == chunk.points.size()) break;
+                if (current == -1) switch_group("default");
+                auto &group = preview.groups[current];
+                const auto &point = chunk.points[p];
+                group.min = amal::min(group.min, point);
+                group.max = amal::max(group.max, point);
+                preview.points.push_back(point);
+            }
+        }
+
+        // The stride is based on an estimate, thin out the overshoot
+        if (preview.points.size() > max_points && max_points > 0)
+        {
+            const f64 step = static_cast<f64>(preview.points.size()) / max_points;
+            for (size_t i = 0; i < max_points; ++i) preview.points[i] = preview.points[static_cast<size_t>(i * step)];
+            preview.points.resize(max_points);
+        }
+        return acul::make_op_success();
+    }
+} // namespace aecl::scene::obj
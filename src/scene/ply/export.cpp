@@ -0,0 +1,291 @@
+#include <aecl/scene/ply/export.hpp>
+#include <aecl/status.hpp>
+#include <cerrno>
+#include <cstring>
+#include <inttypes.h>
+#include <limits>
+#include <oneapi/tbb/parallel_for.h>
+#include "../../io/file.hpp"
+#include "../../io/text_buffer.hpp"
+#include "../transform.hpp"
+#include "ply.hpp"
+
+namespace aecl::scene::ply
+{
+    // Records formatted by one task
+    constexpr size_t block_size = 1 << 14;
+
+    // Per-object export state. The records are formatted into chunks, one per block of vertices or faces.
+    struct Exporter::MeshSegment
+    {
+        acul::shared_ptr<umbf::mesh::Mesh> mesh;
+        u32 face_count = 0;
+        u32 max_face_size = 0;
+        u32 vertex_offset = 0; // Index of the first vertex of the object in the vertex element
+        acul::vector<acul::vector<char>> vertex_chunks;
+        acul::vector<acul::vector<char>> face_chunks;
+        u32 op_code = 0;
+        acul::string error;
+    };
+
+    void Exporter::prepare_mesh(const umbf::Object &object, MeshSegment &segment)
+    {
+        for (auto &block : object.meta)
+            if (block->signature() == umbf::sign_block::mesh)
+            {
+                segment.mesh = acul::static_pointer_cast<umbf::mesh::Mesh>(block);
+                break;
+            }
+        if (!segment.mesh)
+        {
+            segment.error = acul::format("Mesh block not found in object: 0x%" PRIx64, object.id);
+            segment.op_code = AECL_OP_CODE_MESH_ERROR;
+            return;
+        }
+        auto &model = segment.mesh->model;
+        if (mesh_flags & MeshExportFlagBits::export_triangulated)
+        {
+            segment.face_count = model.indices.size() / 3;
+            segment.max_face_size = segment.face_count ? 3 : 0;
+        }
+        else
+        {
+            segment.face_count = model.faces.size();
+            for (auto &face : model.faces)
+                segment.max_face_size = std::max<u32>(segment.max_face_size, face.vertices.size());
+        }
+    }
+
+    // Formats the records of the object blocks
+    template <Encoding E>
+    struct RecordWriter
+    {
+        static constexpr bool swap = E == Encoding::swapped;
+        static constexpr bool ascii = E == Encoding::ascii;
+
+        AxisTransform transform;
+        bool uv;
+        bool normals;
+        bool wide_count; // List lengths are stored as uint instead of uchar
+        int precision;
+
+        char *write_value(char *dst, f32 value, bool last) const
+        {
+            if constexpr (ascii)
+            {
+                dst = io::write_float(dst, value, precision);
+                *dst++ = last ? '\n' : ' ';
+                return dst;
+            }
+            else return store<f32, swap>(dst, value);
+        }
+
+        char *write_index(char *dst, u32 value, bool last) const
+        {
+            if constexpr (ascii)
+            {
+                dst = io::write_uint(dst, value);
+                *dst++ = last ? '\n' : ' ';
+                return dst;
+            }
+            else return store<u32, swap>(dst, value);
+        }
+
+        char *write_count(char *dst, u32 count) const
+        {
+            if constexpr (ascii) return write_index(dst, count, false);
+            else return wide_count ? store<u32, swap>(dst, count) : store<u8, swap>(dst, static_cast<u8>(count));
+        }
+
+        void write_vertices(const umbf::mesh::Model &model, size_t begin, size_t end, io::TextBuffer &out) const
+        {
+            constexpr size_t value_size = ascii ? io::TextBuffer::max_number_size + 1 : sizeof(f32);
+            char *const start = out.ensure((end - begin) * value_size * 8);
+            char *dst = start;
+            for (size_t i = begin; i < end; ++i)
+            {
+                auto &vertex = model.vertices[i];
+                const amal::vec3 pos = transform(vertex.pos);
+                dst = write_value(dst, pos.x, false);
+                dst = write_value(dst, pos.y, false);
+                dst = write_value(dst, pos.z, !normals && !uv);
+                if (normals)
+                {
+                    const amal::vec3 normal = transform(vertex.normal);
+                    dst = write_value(dst, normal.x, false);
+                    dst = write_value(dst, normal.y, false);
+                    dst = write_value(dst, normal.z, !uv);
+                }
+                if (uv)
+                {
+                    dst = write_value(dst, vertex.uv.x, false);
+                    dst = write_value(dst, vertex.uv.y, true);
+                }
+            }
+            out.commit(dst - start);
+        }
+
+        template <typename Get>
+        char *write_face(char *dst, u32 count, Get &&get) const
+        {
+            dst = write_count(dst, count);
+            for (u32 k = 0; k < count; ++k)
+                dst = write_index(dst, get(transform.flip_winding ? count - 1 - k : k), k + 1 == count);
+            return dst;
+        }
+
+        void write_faces(const umbf::mesh::Model &model, bool triangulated, u32 offset, size_t begin, size_t end,
+                         io::TextBuffer &out) const
+        {
+            constexpr size_t index_size = ascii ? 11 : sizeof(u32);
+            for (size_t f = begin; f < end; ++f)
+            {
+                if (triangulated)
+                {
+                    const u32 *triangle = model.indices.data() + f * 3;
+                    char *start = out.ensure(index_size * 4);
+                    out.commit(write_face(start, 3, [&](u32 k) { return offset + triangle[k]; }) - start);
+                }
+                else
+                {
+                    auto &refs = model.faces[f].vertices;
+                    char *start = out.ensure(index_size * (refs.size() + 1));
+                    out.commit(write_face(start, refs.size(), [&](u32 k) { return offset + refs[k].vertex; }) -
+                               start);
+                }
+            }
+        }
+    };
+
+    static void write_header(io::TextBuffer &header, Format format, size_t vertex_count, size_t face_count,
+                             bool normals, bool uv, bool wide_count)
+    {
+        static const char *format_names[] = {"ascii", "binary_little_endian", "binary_big_endian"};
+        header.append("ply\nformat ");
+        header.append(format_names[static_cast<int>(format)]);
+        header.append(" 1.0\ncomment App3D ECL PLY Exporter\nelement vertex ");
+        header.append(acul::format("%zu", vertex_count));
+        header.append("\nproperty float x\nproperty float y\nproperty float z\n");
+        if (normals) header.append("property float nx\nproperty float ny\nproperty float nz\n");
+        if (uv) header.append("property float s\nproperty float t\n");
+        if (face_count)
+        {
+            header.append(acul::format("element face %zu\n", face_count));
+            header.append(wide_count ? "property list uint uint vertex_indices\n"
+                                     : "property list uchar uint vertex_indices\n");
+        }
+        header.append("end_header\n");
+    }
+
+    template <Encoding E, typename Segment>
+    static void format_segments(const RecordWriter<E> &writer, acul::vector<Segment *> &segments, bool triangulated)
+    {
+        oneapi::tbb::parallel_for(size_t(0), segments.size(), [&](size_t s) {
+            auto &segment = *segments[s];
+            auto &model = segment.mesh->model;
+            const size_t vertex_blocks = (model.vertices.size() + block_size - 1) / block_size;
+            const size_t face_blocks = (segment.face_count + block_size - 1) / block_size;
+            segment.vertex_chunks.resize(vertex_blocks);
+            segment.face_chunks.resize(face_blocks);
+            oneapi::tbb::parallel_for(size_t(0), vertex_blocks + face_blocks, [&](size_t b) {
+                io::TextBuffer out(writer.precision);
+                if (b < vertex_blocks)
+                {
+                    const size_t begin = b * block_size;
+                    writer.write_vertices(model, begin, std::min(model.vertices.size(), begin + block_size), out);
+                    segment.vertex_chunks[b] = out.take();
+                }
+                else
+                {
+                    const size_t begin = (b - vertex_blocks) * block_size;
+                    const size_t end = std::min<size_t>(segment.face_count, begin + block_size);
+                    writer.write_faces(model, triangulated, segment.vertex_offset, begin, end, out);
+                    segment.face_chunks[b - vertex_blocks] = out.take();
+                }
+            });
+        });
+    }
+
+    acul::op_result Exporter::save()
+    {
+        io::FileSink file;
+        if (!file.open(path))
+        {
+            _error = acul::format("Failed to open ply file. Error: %s", std::strerror(errno));
+            return acul::op_result(ACUL_OP_WRITE_ERROR, AECL_OP_DOMAIN, 0);
+        }
+        auto result = write_scene(file);
+        if (!file.close() && result.success())
+        {
+            _error = "Failed to write ply file";
+            return acul::op_result(ACUL_OP_WRITE_ERROR, AECL_OP_DOMAIN, result.code);
+        }
+        return result;
+    }
+
+    acul::op_result Exporter::save(ISink &sink) { return write_scene(sink); }
+
+    acul::op_result Exporter::write_scene(ISink &sink)
+    {
+        _error.clear();
+        acul::vector<MeshSegment> segments(objects.size());
+        oneapi::tbb::parallel_for(size_t(0), objects.size(), [&](size_t i) { prepare_mesh(objects[i], segments[i]); });
+
+        u32 op_code = 0, max_face_size = 0;
+        size_t vertex_count = 0, face_count = 0;
+        acul::vector<MeshSegment *> meshes;
+        for (auto &segment : segments)
+        {
+            op_code |= segment.op_code;
+            if (!segment.error.empty()) _error = segment.error;
+            if (!segment.mesh || segment.mesh->model.vertices.empty()) continue;
+            segment.vertex_offset = vertex_count;
+            vertex_count += segment.mesh->model.vertices.size();
+            face_count += segment.face_count;
+            max_face_size = std::max(max_face_size, segment.max_face_size);
+            meshes.push_back(&segment);
+        }
+        if (vertex_count > std::numeric_limits<u32>::max())
+        {
+            _error = "Vertex count exceeds the PLY index range";
+            return acul::op_result(ACUL_OP_WRITE_ERROR, AECL_OP_DOMAIN, op_code);
+        }
+
+        const bool triangulated = mesh_flags & MeshExportFlagBits::export_triangulated;
+        const bool normals = mesh_flags & MeshExportFlagBits::export_normals;
+        const bool uv = mesh_flags & MeshExportFlagBits::export_uv;
+        const bool wide_count = max_face_size > std::numeric_limits<u8>::max();
+        const AxisTransform transform(mesh_flags);
+        switch (get_encoding(format))
+        {
+            case Encoding::ascii:
+                format_segments<Encoding::ascii>({transform, uv, normals, wide_count, float_precision}, meshes,
+                                                 triangulated);
+                break;
+            case Encoding::native:
+                format_segments<Encoding::native>({transform, uv, normals, wide_count, float_precision}, meshes,
+                                                  triangulated);
+                break;
+            case Encoding::swapped:
+                format_segments<Encoding::swapped>({transform, uv, normals, wide_count, float_precision}, meshes,
+                                                   triangulated);
+                break;
+        }
+
+        io::TextBuffer header;
+        write_header(header, format, vertex_count, face_count, normals, uv, wide_count);
+        bool success = sink.write(header.data(), header.size());
+        for (auto *segment : meshes)
+            for (auto &chunk : segment->vertex_chunks)
+                success = success && sink.write(chunk.data(), chunk.size());
+        for (auto *segment : meshes)
+            for (auto &chunk : segment->face_chunks)
+                success = success && sink.write(chunk.data(), chunk.size());
+        if (!success)
+        {
+            _error = "Failed to write ply data";
+            return acul::op_result(ACUL_OP_WRITE_ERROR, AECL_OP_DOMAIN, op_code);
+        }
+        return acul::op_result(ACUL_OP_SUCCESS, AECL_OP_DOMAIN, op_code);
+    }
+} // namespace aecl::scene::ply
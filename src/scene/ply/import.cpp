@@ -0,0 +1,657 @@
+#include <acul/io/fs/file.hpp>
+#include <aecl/scene/ply/import.hpp>
+#include <aecl/scene/utils.hpp>
+#include <aecl/status.hpp>
+#include <algorithm>
+#include <charconv>
+#include <oneapi/tbb/parallel_for.h>
+#include "../../io/mapped_file.hpp"
+#include "ply.hpp"
+
+namespace aecl::scene::ply
+{
+    using namespace umbf::mesh;
+
+    struct Property
+    {
+        acul::string name;
+        Type type = Type::none;
+        Type count_type = Type::none; // Type of the list length, none for scalar properties
+    };
+
+    struct Element
+    {
+        acul::string name;
+        u64 count = 0;
+        acul::vector<Property> properties;
+        u32 stride = 0; // Size of a binary record without lists, 0 otherwise
+    };
+
+    struct ImportCtx
+    {
+        io::MappedFile file;
+        Encoding encoding = Encoding::ascii;
+        acul::vector<Element> elements;
+        size_t body = 0; // Offset of the element data
+    };
+
+    // Records decoded by one task
+    constexpr size_t block_size = 1 << 14;
+
+    // Progress shares of the import stages
+    constexpr f32 progress_read_end = 0.05f;
+    constexpr f32 progress_parse_end = 0.8f;
+
+    template <typename T, bool swap>
+    static T read_scalar(const char *src, Type type)
+    {
+        switch (type)
+        {
+            case Type::i8:
+                return static_cast<T>(load<i8, swap>(src));
+            case Type::u8:
+                return static_cast<T>(load<u8, swap>(src));
+            case Type::i16:
+                return static_cast<T>(load<i16, swap>(src));
+            case Type::u16:
+                return static_cast<T>(load<u16, swap>(src));
+            case Type::i32:
+                return static_cast<T>(load<i32, swap>(src));
+            case Type::u32:
+                return static_cast<T>(load<u32, swap>(src));
+            case Type::f32:
+                return static_cast<T>(load<f32, swap>(src));
+            case Type::f64:
+                return static_cast<T>(load<f64, swap>(src));
+            default:
+                return T();
+        }
+    }
+
+    // Sequential reader over the values of the element records
+    template <Encoding E>
+    class Reader
+    {
+    public:
+        Reader(const char *it, const char *end) : _it(it), _end(end) {}
+
+        const char *position() const { return _it; }
+
+        // ASCII records are lines, blank lines between them are skipped
+        void begin_record()
+        {
+            if constexpr (E == Encoding::ascii)
+                while (_it < _end && is_space(*_it)) ++_it;
+        }
+
+        void end_record()
+        {
+            if constexpr (E == Encoding::ascii)
+            {
+                while (_it < _end && *_it != '\n') ++_it;
+                if (_it < _end) ++_it;
+            }
+        }
+
+        template <typename T>
+        bool read(Type type, T &value)
+        {
+            if constexpr (E == Encoding::ascii)
+            {
+                while (_it < _end && (*_it == ' ' || *_it == '\t' || *_it == '\r')) ++_it;
+                f64 number;
+                auto result = std::from_chars(_it, _end, number);
+                if (result.ec != std::errc()) return false;
+                _it = result.ptr;
+                value = static_cast<T>(number);
+                return true;
+            }
+            else
+            {
+                const u32 size = get_type_size(type);
+                if (static_cast<size_t>(_end - _it) < size) return false;
+                value = read_scalar<T, E == Encoding::swapped>(_it, type);
+                _it += size;
+                return true;
+            }
+        }
+
+        // Reads the length of a list property
+        bool read_count(Type type, u64 &count)
+        {
+            f64 value;
+            if (!read(type, value) || value < 0) return false;
+            count = static_cast<u64>(value);
+            return true;
+        }
+
+        bool skip(const Property &property)
+        {
+            u64 count = 1;
+            if (property.count_type != Type::none && !read_count(property.count_type, count)) return false;
+            if constexpr (E == Encoding::ascii)
+            {
+                f64 value;
+                for (u64 i = 0; i < count; ++i)
+                    if (!read(property.type, value)) return false;
+                return true;
+            }
+            else
+            {
+                const u64 size = count * get_type_size(property.type);
+                if (static_cast<u64>(_end - _it) < size) return false;
+                _it += size;
+                return true;
+            }
+        }
+
+        bool skip_record(const Element &element)
+        {
+            begin_record();
+            if constexpr (E == Encoding::ascii)
+            {
+                if (_it >= _end) return false;
+            }
+            else
+            {
+                for (auto &property : element.properties)
+                    if (!skip(property)) return false;
+            }
+            end_record();
+            return true;
+        }
+
+    private:
+        const char *_it, *_end;
+
+        static bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+    };
+
+    /**
+     * Finds the first record of every block of the element. Binary records without lists are located
+     * directly, other records are walked once.
+     * @return End of the element data, nullptr if the data is truncated
+     **/
+    template <Encoding E>
+    static const char *locate_blocks(const Element &element, const char *it, const char *end,
+                                     acul::vector<const char *> &blocks)
+    {
+        blocks.clear();
+        if (E != Encoding::ascii && element.stride)
+        {
+            if (static_cast<u64>(end - it) / element.stride < element.count) return nullptr;
+            for (u64 i = 0; i < element.count; i += block_size) blocks.push_back(it + i * element.stride);
+            return it + element.count * element.stride;
+        }
+        Reader<E> reader(it, end);
+        for (u64 i = 0; i < element.count; ++i)
+        {
+            reader.begin_record();
+            if (i % block_size == 0) blocks.push_back(reader.position());
+            if (!reader.skip_record(element)) return nullptr;
+        }
+        return reader.position();
+    }
+
+    // Vertex attributes stored by the importer
+    enum Slot
+    {
+        slot_x,
+        slot_y,
+        slot_z,
+        slot_nx,
+        slot_ny,
+        slot_nz,
+        slot_u,
+        slot_v,
+        slot_count
+    };
+
+    static int get_slot(acul::string_view name)
+    {
+        static const struct
+        {
+            const char *name;
+            int slot;
+        } names[] = {{"x", slot_x},          {"y", slot_y},         {"z", slot_z},
+                     {"nx", slot_nx},        {"ny", slot_ny},       {"nz", slot_nz},
+                     {"u", slot_u},          {"v", slot_v},         {"s", slot_u},
+                     {"t", slot_v},          {"texture_u", slot_u}, {"texture_v", slot_v},
+                     {"texture_s", slot_u},  {"texture_t", slot_v}};
+        for (auto &entry : names)
+            if (name == entry.name) return entry.slot;
+        return -1;
+    }
+
+    static void store_vertex(const f32 *values, Vertex &vertex)
+    {
+        vertex.pos = {values[slot_x], values[slot_y], values[slot_z]};
+        vertex.normal = {values[slot_nx], values[slot_ny], values[slot_nz]};
+        vertex.uv = {values[slot_u], values[slot_v]};
+    }
+
+    // Decoding state shared by the element tasks
+    struct DecodeCtx
+    {
+        Model &model;
+        ProgressToken *progress;
+        acul::vector<const char *> block_errors;
+    };
+
+    template <Encoding E>
+    static void decode_vertices(const Element &element, const acul::vector<const char *> &blocks, const char *end,
+                                DecodeCtx &ctx)
+    {
+        auto &vertices = ctx.model.vertices;
+        acul::vector<int> slots(element.properties.size());
+        for (size_t p = 0; p < slots.size(); ++p)
+            slots[p] = element.properties[p].count_type == Type::none ? get_slot(element.properties[p].name) : -1;
+
+        if (E != Encoding::ascii && element.stride)
+        {
+            // Fixed size records: the used fields are read at their offsets, a packed f32 position is copied
+            struct Field
+            {
+                u32 offset;
+                Type type;
+                int slot;
+            };
+            acul::vector<Field> fields;
+            u32 offset = 0, position_offset = 0;
+            int packed = 0;
+            for (size_t p = 0; p < slots.size(); ++p)
+            {
+                auto &property = element.properties[p];
+                if (slots[p] >= 0) fields.push_back({offset, property.type, slots[p]});
+                if (slots[p] == slot_x + packed && property.type == Type::f32 &&
+                    (packed == 0 || offset == position_offset + packed * 4))
+                {
+                    if (packed == 0) position_offset = offset;
+                    ++packed;
+                }
+                offset += get_type_size(property.type);
+            }
+            const bool copy_position = E == Encoding::native && packed == 3;
+            if (copy_position)
+                fields.erase(std::remove_if(fields.begin(), fields.end(),
+                                            [](const Field &field) { return field.slot <= slot_z; }),
+                             fields.end());
+            const char *base = blocks.empty() ? nullptr : blocks.front();
+            oneapi::tbb::parallel_for(size_t(0), blocks.size(), [&](size_t b) {
+                if (is_cancelled(ctx.progress)) return;
+                const size_t last = std::min<size_t>(vertices.size(), (b + 1) * block_size);
+                for (size_t i = b * block_size; i < last; ++i)
+                {
+                    const char *record = base + i * element.stride;
+                    f32 values[slot_count] = {};
+                    if (copy_position) std::memcpy(values, record + position_offset, sizeof(f32) * 3);
+                    for (auto &field : fields)
+                        values[field.slot] =
+                            read_scalar<f32, E == Encoding::swapped>(record + field.offset, field.type);
+                    store_vertex(values, vertices[i]);
+                }
+            });
+            return;
+        }
+
+        oneapi::tbb::parallel_for(size_t(0), blocks.size(), [&](size_t b) {
+            if (is_cancelled(ctx.progress)) return;
+            Reader<E> reader(blocks[b], end);
+            const size_t last = std::min<size_t>(vertices.size(), (b + 1) * block_size);
+            for (size_t i = b * block_size; i < last; ++i)
+            {
+                f32 values[slot_count] = {};
+                reader.begin_record();
+                for (size_t p = 0; p < slots.size(); ++p)
+                {
+                    auto &property = element.properties[p];
+                    bool success = slots[p] >= 0 ? reader.read(property.type, values[slots[p]]) : reader.skip(property);
+                    if (!success)
+                    {
+                        ctx.block_errors[b] = "Invalid vertex record";
+                        return;
+                    }
+                }
+                reader.end_record();
+                store_vertex(values, vertices[i]);
+            }
+        });
+    }
+
+    template <Encoding E>
+    static void decode_faces(const Element &element, const acul::vector<const char *> &blocks, const char *end,
+                             DecodeCtx &ctx)
+    {
+        auto &faces = ctx.model.faces;
+        const u32 vertex_count = ctx.model.vertices.size();
+        oneapi::tbb::parallel_for(size_t(0), blocks.size(), [&](size_t b) {
+            if (is_cancelled(ctx.progress)) return;
+            Reader<E> reader(blocks[b], end);
+            const size_t last = std::min<size_t>(faces.size(), (b + 1) * block_size);
+            for (size_t f = b * block_size; f < last; ++f)
+            {
+                auto &face = faces[f];
+                reader.begin_record();
+                for (auto &property : element.properties)
+                {
+                    const bool indices = property.count_type != Type::none &&
+                                         (property.name == "vertex_indices" || property.name == "vertex_index");
+                    if (!indices)
+                    {
+                        if (reader.skip(property)) continue;
+                        ctx.block_errors[b] = "Invalid face record";
+                        return;
+                    }
+                    u64 count;
+                    if (!reader.read_count(property.count_type, count) || count > vertex_count)
+                    {
+                        ctx.block_errors[b] = "Invalid face record";
+                        return;
+                    }
+                    face.vertices.resize(count);
+                    for (auto &ref : face.vertices)
+                    {
+                        f64 id;
+                        if (!reader.read(property.type, id) || id < 0 || id >= vertex_count)
+                        {
+                            ctx.block_errors[b] = "Face vertex index out of range";
+                            return;
+                        }
+                        // Every vertex forms its own group
+                        ref.group = ref.vertex = static_cast<u32>(id);
+                    }
+                }
+                reader.end_record();
+            }
+        });
+    }
+
+    Importer::~Importer() { acul::release(_ctx); }
+
+    acul::op_result Importer::cancel()
+    {
+        acul::release(_ctx);
+        _ctx = nullptr;
+        return ILoader::cancel();
+    }
+
+    static void split_tokens(acul::string_view line, acul::vector<acul::string_view> &tokens)
+    {
+        tokens.clear();
+        size_t i = 0;
+        while (i < line.size())
+        {
+            while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) ++i;
+            const size_t begin = i;
+            while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r') ++i;
+            if (i > begin) tokens.push_back(line.substr(begin, i - begin));
+        }
+    }
+
+    acul::op_result Importer::read_source()
+    {
+        acul::release(_ctx);
+        _ctx = acul::alloc<ImportCtx>();
+        _error.clear();
+        StageTimer timer(_stats, Stage::read);
+        auto read_error = [this](const acul::string &error) {
+            _error = error;
+            return acul::op_result(ACUL_OP_READ_ERROR, AECL_OP_DOMAIN, 0);
+        };
+
+        auto &file = _ctx->file;
+        if (!file.open(_path)) return read_error("Failed to open file");
+        if (_stats) _stats->bytes_read += file.size();
+
+        acul::string_view text(file.data(), file.size());
+        acul::vector<acul::string_view> tokens;
+        bool has_format = false;
+        size_t offset = 0;
+        for (int line_id = 0;; ++line_id)
+        {
+            const size_t line_end = text.find('\n', offset);
+            if (line_end == acul::string_view::npos) return read_error("PLY header is not terminated");
+            split_tokens(text.substr(offset, line_end - offset), tokens);
+            offset = line_end + 1;
+            if (line_id == 0)
+            {
+                if (tokens.size() != 1 || tokens[0] != "ply") return read_error("Not a PLY file");
+                continue;
+            }
+            if (tokens.empty() || tokens[0] == "comment" || tokens[0] == "obj_info") continue;
+            if (tokens[0] == "end_header") break;
+            if (tokens[0] == "format" && tokens.size() >= 2)
+            {
+                if (tokens[1] == "ascii") _ctx->encoding = Encoding::ascii;
+                else if (tokens[1] == "binary_little_endian")
+                    _ctx->encoding = get_encoding(Format::binary_little_endian);
+                else if (tokens[1] == "binary_big_endian") _ctx->encoding = get_encoding(Format::binary_big_endian);
+                else return read_error(acul::format("Unsupported PLY format: %.*s", (int)tokens[1].size(),
+                                                    tokens[1].data()));
+                has_format = true;
+            }
+            else if (tokens[0] == "element" && tokens.size() == 3)
+            {
+                Element element;
+                element.name = acul::string(tokens[1].data(), tokens[1].size());
+                if (std::from_chars(tokens[2].data(), tokens[2].data() + tokens[2].size(), element.count).ec !=
+                    std::errc())
+                    return read_error(acul::format("Invalid element count at header line %d", line_id + 1));
+                _ctx->elements.push_back(std::move(element));
+            }
+            else if (tokens[0] == "property" && !_ctx->elements.empty())
+            {
+                Property property;
+                if (tokens.size() == 5 && tokens[1] == "list")
+                {
+                    property.count_type = parse_type(tokens[2]);
+                    property.type = parse_type(tokens[3]);
+                    property.name = acul::string(tokens[4].data(), tokens[4].size());
+                    if (property.count_type == Type::none || property.count_type == Type::f32 ||
+                        property.count_type == Type::f64)
+                        property.type = Type::none;
+                }
+                else if (tokens.size() == 3)
+                {
+                    property.type = parse_type(tokens[1]);
+                    property.name = acul::string(tokens[2].data(), tokens[2].size());
+                }
+                if (property.type == Type::none)
+                    return read_error(acul::format("Invalid property at header line %d", line_id + 1));
+                _ctx->elements.back().properties.push_back(std::move(property));
+            }
+            else return read_error(acul::format("Invalid PLY header line %d", line_id + 1));
+        }
+        if (!has_format) return read_error("PLY format is not declared");
+
+        // The counts are checked against the data size before build_geometry allocates the records. A binary
+        // record takes at least its scalars and list lengths, an ASCII record at least one byte.
+        u64 remaining = file.size() - offset;
+        for (auto &element : _ctx->elements)
+        {
+            u32 stride = 0;
+            u64 min_size = 0;
+            bool fixed = true;
+            for (auto &property : element.properties)
+            {
+                const bool list = property.count_type != Type::none;
+                min_size += get_type_size(list ? property.count_type : property.type);
+                fixed &= !list;
+                stride += get_type_size(property.type);
+            }
+            element.stride = fixed ? stride : 0;
+            if (_ctx->encoding == Encoding::ascii || min_size == 0) min_size = 1;
+            if (element.count > remaining / min_size)
+                return read_error(acul::format("Element count exceeds the file size: %s", element.name.c_str()));
+            remaining -= element.count * min_size;
+        }
+        _ctx->body = offset;
+        report_progress(_progress, progress_read_end);
+        return acul::make_op_success();
+    }
+
+    template <Encoding E>
+    static void decode_body(const ImportCtx &ctx, DecodeCtx &decode, acul::string &error, ImportStats *stats)
+    {
+        const char *it = ctx.file.data() + ctx.body;
+        const char *end = ctx.file.data() + ctx.file.size();
+        acul::vector<const char *> blocks;
+        for (auto &element : ctx.elements)
+        {
+            const char *next = locate_blocks<E>(element, it, end, blocks);
+            if (!next)
+            {
+                error = acul::format("Truncated element data: %s", element.name.c_str());
+                return;
+            }
+            if (stats && E == Encoding::ascii) stats->lines += element.count;
+            decode.block_errors.assign(blocks.size(), nullptr);
+            if (element.name == "vertex") decode_vertices<E>(element, blocks, next, decode);
+            else if (element.name == "face") decode_faces<E>(element, blocks, next, decode);
+            for (auto reason : decode.block_errors)
+                if (reason)
+                {
+                    error = reason;
+                    return;
+                }
+            if (is_cancelled(decode.progress)) return;
+            it = next;
+            report_progress(decode.progress, progress_read_end + (progress_parse_end - progress_read_end) *
+                                                                     (it - ctx.file.data()) / ctx.file.size());
+        }
+    }
+
+    // Polygon normal by Newell's method, robust for non planar faces
+    static amal::vec3 get_face_normal(const Face &face, const acul::vector<Vertex> &vertices)
+    {
+        amal::vec3 normal{0.0f, 0.0f, 0.0f};
+        for (size_t i = 0; i < face.vertices.size(); ++i)
+        {
+            auto &a = vertices[face.vertices[i].vertex].pos;
+            auto &b = vertices[face.vertices[(i + 1) % face.vertices.size()].vertex].pos;
+            normal.x += (a.y - b.y) * (a.z + b.z);
+            normal.y += (a.z - b.z) * (a.x + b.x);
+            normal.z += (a.x - b.x) * (a.y + b.y);
+        }
+        return normal;
+    }
+
+    static amal::vec3 safe_normalize(const amal::vec3 &v)
+    {
+        return amal::dot(v, v) > 0.0f ? amal::normalize(v) : v;
+    }
+
+    void Importer::build_geometry()
+    {
+        auto mesh = acul::make_shared<Mesh>();
+        auto &model = mesh->model;
+        bool has_normals = false, has_faces = false;
+        for (auto &element : _ctx->elements)
+        {
+            if (element.name == "vertex")
+            {
+                model.vertices.resize(element.count);
+                for (auto &property : element.properties) has_normals |= property.name == "nx";
+            }
+            else if (element.name == "face")
+            {
+                has_faces = element.count > 0;
+                model.faces.resize(element.count);
+            }
+        }
+
+        DecodeCtx decode{model, _progress, {}};
+        {
+            StageTimer timer(_stats, Stage::parse);
+            switch (_ctx->encoding)
+            {
+                case Encoding::ascii:
+                    decode_body<Encoding::ascii>(*_ctx, decode, _error, _stats);
+                    break;
+                case Encoding::native:
+                    decode_body<Encoding::native>(*_ctx, decode, _error, _stats);
+                    break;
+                case Encoding::swapped:
+                    decode_body<Encoding::swapped>(*_ctx, decode, _error, _stats);
+                    break;
+            }
+        }
+        if (!_error.empty() || is_cancelled(_progress) || model.vertices.empty()) return;
+
+        if (has_faces)
+        {
+            {
+                StageTimer timer(_stats, Stage::index);
+                oneapi::tbb::parallel_for(size_t(0), model.faces.size(), [&](size_t f) {
+                    model.faces[f].normal = get_face_normal(model.faces[f], model.vertices);
+                });
+                if (!has_normals)
+                {
+                    // Area weighted vertex normals, the triangulation projects polygons along them
+                    for (auto &face : model.faces)
+                        for (auto &ref : face.vertices) model.vertices[ref.vertex].normal += face.normal;
+                    oneapi::tbb::parallel_for(size_t(0), model.vertices.size(), [&](size_t i) {
+                        model.vertices[i].normal = safe_normalize(model.vertices[i].normal);
+                    });
+                }
+                oneapi::tbb::parallel_for(size_t(0), model.faces.size(), [&](size_t f) {
+                    model.faces[f].normal = safe_normalize(model.faces[f].normal);
+                });
+            }
+
+            // Triangles are indexed directly, polygons are triangulated. Every block collects its own indices.
+            StageTimer timer(_stats, Stage::triangulate);
+            const size_t block_count = (model.faces.size() + block_size - 1) / block_size;
+            acul::vector<acul::vector<u32>> block_indices(block_count);
+            oneapi::tbb::parallel_for(size_t(0), block_count, [&](size_t b) {
+                if (is_cancelled(_progress)) return;
+                auto &indices = block_indices[b];
+                const size_t last = std::min(model.faces.size(), (b + 1) * block_size);
+                for (size_t f = b * block_size; f < last; ++f)
+                {
+                    auto &face = model.faces[f];
+                    face.first_vertex = indices.size();
+                    if (face.vertices.size() == 3)
+                        for (auto &ref : face.vertices) indices.push_back(ref.vertex);
+                    else
+                    {
+                        auto triangles = utils::triangulate(face, model.vertices);
+                        indices.insert(indices.end(), triangles.begin(), triangles.end());
+                    }
+                    face.count = indices.size() - face.first_vertex;
+                }
+            });
+            if (is_cancelled(_progress)) return;
+            acul::vector<size_t> block_offsets(block_count + 1, 0);
+            for (size_t b = 0; b < block_count; ++b) block_offsets[b + 1] = block_offsets[b] + block_indices[b].size();
+            model.indices.resize(block_offsets.back());
+            oneapi::tbb::parallel_for(size_t(0), block_count, [&](size_t b) {
+                std::copy(block_indices[b].begin(), block_indices[b].end(), model.indices.begin() + block_offsets[b]);
+                const size_t last = std::min(model.faces.size(), (b + 1) * block_size);
+                for (size_t f = b * block_size; f < last; ++f) model.faces[f].first_vertex += block_offsets[b];
+            });
+        }
+
+        model.group_count = model.vertices.size();
+        model.aabb.min = model.aabb.max = model.vertices.front().pos;
+        for (auto &vertex : model.vertices)
+        {
+            model.aabb.min = amal::min(model.aabb.min, vertex.pos);
+            model.aabb.max = amal::max(model.aabb.max, vertex.pos);
+        }
+        if (_stats)
+        {
+            _stats->vertices += model.vertices.size();
+            _stats->unique_vertices += model.vertices.size();
+            _stats->faces += model.faces.size();
+        }
+
+        acul::string name = acul::fs::get_filename(_path);
+        const size_t dot = name.rfind('.');
+        if (dot != acul::string::npos && dot > 0) name.resize(dot);
+        _objects.emplace_back(acul::id_gen()(), name);
+        _objects.back().meta.push_back(mesh);
+        acul::release(_ctx);
+        _ctx = nullptr;
+    }
+} // namespace aecl::scene::ply
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <acul/scalars.hpp>
+#include <acul/string/string_view.hpp>
+#include <aecl/scene/ply/export.hpp>
+#include <cstring>
+
+namespace aecl::scene::ply
+{
+    // Scalar property types
+    enum class Type : u8
+    {
+        none,
+        i8,
+        u8,
+        i16,
+        u16,
+        i32,
+        u32,
+        f32,
+        f64
+    };
+
+    inline Type parse_type(acul::string_view name)
+    {
+        if (name == "char" || name == "int8") return Type::i8;
+        if (name == "uchar" || name == "uint8") return Type::u8;
+        if (name == "short" || name == "int16") return Type::i16;
+        if (name == "ushort" || name == "uint16") return Type::u16;
+        if (name == "int" || name == "int32") return Type::i32;
+        if (name == "uint" || name == "uint32") return Type::u32;
+        if (name == "float" || name == "float32") return Type::f32;
+        if (name == "double" || name == "float64") return Type::f64;
+        return Type::none;
+    }
+
+    inline u32 get_type_size(Type type)
+    {
+        switch (type)
+        {
+            case Type::i8:
+            case Type::u8:
+                return 1;
+            case Type::i16:
+            case Type::u16:
+                return 2;
+            case Type::i32:
+            case Type::u32:
+            case Type::f32:
+                return 4;
+            case Type::f64:
+                return 8;
+            default:
+                return 0;
+        }
+    }
+
+    // Byte order of the host
+    inline bool is_host_little_endian()
+    {
+        const u16 probe = 1;
+        u8 first;
+        std::memcpy(&first, &probe, 1);
+        return first == 1;
+    }
+
+    // Value encoding of the element data relative to the host
+    enum class Encoding
+    {
+        ascii,
+        native,
+        swapped
+    };
+
+    inline Encoding get_encoding(Format format)
+    {
+        if (format == Format::ascii) return Encoding::ascii;
+        return (format == Format::binary_little_endian) == is_host_little_endian() ? Encoding::native
+                                                                                   : Encoding::swapped;
+    }
+
+    // Reverses the byte order of a value of N bytes in place
+    template <size_t N>
+    inline void swap_bytes(u8 *data)
+    {
+        for (size_t i = 0; i < N / 2; ++i)
+        {
+            u8 tmp = data[i];
+            data[i] = data[N - 1 - i];
+            data[N - 1 - i] = tmp;
+        }
+    }
+
+    // Loads an unaligned value stored in the given byte order
+    template <typename T, bool swap>
+    inline T load(const char *src)
+    {
+        T value;
+        std::memcpy(&value, src, sizeof(T));
+        if constexpr (swap && sizeof(T) > 1) swap_bytes<sizeof(T)>(reinterpret_cast<u8 *>(&value));
+        return value;
+    }
+
+    // Stores a value in the given byte order
+    template <typename T, bool swap>
+    inline char *store(char *dst, T value)
+    {
+        if constexpr (swap && sizeof(T) > 1) swap_bytes<sizeof(T)>(reinterpret_cast<u8 *>(&value));
+        std::memcpy(dst, &value, sizeof(T));
+        return dst + sizeof(T);
+    }
+} // namespace aecl::scene::ply
@@ -0,0 +1,160 @@
+#include <acul/io/fs/path.hpp>
+#include <aecl/scene/gltf/export.hpp>
+#include <aecl/scene/gltf/import.hpp>
+#include <aecl/scene/native/export.hpp>
+#include <aecl/scene/native/import.hpp>
+#include <aecl/scene/obj/export.hpp>
+#include <aecl/scene/obj/import.hpp>
+#include <aecl/scene/ply/export.hpp>
+#include <aecl/scene/ply/import.hpp>
+#include <aecl/scene/registry.hpp>
+#include <aecl/scene/stl/import.hpp>
+#include "../codec_table.hpp"
+#include "../io/file.hpp"
+
+namespace aecl::scene
+{
+    enum class Builtin : u8
+    {
+        unknown,
+        obj,
+        gltf,
+        glb,
+        ply,
+        stl,
+        native
+    };
+
+    constexpr ExtensionEntry<Builtin> builtin_extensions[] = {{".obj", Builtin::obj}, {".gltf", Builtin::gltf},
+                                                              {".glb", Builtin::glb}, {".ply", Builtin::ply},
+                                                              {".stl", Builtin::stl}, {".umsc", Builtin::native}};
+
+    constexpr ExtensionMap builtin_extension_map(builtin_extensions);
+
+    static bool is_space(u8 c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+    // Skip the UTF-8 BOM and leading whitespace
+    static size_t skip_preamble(const u8 *data, size_t size)
+    {
+        size_t pos = has_signature(data, size, "\xEF\xBB\xBF", 3) ? 3 : 0;
+        while (pos < size && is_space(data[pos])) ++pos;
+        return pos;
+    }
+
+    static bool contains(const u8 *data, size_t size, acul::string_view token)
+    {
+        for (size_t i = 0; i + token.size() <= size; ++i)
+            if (has_signature(data, size, token.data(), token.size(), i)) return true;
+        return false;
+    }
+
+    // glTF JSON documents are objects with a required "asset" property, exporters write it first
+    static bool sniff_gltf(const u8 *data, size_t size)
+    {
+        size_t pos = skip_preamble(data, size);
+        return pos < size && data[pos] == '{' && contains(data + pos, size - pos, "\"asset\"");
+    }
+
+    // Only ASCII STL has a signature. Binary files may start with "solid" too, so the first facet is required.
+    static bool sniff_stl(const u8 *data, size_t size)
+    {
+        size_t pos = skip_preamble(data, size);
+        return has_signature(data, size, "solid", 5, pos) && contains(data + pos, size - pos, "facet");
+    }
+
+    // The first statement after the comments must be an OBJ keyword
+    static bool sniff_obj(const u8 *data, size_t size)
+    {
+        static const acul::string_view keywords[] = {"v ", "vt ", "vn ", "f ", "o ", "g ", "s ", "mtllib ", "usemtl "};
+        size_t pos = skip_preamble(data, size);
+        while (pos < size && data[pos] == '#')
+        {
+            while (pos < size && data[pos] != '\n') ++pos;
+            pos += skip_preamble(data + pos, size - pos);
+        }
+        for (auto keyword : keywords)
+            if (has_signature(data, size, keyword.data(), keyword.size(), pos)) return true;
+        return false;
+    }
+
+    static Builtin get_builtin_by_signature(const u8 *data, size_t size)
+    {
+        if (has_signature(data, size, "glTF", 4)) return Builtin::glb;
+        if (has_signature(data, size, "ply\n", 4) || has_signature(data, size, "ply\r\n", 5)) return Builtin::ply;
+        if (sniff_gltf(data, size)) return Builtin::gltf;
+        if (sniff_stl(data, size)) return Builtin::stl;
+        if (sniff_obj(data, size)) return Builtin::obj;
+        return Builtin::unknown;
+    }
+
+    static ILoader *create_builtin_loader(Builtin type, const acul::string &path)
+    {
+        switch (type)
+        {
+            case Builtin::obj:
+                return acul::alloc<obj::Importer>(path);
+            case Builtin::gltf:
+            case Builtin::glb:
+                return acul::alloc<gltf::Importer>(path);
+            case Builtin::ply:
+                return acul::alloc<ply::Importer>(path);
+            case Builtin::stl:
+                return acul::alloc<stl::Importer>(path);
+            case Builtin::native:
+                return acul::alloc<native::Importer>(path);
+            default:
+                return nullptr;
+        }
+    }
+
+    static IExporter *create_builtin_exporter(Builtin type, const acul::string &path)
+    {
+        switch (type)
+        {
+            case Builtin::obj:
+                return acul::alloc<obj::Exporter>(path);
+            case Builtin::glb:
+                return acul::alloc<gltf::Exporter>(path);
+            case Builtin::ply:
+                return acul::alloc<ply::Exporter>(path);
+            case Builtin::native:
+                return acul::alloc<native::Exporter>(path);
+            default:
+                return nullptr;
+        }
+    }
+
+    static CodecTable<Codec> &get_codec_table()
+    {
+        static CodecTable<Codec> table;
+        return table;
+    }
+
+    void register_codec(const Codec &codec) { get_codec_table().add(codec); }
+
+    ILoader *get_importer_by_path(const acul::string &path)
+    {
+        auto &table = get_codec_table();
+        const auto extension = acul::fs::get_extension(path);
+        Codec codec;
+        if (table.find_by_extension(extension, codec) && codec.create_loader) return codec.create_loader(path);
+
+        // The content wins over the extension for the built-in formats, a file may be misnamed
+        u8 head[max_signature_size];
+        const size_t size = io::read_file_head(path, head, sizeof(head));
+        Builtin type = get_builtin_by_signature(head, size);
+        if (type == Builtin::unknown) type = builtin_extension_map.find(extension, Builtin::unknown);
+        if (type != Builtin::unknown) return create_builtin_loader(type, path);
+        if (table.find_by_signature(head, size, codec) && codec.create_loader) return codec.create_loader(path);
+        return nullptr;
+    }
+
+    IExporter *get_exporter_by_path(const acul::string &path)
+    {
+        const auto extension = acul::fs::get_extension(path);
+        Codec codec;
+        if (get_codec_table().find_by_extension(extension, codec) && codec.create_exporter)
+            return codec.create_exporter(path);
+        return create_builtin_exporter(builtin_extension_map.find(extension, Builtin::unknown), path);
+    }
+} // namespace aecl::scene
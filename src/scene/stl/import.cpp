@@ -0,0 +1,344 @@
+#include <acul/io/fs/file.hpp>
+#include <algorithm>
+#include <aecl/scene/stl/import.hpp>
+#include <aecl/status.hpp>
+#include <amal/geometric.hpp>
+#include <amal/integration/acul/string.hpp>
+#include <cmath>
+#include <cstring>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/parallel_sort.h>
+#include "../../io/mapped_file.hpp"
+
+namespace aecl::scene::stl
+{
+    using namespace umbf::mesh;
+
+    // Binary layout: 80 byte header, triangle count, 50 byte records
+    constexpr size_t header_size = 84;
+    constexpr size_t record_size = 50;
+
+    // Triangles decoded by one task
+    constexpr size_t block_size = 1 << 14;
+    // Text parsed by one task, each line belongs to the chunk it starts in
+    constexpr size_t chunk_size = 1024 * 1024;
+
+    // Progress shares of the import stages
+    constexpr f32 progress_read_end = 0.4f;
+
+    struct Solid
+    {
+        acul::string name;
+        acul::vector<amal::vec3> positions; // Three corners per triangle
+        acul::vector<amal::vec3> normals;   // One per triangle
+    };
+
+    struct ImportCtx
+    {
+        io::MappedFile file;
+        acul::vector<Solid> solids;
+    };
+
+    Importer::~Importer() { acul::release(_ctx); }
+
+    acul::op_result Importer::cancel()
+    {
+        acul::release(_ctx);
+        _ctx = nullptr;
+        return ILoader::cancel();
+    }
+
+    static void decode_binary(const char *data, size_t count, Solid &solid, ProgressToken *progress)
+    {
+        solid.positions.resize(count * 3);
+        solid.normals.resize(count);
+        oneapi::tbb::parallel_for(size_t(0), (count + block_size - 1) / block_size, [&](size_t b) {
+            if (is_cancelled(progress)) return;
+            const size_t last = std::min(count, (b + 1) * block_size);
+            for (size_t t = b * block_size; t < last; ++t)
+            {
+                // Normal and corners are 12 packed floats
+                f32 values[12];
+                std::memcpy(values, data + header_size + t * record_size, sizeof(values));
+                solid.normals[t] = {values[0], values[1], values[2]};
+                for (int k = 0; k < 3; ++k)
+                    solid.positions[t * 3 + k] = {values[3 + k * 3], values[4 + k * 3], values[5 + k * 3]};
+            }
+        });
+    }
+
+    struct TextChunk
+    {
+        acul::vector<acul::pair<size_t, acul::string>> solids; // Index of the first triangle of a solid, name
+        acul::vector<amal::vec3> positions;
+        acul::vector<amal::vec3> normals;
+        size_t lines = 0;
+    };
+
+    static bool starts_with(const char *line, const char *end, acul::string_view keyword)
+    {
+        return static_cast<size_t>(end - line) >= keyword.size() && memcmp(line, keyword.data(), keyword.size()) == 0;
+    }
+
+    // Parses three floats of [token, line_end) through a terminated copy, stov3 would run past the mapping
+    static bool parse_vec3(const char *token, const char *line_end, amal::vec3 &v)
+    {
+        char buffer[128];
+        const size_t size = std::min<size_t>(line_end - token, sizeof(buffer) - 1);
+        std::memcpy(buffer, token, size);
+        buffer[size] = '\0';
+        const char *it = buffer;
+        return acul::stov3(it, v);
+    }
+
+    static void parse_chunk(const char *begin, const char *end, const char *file_end, TextChunk &chunk)
+    {
+        for (const char *line = begin; line < end;)
+        {
+            const char *line_end = static_cast<const char *>(memchr(line, '\n', file_end - line));
+            if (!line_end) line_end = file_end;
+            ++chunk.lines;
+            const char *token = line;
+            while (token < line_end && (*token == ' ' || *token == '\t')) ++token;
+            if (starts_with(token, line_end, "vertex"))
+            {
+                amal::vec3 v;
+                if (parse_vec3(token + 6, line_end, v)) chunk.positions.push_back(v);
+            }
+            else if (starts_with(token, line_end, "facet normal"))
+            {
+                amal::vec3 n;
+                if (!parse_vec3(token + 12, line_end, n)) n = amal::vec3(0.0f);
+                chunk.normals.push_back(n);
+            }
+            else if (starts_with(token, line_end, "solid"))
+            {
+                token += 5;
+                while (token < line_end && (*token == ' ' || *token == '\t')) ++token;
+                chunk.solids.emplace_back(chunk.normals.size(),
+                                          acul::trim_end(token, static_cast<size_t>(line_end - token)));
+            }
+            line = line_end + 1;
+        }
+    }
+
+    // Parses the text in parallel chunks and splits the triangles into their solids
+    static void decode_text(const char *data, size_t size, acul::vector<Solid> &solids, ImportStats *stats,
+                            ProgressToken *progress)
+    {
+        acul::vector<TextChunk> chunks((size + chunk_size - 1) / chunk_size);
+        oneapi::tbb::parallel_for(size_t(0), chunks.size(), [&](size_t c) {
+            if (is_cancelled(progress)) return;
+            const char *begin = data + c * chunk_size;
+            const char *end = data + std::min(size, (c + 1) * chunk_size);
+            if (c > 0)
+            {
+                // Skip the line started in the previous chunk
+                const char *line_end = static_cast<const char *>(memchr(begin - 1, '\n', end - begin + 1));
+                if (!line_end) return;
+                begin = line_end + 1;
+            }
+            parse_chunk(begin, end, data + size, chunks[c]);
+        });
+        if (is_cancelled(progress)) return;
+
+        acul::vector<amal::vec3> positions, normals;
+        acul::vector<acul::pair<size_t, acul::string>> starts;
+        for (auto &chunk : chunks)
+        {
+            for (auto &[first, name] : chunk.solids) starts.emplace_back(normals.size() + first, std::move(name));
+            positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+            normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+            if (stats) stats->lines += chunk.lines;
+        }
+        // Facets without three vertices are dropped along with the unmatched tail
+        const size_t count = std::min(normals.size(), positions.size() / 3);
+        if (starts.empty() || starts.front().first > 0) starts.emplace(starts.begin(), 0, acul::string());
+        for (size_t s = 0; s < starts.size(); ++s)
+        {
+            const size_t first = std::min(starts[s].first, count);
+            const size_t last = s + 1 < starts.size() ? std::min(starts[s + 1].first, count) : count;
+            if (first == last) continue;
+            Solid solid;
+            solid.name = std::move(starts[s].second);
+            solid.positions.assign(positions.begin() + first * 3, positions.begin() + last * 3);
+            solid.normals.assign(normals.begin() + first, normals.begin() + last);
+            solids.push_back(std::move(solid));
+        }
+    }
+
+    acul::op_result Importer::read_source()
+    {
+        acul::release(_ctx);
+        _ctx = acul::alloc<ImportCtx>();
+        _error.clear();
+        StageTimer timer(_stats, Stage::read);
+        auto &file = _ctx->file;
+        if (!file.open(_path))
+        {
+            _error = "Failed to open file";
+            return acul::op_result(ACUL_OP_READ_ERROR, AECL_OP_DOMAIN, 0);
+        }
+        if (_stats) _stats->bytes_read += file.size();
+
+        // Binary files may also start with "solid", the record count decides
+        u32 count = 0;
+        if (file.size() >= header_size) std::memcpy(&count, file.data() + 80, sizeof(count));
+        const size_t binary_size = header_size + static_cast<size_t>(count) * record_size;
+        const bool text = file.size() >= 5 && memcmp(file.data(), "solid", 5) == 0;
+        if (file.size() >= header_size && (binary_size == file.size() || (!text && binary_size < file.size())))
+        {
+            _ctx->solids.emplace_back();
+            decode_binary(file.data(), count, _ctx->solids.front(), _progress);
+        }
+        else if (text) decode_text(file.data(), file.size(), _ctx->solids, _stats, _progress);
+        else
+        {
+            _error = "Truncated binary STL file";
+            return acul::op_result(ACUL_OP_READ_ERROR, AECL_OP_DOMAIN, 0);
+        }
+        if (is_cancelled(_progress)) return cancel();
+        report_progress(_progress, progress_read_end);
+        return acul::make_op_success();
+    }
+
+    // Position or vertex key compared by value bits. The corner keeps the sort deterministic.
+    struct WeldKey
+    {
+        u32 key[4];
+        u32 corner;
+
+        bool operator<(const WeldKey &rhs) const
+        {
+            for (int i = 0; i < 4; ++i)
+                if (key[i] != rhs.key[i]) return key[i] < rhs.key[i];
+            return corner < rhs.corner;
+        }
+
+        bool same(const WeldKey &rhs) const { return std::memcmp(key, rhs.key, sizeof(key)) == 0; }
+    };
+
+    static void set_key(u32 *key, const amal::vec3 &v)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            const f32 value = v[i] + 0.0f; // -0 welds with +0
+            std::memcpy(key + i, &value, sizeof(value));
+        }
+    }
+
+    /**
+     * Sorts the keys in parallel and numbers the runs of equal keys.
+     * @param ids Receives the id of every corner
+     * @return Number of unique keys
+     **/
+    static u32 weld(acul::vector<WeldKey> &keys, acul::vector<u32> &ids)
+    {
+        oneapi::tbb::parallel_sort(keys.begin(), keys.end());
+        ids.resize(keys.size());
+        u32 count = 0;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            if (i > 0 && !keys[i].same(keys[i - 1])) ++count;
+            ids[keys[i].corner] = count;
+        }
+        return keys.empty() ? 0 : count + 1;
+    }
+
+    static acul::shared_ptr<Mesh> build_mesh(Solid &solid)
+    {
+        const size_t corners = solid.positions.size();
+        const size_t triangles = solid.normals.size();
+
+        // Missing or degenerate stored normals are computed from the corners
+        oneapi::tbb::parallel_for(size_t(0), triangles, [&](size_t t) {
+            auto &normal = solid.normals[t];
+            const f32 length = amal::dot(normal, normal);
+            if (length > 0.0f && std::isfinite(length)) return;
+            auto *p = solid.positions.data() + t * 3;
+            normal = amal::cross(p[1] - p[0], p[2] - p[0]);
+            if (amal::dot(normal, normal) > 0.0f) normal = amal::normalize(normal);
+            else normal = amal::vec3(0.0f);
+        });
+
+        acul::vector<WeldKey> keys(corners);
+        oneapi::tbb::parallel_for(size_t(0), corners, [&](size_t c) {
+            set_key(keys[c].key, solid.positions[c]);
+            keys[c].key[3] = 0;
+            keys[c].corner = c;
+        });
+        acul::vector<u32> groups, vertex_ids;
+        auto mesh = acul::make_shared<Mesh>();
+        auto &model = mesh->model;
+        model.group_count = weld(keys, groups);
+
+        oneapi::tbb::parallel_for(size_t(0), corners, [&](size_t c) {
+            keys[c].key[0] = groups[c];
+            set_key(keys[c].key + 1, solid.normals[c / 3]);
+            keys[c].corner = c;
+        });
+        model.vertices.resize(weld(keys, vertex_ids));
+        // Each vertex is written once, by the first corner of its sorted run, so the stored sign of a welded
+        // zero does not depend on scheduling
+        oneapi::tbb::parallel_for(size_t(0), corners, [&](size_t i) {
+            if (i > 0 && keys[i].same(keys[i - 1])) return;
+            const size_t c = keys[i].corner;
+            auto &vertex = model.vertices[vertex_ids[c]];
+            vertex.pos = solid.positions[c];
+            vertex.normal = solid.normals[c / 3];
+        });
+
+        model.faces.resize(triangles);
+        model.indices.resize(corners);
+        oneapi::tbb::parallel_for(size_t(0), triangles, [&](size_t t) {
+            auto &face = model.faces[t];
+            face.vertices.resize(3);
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const size_t c = t * 3 + k;
+                face.vertices[k] = {groups[c], vertex_ids[c]};
+                model.indices[c] = vertex_ids[c];
+            }
+            face.normal = solid.normals[t];
+            face.first_vertex = t * 3;
+            face.count = 3;
+        });
+
+        model.aabb.min = model.aabb.max = solid.positions.front();
+        for (auto &pos : solid.positions)
+        {
+            model.aabb.min = amal::min(model.aabb.min, pos);
+            model.aabb.max = amal::max(model.aabb.max, pos);
+        }
+        return mesh;
+    }
+
+    void Importer::build_geometry()
+    {
+        StageTimer timer(_stats, Stage::index);
+        acul::string file_name = acul::fs::get_filename(_path);
+        const size_t dot = file_name.rfind('.');
+        if (dot != acul::string::npos && dot > 0) file_name.resize(dot);
+        auto &solids = _ctx->solids;
+        for (size_t s = 0; s < solids.size(); ++s)
+        {
+            if (is_cancelled(_progress)) return;
+            auto &solid = solids[s];
+            if (solid.normals.empty()) continue;
+            auto mesh = build_mesh(solid);
+            if (_stats)
+            {
+                _stats->faces += solid.normals.size();
+                _stats->vertices += solid.positions.size();
+                _stats->unique_vertices += mesh->model.vertices.size();
+            }
+            _objects.emplace_back(acul::id_gen()(), solid.name.empty() ? file_name : solid.name);
+            _objects.back().meta.push_back(mesh);
+            acul::vector<amal::vec3>().swap(solid.positions);
+            acul::vector<amal::vec3>().swap(solid.normals);
+            report_progress(_progress, progress_read_end + (1.0f - progress_read_end) * (s + 1) / solids.size());
+        }
+        acul::release(_ctx);
+        _ctx = nullptr;
+    }
+} // namespace aecl::scene::stl
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <aecl/scene/export.hpp>
+#include <amal/vector.hpp>
+#include <utility>
+
+namespace aecl::scene
+{
+    /**
+     * @brief Axis transform requested by the mesh export flags.
+     *
+     * The reverse/swap flags always compose into a signed permutation matrix, so the transform is stored as
+     * out[i] = sign[i] * in[axis[i]] and applied to copies of the input. The source mesh is never modified.
+     **/
+    struct AxisTransform
+    {
+        u32 axis[3] = {0, 1, 2};
+        f32 sign[3] = {1.0f, 1.0f, 1.0f};
+        // Mirroring transform (negative determinant): face winding must be reversed on output
+        bool flip_winding = false;
+
+        explicit AxisTransform(MeshExportFlags flags)
+        {
+            // Same order as the flags were historically applied: reflections first, then swaps
+            if (flags & MeshExportFlagBits::transform_reverse_x) sign[0] = -sign[0];
+            if (flags & MeshExportFlagBits::transform_reverse_y) sign[1] = -sign[1];
+            if (flags & MeshExportFlagBits::transform_reverse_z) sign[2] = -sign[2];
+            if (flags & MeshExportFlagBits::transform_swap_xy) swap(0, 1);
+            if (flags & MeshExportFlagBits::transform_swap_xz) swap(0, 2);
+            if (flags & MeshExportFlagBits::transform_swap_yz) swap(1, 2);
+
+            bool odd = false;
+            for (int i = 0; i < 3; ++i)
+                for (int j = i + 1; j < 3; ++j) odd ^= axis[i] > axis[j];
+            flip_winding = (sign[0] * sign[1] * sign[2] < 0) != odd;
+        }
+
+        bool identity() const
+        {
+            return axis[0] == 0 && axis[1] == 1 && axis[2] == 2 && sign[0] > 0 && sign[1] > 0 && sign[2] > 0;
+        }
+
+        amal::vec3 operator()(const amal::vec3 &v) const
+        {
+            return {sign[0] * v[axis[0]], sign[1] * v[axis[1]], sign[2] * v[axis[2]]};
+        }
+
+        /**
+         * Transforms a batch of vectors. The loop has no data dependent branches and vectorizes.
+         * @param get Accessor returning the i-th source vector
+         **/
+        template <typename Get>
+        void apply(size_t count, Get &&get, amal::vec3 *dst) const
+        {
+            const u32 a0 = axis[0], a1 = axis[1], a2 = axis[2];
+            const f32 s0 = sign[0], s1 = sign[1], s2 = sign[2];
+            for (size_t i = 0; i < count; ++i)
+            {
+                const amal::vec3 &v = get(i);
+                dst[i] = {s0 * v[a0], s1 * v[a1], s2 * v[a2]};
+            }
+        }
+
+    private:
+        void swap(int a, int b)
+        {
+            std::swap(axis[a], axis[b]);
+            std::swap(sign[a], sign[b]);
+        }
+    };
+} // namespace aecl::scene
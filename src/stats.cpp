@@ -0,0 +1,98 @@
+#include <acul/string/sstream.hpp>
+#include <aecl/stats.hpp>
+#ifdef _WIN32
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+namespace aecl
+{
+    const char *get_stage_name(Stage stage)
+    {
+        switch (stage)
+        {
+            case Stage::read:
+                return "read";
+            case Stage::line_split:
+                return "line_split";
+            case Stage::parse:
+                return "parse";
+            case Stage::sort_merge:
+                return "sort_merge";
+            case Stage::index:
+                return "index";
+            case Stage::triangulate:
+                return "triangulate";
+            case Stage::material_resolve:
+                return "material_resolve";
+            case Stage::decode:
+                return "decode";
+            case Stage::convert:
+                return "convert";
+            default:
+                return "unknown";
+        }
+    }
+
+    u64 get_peak_memory()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+        return counters.PeakWorkingSetSize;
+#else
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    #ifdef __APPLE__
+        return usage.ru_maxrss;
+    #else
+        return static_cast<u64>(usage.ru_maxrss) * 1024;
+    #endif
+#endif
+    }
+
+    void ImportStats::merge(const ImportStats &other)
+    {
+        for (int i = 0; i < static_cast<int>(Stage::count); ++i) stage_time[i] += other.stage_time[i];
+        lines += other.lines;
+        faces += other.faces;
+        vertices += other.vertices;
+        unique_vertices += other.unique_vertices;
+        bytes_read += other.bytes_read;
+        bytes_decoded += other.bytes_decoded;
+        peak_memory = std::max(peak_memory, other.peak_memory);
+        peak_memory_growth = std::max(peak_memory_growth, other.peak_memory_growth);
+        const i64 shift = std::chrono::duration_cast<std::chrono::nanoseconds>(other.origin - origin).count();
+        events.reserve(events.size() + other.events.size());
+        for (const auto &event : other.events)
+        {
+            const i64 begin = static_cast<i64>(event.begin) + shift;
+            events.push_back({event.stage, static_cast<u64>(std::max<i64>(begin, 0)), event.duration});
+        }
+    }
+
+    acul::string ImportStats::to_chrome_trace() const
+    {
+        acul::stringstream ss;
+        ss.precision(3);
+        ss << std::fixed;
+        ss << "{\"traceEvents\":[";
+        ss << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"aecl import\"}}";
+        u64 end = 0;
+        for (const auto &event : events)
+        {
+            ss << ",{\"name\":\"" << get_stage_name(event.stage) << "\",\"cat\":\"aecl\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+               << ",\"ts\":" << event.begin / 1000.0 << ",\"dur\":" << event.duration / 1000.0 << "}";
+            end = std::max(end, event.begin + event.duration);
+        }
+        ss << ",{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"tid\":1,\"ts\":" << end / 1000.0 << ",\"args\":{"
+           << "\"lines\":" << lines << ",\"faces\":" << faces << ",\"vertices\":" << vertices
+           << ",\"unique_vertices\":" << unique_vertices << ",\"bytes_read\":" << bytes_read
+           << ",\"bytes_decoded\":" << bytes_decoded << ",\"peak_memory\":" << peak_memory
+           << ",\"peak_memory_growth\":" << peak_memory_growth << "}}";
+        ss << "]}";
+        return ss.str();
+    }
+} // namespace aecl
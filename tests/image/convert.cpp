@@ -0,0 +1,111 @@
+#include <aecl/image/convert.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace aecl;
+
+static umbf::Image2D make_image(void *pixels, u32 width, u32 height, const acul::vector<acul::string> &channels,
+                                umbf::ImageFormat format)
+{
+    umbf::Image2D image;
+    image.width = width;
+    image.height = height;
+    image.channels = channels;
+    image.format = format;
+    image.pixels = pixels;
+    return image;
+}
+
+void test_image_convert()
+{
+    const umbf::ImageFormat u8_format = {umbf::ImageFormat::Type::uint, 1};
+    const umbf::ImageFormat u16_format = {umbf::ImageFormat::Type::uint, 2};
+    const umbf::ImageFormat half_format = {umbf::ImageFormat::Type::sfloat, 2};
+    const umbf::ImageFormat f32_format = {umbf::ImageFormat::Type::sfloat, 4};
+
+    // f32 RGBA to u8 RGB: clamped, rounded and the alpha dropped. The odd width covers the scalar tails.
+    constexpr u32 width = 37, height = 5;
+    acul::vector<f32> rgba(width * height * 4);
+    for (size_t i = 0; i < rgba.size(); ++i) rgba[i] = static_cast<f32>(i % 300) / 256.0f - 0.1f;
+    rgba[5] = std::numeric_limits<f32>::quiet_NaN();
+    auto image = make_image(rgba.data(), width, height, {"R", "G", "B", "A"}, f32_format);
+    auto *rgb = static_cast<u8 *>(image::convert_image(image, u8_format, 3));
+    assert(rgb);
+    for (size_t p = 0; p < width * height; ++p)
+        for (size_t c = 0; c < 3; ++c)
+        {
+            f32 value = rgba[p * 4 + c];
+            value = value > 0.0f ? std::min(value, 1.0f) : 0.0f;
+            assert(rgb[p * 3 + c] == static_cast<u8>(std::lrint(value * 255.0f)));
+        }
+    assert(rgb[5] == 0);
+    acul::release(rgb);
+
+    // u8 BGRA to u8 RGB: channels are matched by name
+    u8 bgra[] = {10, 20, 30, 40, 50, 60, 70, 80};
+    image = make_image(bgra, 2, 1, {"B", "G", "R", "A"}, u8_format);
+    rgb = static_cast<u8 *>(image::convert_image(image, u8_format, 3));
+    const u8 expected_rgb[] = {30, 20, 10, 70, 60, 50};
+    assert(memcmp(rgb, expected_rgb, sizeof(expected_rgb)) == 0);
+    acul::release(rgb);
+
+    // u8 BGRA to u8 RGBA and f32 BGR to f32 RGB: equal channel counts are still swizzled by name
+    image = make_image(bgra, 2, 1, {"B", "G", "R", "A"}, u8_format);
+    auto *swizzled = static_cast<u8 *>(image::convert_image(image, u8_format, 4));
+    const u8 expected_rgba[] = {30, 20, 10, 40, 70, 60, 50, 80};
+    assert(memcmp(swizzled, expected_rgba, sizeof(expected_rgba)) == 0);
+    acul::release(swizzled);
+    assert(image::needs_channel_remap(image, 4));
+    image = make_image(bgra, 2, 1, {"R", "G", "B", "A"}, u8_format);
+    assert(!image::needs_channel_remap(image, 4) && image::needs_channel_remap(image, 3));
+    f32 bgr[] = {0.25f, 0.5f, 0.75f};
+    image = make_image(bgr, 1, 1, {"B", "G", "R"}, f32_format);
+    auto *rgb_f32 = static_cast<f32 *>(image::convert_image(image, f32_format, 3));
+    assert(rgb_f32[0] == 0.75f && rgb_f32[1] == 0.5f && rgb_f32[2] == 0.25f);
+    acul::release(rgb_f32);
+
+    // Cropped u8 RGB to u8 RGBA: rows are read with the stride of the full image
+    u8 grid[4 * 2 * 3];
+    for (u8 i = 0; i < sizeof(grid); ++i) grid[i] = i;
+    const acul::string rgb_names[] = {"R", "G", "B"};
+    image::ImageView view(grid, 4, 2, u8_format, 3, 0, rgb_names);
+    auto *cropped = static_cast<u8 *>(image::convert_image(view.crop(1, 0, 2, 2), u8_format, 4));
+    const u8 expected_crop[] = {3, 4, 5, 255, 6, 7, 8, 255, 15, 16, 17, 255, 18, 19, 20, 255};
+    assert(memcmp(cropped, expected_crop, sizeof(expected_crop)) == 0);
+    acul::release(cropped);
+
+    // u16 luminance to u8 RGBA: expanded to color with an opaque alpha
+    acul::vector<u16> gray(width);
+    for (u32 x = 0; x < width; ++x) gray[x] = static_cast<u16>(x * 1771);
+    image = make_image(gray.data(), width, 1, {"Y"}, u16_format);
+    auto *expanded = static_cast<u8 *>(image::convert_image(image, u8_format, 4));
+    for (u32 x = 0; x < width; ++x)
+    {
+        const u8 value = static_cast<u8>(std::lrint(gray[x] * (1.0f / 65535.0f) * 255.0f));
+        assert(expanded[x * 4] == value && expanded[x * 4 + 1] == value && expanded[x * 4 + 2] == value);
+        assert(expanded[x * 4 + 3] == 255);
+    }
+    acul::release(expanded);
+
+    // f32 to half and back: rounding to nearest even, overflow to Inf and subnormals
+    f32 values[] = {0.0f, 1.0f, 0.5f, -2.0f, 65504.0f, 70000.0f, 1.0f + 1.0f / 2048.0f, 5.9604645e-8f, 0.1f};
+    const u16 expected_half[] = {0x0000, 0x3C00, 0x3800, 0xC000, 0x7BFF, 0x7C00, 0x3C00, 0x0001, 0x2E66};
+    image = make_image(values, 9, 1, {"Y"}, f32_format);
+    auto *half = static_cast<u16 *>(image::convert_image(image, half_format, 1));
+    assert(memcmp(half, expected_half, sizeof(expected_half)) == 0);
+    image = make_image(half, 9, 1, {"Y"}, half_format);
+    auto *restored = static_cast<f32 *>(image::convert_image(image, f32_format, 1));
+    assert(restored[1] == 1.0f && restored[3] == -2.0f && restored[4] == 65504.0f && std::isinf(restored[5]));
+    assert(restored[7] == 5.9604645e-8f && std::fabs(restored[8] - 0.1f) < 1e-4f);
+    acul::release(half);
+    acul::release(restored);
+
+    // u8 to u16 keeps the full range
+    u8 bytes[] = {0, 128, 255};
+    image = make_image(bytes, 3, 1, {"Y"}, u8_format);
+    auto *words = static_cast<u16 *>(image::convert_image(image, u16_format, 1));
+    assert(words[0] == 0 && words[1] == 128 * 257 && words[2] == 65535);
+    acul::release(words);
+}
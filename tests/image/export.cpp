@@ -30,7 +30,7 @@ void test_image_export()
     assert(bmp::save(op / "image_export.bmp", bmpp));
 
     // GIF
-    gif::Params gifp(images);
+    gif::Params gifp(make_views(images));
     assert(gif::save(op / "image_export.gif", gifp));
 
     // HDR
@@ -46,13 +46,50 @@ void test_image_export()
     assert(jpeg::save(op / "image_export.jpg", jpegp));
 
     // OpenEXR
-    openexr::Params openEXRp(images);
+    openexr::Params openEXRp(make_views(images));
     assert(openexr::save(op / "image_export.exr", openEXRp, 2));
 
     // PNG
     png::Params pngp(inp);
     assert(png::save(op / "image_export.png", pngp, 1));
 
+    // PNG to memory: the path only selects the format
+    MemorySink png_sink;
+    png::Params png_memp(inp);
+    png_memp.sink = &png_sink;
+    assert(png::save("image_export.png", png_memp, 1));
+    assert(png_sink.data.size() > 8 && png_sink.data[1] == 'P' && png_sink.data[2] == 'N' && png_sink.data[3] == 'G');
+
+    // JPEG to memory
+    MemorySink jpeg_sink;
+    jpeg::Params jpeg_memp(inp);
+    jpeg_memp.sink = &jpeg_sink;
+    assert(jpeg::save("image_export.jpg", jpeg_memp));
+    assert(jpeg_sink.data.size() > 2 && static_cast<u8>(jpeg_sink.data[0]) == 0xFF &&
+           static_cast<u8>(jpeg_sink.data[1]) == 0xD8);
+
+    // A writer without proxy output reports it instead of writing to the path
+    MemorySink gif_sink;
+    gif::Params gif_memp(make_views(images));
+    gif_memp.sink = &gif_sink;
+    if (gif::save("image_export_sink.gif", gif_memp)) assert(!gif_sink.data.empty());
+    else
+    {
+        assert(gif_memp.error == "Image format cannot be written to a sink: image_export_sink.gif");
+        assert(gif_sink.data.empty());
+    }
+
+    // PNG of a sub-rectangle: the rows keep the stride of the full image
+    ImageView view(inp);
+    png::Params png_cropp(view.crop(inp.width / 4, inp.height / 4, inp.width / 2, inp.height / 2));
+    assert(png::save(op / "image_export_crop.png", png_cropp, 1));
+    auto png_loader = get_importer_by_path(op / "image_export_crop.png");
+    acul::vector<::umbf::Image2D> cropped;
+    assert(png_loader && png_loader->load(op / "image_export_crop.png", cropped));
+    assert(cropped.front().width == inp.width / 2 && cropped.front().height == inp.height / 2);
+    acul::release(cropped.front().pixels);
+    acul::release(png_loader);
+
     // PNM
     pnm::Params pnmp(inp);
     assert(pnm::save(op / "image_export.ppm", pnmp));
@@ -62,7 +99,7 @@ void test_image_export()
     assert(targa::save(op / "image_export.tga", targap));
 
     // TIFF
-    tiff::Params tiffp(images);
+    tiff::Params tiffp(make_views(images));
     assert(tiff::save(op / "image_export.tiff", tiffp, 1));
 
     // WebP
@@ -17,4 +17,26 @@ void test_image_import_tiff()
     umbf::streams::resolver = &meta_resolver;
     acul::path p = env.data_dir;
     import_test_image(p / "image.tiff");
+
+    // 32-bit unsigned samples are requested as float: decoded in the stored type, then converted on their own
+    acul::path uint_path = acul::path(env.output_dir) / "image_uint32.tiff";
+    {
+        const u32 pixels[4] = {0, 0xFFFFFFFFu, 0xFFFFFFFFu, 0};
+        auto out = OIIO::ImageOutput::create(uint_path.str().c_str());
+        assert(out && out->open(uint_path.str().c_str(), OIIO::ImageSpec(2, 2, 1, OIIO::TypeDesc::UINT32)));
+        assert(out->write_image(OIIO::TypeDesc::UINT32, pixels) && out->close());
+    }
+    TIFFLoader loader;
+    ImportStats stats;
+    loader.stats(&stats);
+    acul::vector<umbf::Image2D> images;
+    assert(loader.load(uint_path, images) && images.size() == 1);
+    auto &image = images.front();
+    assert(image.format.type == umbf::ImageFormat::Type::sfloat && image.format.bytes_per_channel == 4);
+    const f32 *values = static_cast<const f32 *>(static_cast<void *>(image.pixels));
+    assert(values[0] == 0.0f && values[1] == 1.0f && values[2] == 1.0f && values[3] == 0.0f);
+    size_t converts = 0;
+    for (auto &event : stats.events)
+        if (event.stage == Stage::convert) ++converts;
+    assert(converts == 1);
 }
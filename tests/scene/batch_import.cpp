@@ -0,0 +1,74 @@
+#include <aecl/scene/batch.hpp>
+#include <algorithm>
+#include <fstream>
+#include "../env.hpp"
+
+static void write_text(const acul::path &path, const char *text)
+{
+    std::ofstream stream(path.str().c_str(), std::ios::binary);
+    stream << text;
+}
+
+void test_batch_import()
+{
+    test_environment env;
+    create_test_environment(env);
+    acul::path dir(env.output_dir);
+    write_text(dir / "shared.mtl", "newmtl red\nKd 1 0 0\n\nnewmtl wood\nKd 1 1 1\nmap_Kd wood.png\n");
+
+    // Every file references the same library, the last one is large enough for the chunk-parallel path
+    acul::vector<acul::string> paths;
+    for (int i = 0; i < 4; ++i)
+    {
+        acul::path path = dir / acul::format("part_%d.obj", i).c_str();
+        std::ofstream stream(path.str().c_str(), std::ios::binary);
+        stream << "mtllib shared.mtl\no quad\nv 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nusemtl red\nf 1 2 3\n"
+               << "usemtl wood\nf 1 3 4\n";
+        if (i == 3)
+            for (int k = 0; k < 4096; ++k) stream << "v " << k << " 0 1\n";
+        paths.push_back(path);
+    }
+    paths.push_back(dir / "missing.obj");
+
+    aecl::scene::BatchImporter importer(paths);
+    importer.small_file_size = 4096;
+    aecl::ProgressToken token;
+    importer.progress(&token);
+    auto result = importer.load();
+    assert(!result.success() && !importer.error().empty());
+    assert(token.progress() == 1.0f);
+
+    auto &entries = importer.entries();
+    assert(entries.size() == 5 && !entries.back().result.success());
+    assert(importer.materials().size() == 2 && importer.textures().size() == 1);
+
+    acul::vector<u64> ids;
+    for (auto &file : importer.materials())
+        for (auto &block : file->blocks)
+            if (block->signature() == umbf::sign_block::material_info)
+            {
+                auto &info = static_cast<umbf::MaterialInfo &>(*block);
+                assert(info.assignments.size() == 4);
+                ids.push_back(info.id);
+            }
+            else if (block->signature() == umbf::sign_block::material)
+            {
+                auto &material = static_cast<umbf::Material &>(*block);
+                assert(!material.albedo.textured || material.albedo.texture_id == 0);
+            }
+    assert(ids.size() == 2);
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        assert(entries[i].result.success() && entries[i].objects.size() == 1);
+        size_t ranges = 0;
+        for (auto &block : entries[i].objects.front().meta)
+            if (block->signature() == umbf::sign_block::material_range)
+            {
+                auto &range = static_cast<umbf::MaterialRange &>(*block);
+                assert(std::find(ids.begin(), ids.end(), range.mat_id) != ids.end());
+                ++ranges;
+            }
+        assert(ranges == 2);
+    }
+}
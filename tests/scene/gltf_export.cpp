@@ -0,0 +1,52 @@
+#include <aecl/scene/gltf/export.hpp>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "../env.hpp"
+#include "common.hpp"
+
+static u32 read_u32(const char *data)
+{
+    u32 value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+void test_gltf_export()
+{
+    test_environment env;
+    create_test_environment(env);
+    using namespace aecl::scene;
+    acul::path path = acul::path(env.output_dir) / "export.glb";
+
+    gltf::Exporter exporter(path);
+    exporter.material_flags = MaterialExportFlags::none;
+    exporter.mesh_flags = MeshExportFlagBits::export_uv | MeshExportFlagBits::export_normals;
+    create_objects(exporter.objects);
+    assert(exporter.save().success());
+    aecl::MemorySink sink;
+    assert(exporter.save(sink).success());
+    exporter.clear();
+
+    std::ifstream stream(path.str().c_str(), std::ios::binary);
+    std::stringstream ss;
+    ss << stream.rdbuf();
+    std::string file = ss.str();
+    assert(file == std::string(sink.data.data(), sink.data.size()));
+
+    // Header, JSON chunk, binary chunk
+    const char *data = file.data();
+    assert(file.size() > 28 && memcmp(data, "glTF", 4) == 0);
+    assert(read_u32(data + 4) == 2 && read_u32(data + 8) == file.size());
+    u32 json_size = read_u32(data + 12);
+    assert(json_size % 4 == 0 && memcmp(data + 16, "JSON", 4) == 0);
+    std::string json(data + 20, json_size);
+    assert(json.find("\"POSITION\"") != std::string::npos && json.find("\"TEXCOORD_0\"") != std::string::npos);
+    assert(json.find("\"min\":[-100,-100,-100]") != std::string::npos);
+    const char *bin = data + 20 + json_size;
+    assert(memcmp(bin + 4, "BIN\0", 4) == 0 && 28 + json_size + read_u32(bin) == file.size());
+
+    // At least 24 vertices with position, normal and uv, and 36 indices
+    assert(read_u32(bin) >= 24 * 8 * sizeof(f32) + 36 * sizeof(u32));
+}
@@ -0,0 +1,134 @@
+#include <aecl/scene/gltf/export.hpp>
+#include <aecl/scene/gltf/import.hpp>
+#include <cmath>
+#include <fstream>
+#include <umbf/umbf.hpp>
+#include "../env.hpp"
+#include "common.hpp"
+
+// One triangle with interleaved positions and normals in an external buffer, placed by three nodes
+static void write_triangle(const acul::path &dir, u32 index_component, int index_accessor)
+{
+    {
+        std::ofstream stream((dir / "tri.bin").str().c_str(), std::ios::binary);
+        const f32 vertices[18] = {0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 1};
+        const u16 indices[6] = {0, 1, 2, 0, 1, 5};
+        stream.write(reinterpret_cast<const char *>(vertices), sizeof(vertices));
+        stream.write(reinterpret_cast<const char *>(indices), sizeof(indices));
+    }
+    std::ofstream stream((dir / "tri.gltf").str().c_str());
+    stream << R"({"asset": {"version": "2.0"},
+        "buffers": [{"uri": "tri.bin", "byteLength": 84}],
+        "bufferViews": [{"buffer": 0, "byteOffset": 0, "byteLength": 72, "byteStride": 24},
+                        {"buffer": 0, "byteOffset": 72, "byteLength": 6},
+                        {"buffer": 0, "byteOffset": 78, "byteLength": 6}],
+        "accessors": [{"bufferView": 0, "componentType": 5126, "type": "VEC3", "count": 3},
+                      {"bufferView": 0, "byteOffset": 12, "componentType": 5126, "type": "VEC3", "count": 3},
+                      {"bufferView": 1, "componentType": )"
+           << index_component << R"(, "type": "SCALAR", "count": 3},
+                      {"bufferView": 2, "componentType": 5123, "type": "SCALAR", "count": 3}],
+        "meshes": [{"primitives": [{"attributes": {"POSITION": 0, "NORMAL": 1}, "indices": )"
+           << index_accessor << R"(}]},
+                   {"primitives": [{"attributes": {"POSITION": 0}}]}],
+        "nodes": [{"name": "moved", "mesh": 0, "translation": [10, 0, 0]},
+                  {"name": "mirrored", "mesh": 1, "scale": [-1, 1, 1]},
+                  {"name": "flat", "mesh": 0, "scale": [0, 0, 0]}]})";
+}
+
+static const umbf::mesh::Model &get_model(const umbf::Object &object)
+{
+    return static_cast<const umbf::mesh::Mesh &>(*object.meta.front()).model;
+}
+
+static void test_gltf_external()
+{
+    using namespace aecl::scene;
+    test_environment env;
+    create_test_environment(env);
+    acul::path dir(env.output_dir);
+    const amal::vec3 up(0.0f, 0.0f, 1.0f);
+
+    write_triangle(dir, 5123, 2);
+    gltf::Importer importer(dir / "tri.gltf");
+    assert(importer.load().success());
+    auto &objects = importer.objects();
+    assert(objects.size() == 3);
+
+    // Indexed primitive read through a strided view, moved by the node translation
+    auto &moved = get_model(objects[0]);
+    assert(objects[0].name == "moved");
+    assert(moved.vertices.size() == 3 && moved.faces.size() == 1);
+    assert(moved.vertices[0].pos == amal::vec3(10, 0, 0) && moved.vertices[1].pos == amal::vec3(11, 0, 0) &&
+           moved.vertices[2].pos == amal::vec3(10, 1, 0));
+    for (auto &vertex : moved.vertices) assert(vertex.normal == up);
+    assert(moved.faces.front().normal == up);
+
+    // Non-indexed primitive with computed normals, mirrored on x: the winding is reversed to keep facing +z
+    auto &mirrored = get_model(objects[1]);
+    assert(objects[1].name == "mirrored");
+    assert(mirrored.vertices[1].pos == amal::vec3(-1, 0, 0));
+    assert(mirrored.indices.size() == 3 && mirrored.indices[0] == 0 && mirrored.indices[1] == 2 &&
+           mirrored.indices[2] == 1);
+    for (auto &vertex : mirrored.vertices) assert(vertex.normal == up);
+    assert(mirrored.faces.front().normal == up);
+
+    // A zero scale collapses the triangle, its normals stay finite
+    auto &flat = get_model(objects[2]);
+    for (auto &vertex : flat.vertices) assert(vertex.normal == amal::vec3(0.0f));
+    assert(!std::isnan(flat.faces.front().normal.x));
+    importer.clear();
+
+    // Signed index accessors and out of range indices fail the load
+    write_triangle(dir, 5122, 2);
+    gltf::Importer signed_indices(dir / "tri.gltf");
+    assert(!signed_indices.load().success());
+    assert(signed_indices.objects().empty());
+
+    write_triangle(dir, 5123, 3);
+    gltf::Importer out_of_range(dir / "tri.gltf");
+    assert(!out_of_range.load().success());
+    assert(out_of_range.error() == "Primitive index out of range");
+}
+
+void test_gltf_import()
+{
+    test_environment env;
+    create_test_environment(env);
+    using namespace aecl::scene;
+    acul::path path = acul::path(env.output_dir) / "import.glb";
+
+    acul::vector<umbf::Object> source;
+    create_objects(source);
+    {
+        gltf::Exporter exporter(path);
+        exporter.material_flags = MaterialExportFlags::none;
+        exporter.mesh_flags = MeshExportFlagBits::export_uv | MeshExportFlagBits::export_normals;
+        exporter.objects = source;
+        assert(exporter.save().success());
+    }
+
+    gltf::Importer importer(path);
+    auto state = importer.load();
+    assert(state.success());
+    assert(importer.objects().size() == 1);
+
+    auto &src = static_cast<umbf::mesh::Mesh &>(*source.front().meta.front()).model;
+    auto &object = importer.objects().front();
+    assert(object.name == source.front().name);
+    auto &model = static_cast<umbf::mesh::Mesh &>(*object.meta.front()).model;
+    assert(model.vertices.size() == src.vertices.size());
+    assert(model.faces.size() == src.indices.size() / 3);
+    assert(model.indices.size() == src.indices.size());
+    for (size_t i = 0; i < model.vertices.size(); ++i)
+    {
+        assert(model.vertices[i].pos == src.vertices[i].pos);
+        assert(model.vertices[i].uv == src.vertices[i].uv);
+    }
+    assert(model.aabb.min == amal::vec3(-100.0f) && model.aabb.max == amal::vec3(100.0f));
+
+    // Unique corner positions of the cube
+    assert(model.group_count == 8);
+    importer.clear();
+
+    test_gltf_external();
+}
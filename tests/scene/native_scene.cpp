@@ -0,0 +1,48 @@
+#include <aecl/scene/native/export.hpp>
+#include <aecl/scene/native/import.hpp>
+#include "../env.hpp"
+#include "common.hpp"
+
+void test_native_scene()
+{
+    test_environment env;
+    create_test_environment(env);
+    umbf::streams::HashResolver meta_resolver;
+    meta_resolver.streams = {
+        {umbf::sign_block::scene, &umbf::streams::scene},
+        {umbf::sign_block::mesh, &umbf::streams::mesh},
+        {umbf::sign_block::material, &umbf::streams::material},
+        {umbf::sign_block::material_info, &umbf::streams::material_info},
+        {umbf::sign_block::material_range, &umbf::streams::material_range},
+        {umbf::sign_block::target, &umbf::streams::target},
+    };
+    umbf::streams::resolver = &meta_resolver;
+
+    using namespace aecl::scene;
+    acul::path path = acul::path(env.output_dir) / "scene.umsc";
+    native::Exporter exporter(path);
+    exporter.material_flags = MaterialExportFlags::texture_origin;
+    create_objects(exporter.objects);
+    auto range = acul::make_shared<umbf::MaterialRange>();
+    range->mat_id = 0;
+    exporter.objects.front().meta.push_back(range);
+    create_materials(exporter.materials);
+    acul::string texture;
+    create_default_texture(texture, env.data_dir);
+    exporter.textures.push_back(texture);
+    assert(exporter.save().success());
+
+    native::Importer importer(path);
+    assert(importer.load().success());
+    assert(importer.objects().size() == 1);
+    auto &object = importer.objects().front();
+    assert(object.name == "cube" && object.meta.size() == 2);
+    auto &src = static_cast<umbf::mesh::Mesh &>(*exporter.objects.front().meta.front()).model;
+    auto &model = static_cast<umbf::mesh::Mesh &>(*object.meta.front()).model;
+    assert(model.vertices.size() == src.vertices.size() && model.faces.size() == src.faces.size());
+    assert(model.indices == src.indices);
+    assert(importer.materials().size() == exporter.materials.size());
+    assert(importer.textures().size() == 1 && importer.textures().front()->url == texture);
+    exporter.clear();
+    importer.clear();
+}
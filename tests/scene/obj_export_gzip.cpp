@@ -0,0 +1,52 @@
+#include <aecl/scene/obj/export.hpp>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <zlib.h>
+#include "../env.hpp"
+#include "common.hpp"
+
+static std::string export_text(const acul::path &path, aecl::scene::obj::ObjCompression compression)
+{
+    using namespace aecl::scene;
+    obj::Exporter exporter(path);
+    exporter.material_flags = MaterialExportFlags::texture_none;
+    exporter.mesh_flags = MeshExportFlagBits::export_uv | MeshExportFlagBits::export_normals;
+    exporter.compression = compression;
+    create_objects(exporter.objects);
+    auto state = exporter.save();
+    exporter.clear();
+    assert(state.success());
+
+    std::string text;
+    gzFile file = gzopen(path.str().c_str(), "rb");
+    assert(file);
+    char buffer[4096];
+    int size;
+    while ((size = gzread(file, buffer, sizeof(buffer))) > 0) text.append(buffer, size);
+    gzclose(file);
+    return text;
+}
+
+void test_obj_export_gzip()
+{
+    test_environment env;
+    create_test_environment(env);
+    using namespace aecl::scene;
+    acul::path output(env.output_dir);
+
+    // gzread passes uncompressed files through, so both exports read back the same way
+    auto plain = export_text(output / "export_plain.obj", obj::ObjCompression::none);
+    auto packed = export_text(output / "export_packed.obj.gz", obj::ObjCompression::gzip);
+    assert(!plain.empty());
+    assert(packed.find("mtllib ./export_packed.mtl") != std::string::npos);
+    auto body = [](const std::string &text) { return text.substr(text.find('\n', text.find("mtllib"))); };
+    assert(body(plain) == body(packed));
+
+    std::ifstream raw((output / "export_packed.obj.gz").str().c_str(), std::ios::binary);
+    unsigned char magic[2] = {};
+    raw.read(reinterpret_cast<char *>(magic), 2);
+    assert(magic[0] == 0x1f && magic[1] == 0x8b);
+    std::ifstream mtl((output / "export_packed.mtl").str().c_str());
+    assert(mtl.good());
+}
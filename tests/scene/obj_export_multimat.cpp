@@ -1,4 +1,9 @@
 #include <aecl/scene/obj/export.hpp>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
 #include <umbf/version.h>
 #include "../env.hpp"
 #include "common.hpp"
@@ -76,4 +81,42 @@ void test_obj_export_multimat()
     auto state = exporter.save();
     exporter.clear();
     assert(state.success());
+
+    // Two materials with the same name and different colors: both are written, the second under a suffixed name
+    obj::Exporter shared(acul::path(env.output_dir) / "export_shared.obj");
+    shared.material_flags = MaterialExportFlags::texture_none;
+    create_objects(shared.objects);
+    create_multi_materials(shared.materials, shared.objects.front().id, materials_ids);
+    for (auto &material : shared.materials)
+        static_cast<umbf::MaterialInfo &>(*material.blocks.back()).name = "ecl:test:mat_shared";
+    for (int m = 0; m < 2; ++m)
+    {
+        auto range = acul::make_shared<umbf::MaterialRange>();
+        range->mat_id = materials_ids[m];
+        range->faces = {static_cast<u32>(2 + m * 2), static_cast<u32>(3 + m * 2)};
+        shared.objects.front().meta.push_back(range);
+    }
+    assert(shared.save().success());
+    shared.clear();
+
+    std::map<std::string, f32> red;
+    std::string name, line;
+    std::ifstream mtl((acul::path(env.output_dir) / "export_shared.mtl").str().c_str());
+    while (std::getline(mtl, line))
+    {
+        std::istringstream tokens(line);
+        std::string token;
+        tokens >> token;
+        if (token == "newmtl") tokens >> name;
+        else if (token == "Kd") tokens >> red[name];
+    }
+    red.erase("default");
+    assert(red.size() == 2);
+    assert(red["ecl:test:mat_shared"] == 0.5f && red["ecl:test:mat_shared_1"] == 1.0f);
+
+    std::set<std::string> used;
+    std::ifstream obj((acul::path(env.output_dir) / "export_shared.obj").str().c_str());
+    while (std::getline(obj, line))
+        if (line.rfind("usemtl ", 0) == 0 && line.substr(7) != "default") used.insert(line.substr(7));
+    assert(used == std::set<std::string>({"ecl:test:mat_shared", "ecl:test:mat_shared_1"}));
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include <aecl/scene/obj/export.hpp>
+#include <aecl/scene/obj/import.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include "../env.hpp"
+#include "common.hpp"
+
+void test_obj_export_objects()
+{
+    test_environment env;
+    create_test_environment(env);
+    using namespace aecl::scene;
+    acul::path path = acul::path(env.output_dir) / "export_objects.obj";
+    obj::Exporter exporter(path);
+    exporter.material_flags = MaterialExportFlags::none;
+    exporter.mesh_flags = MeshExportFlagBits::export_uv | MeshExportFlagBits::export_normals;
+    exporter.obj_flags = obj::ObjExportFlagBits::object_policy_groups;
+    for (int i = 0; i < 3; ++i)
+    {
+        create_objects(exporter.objects);
+        exporter.objects.back().id = i + 1;
+        exporter.objects.back().name = acul::format("cube%d", i);
+    }
+    auto state = exporter.save();
+    exporter.clear();
+    assert(state.success());
+
+    // Face references of the n-th cube point into its own v/vt/vn block
+    std::ifstream stream(path.str().c_str());
+    std::string line;
+    long object = -1;
+    size_t objects = 0;
+    while (std::getline(stream, line))
+    {
+        if (line.rfind("g ", 0) == 0)
+        {
+            ++object;
+            ++objects;
+        }
+        else if (line.rfind("f ", 0) == 0)
+        {
+            const char *it = line.c_str() + 1;
+            while (*it)
+            {
+                char *end;
+                long v = std::strtol(it + 1, &end, 10);
+                long t = std::strtol(end + 1, &end, 10);
+                long n = std::strtol(end + 1, &end, 10);
+                assert(v > object * 8 && v <= (object + 1) * 8);
+                assert(t > object * 4 && t <= (object + 1) * 4);
+                assert(n > object * 6 && n <= (object + 1) * 6);
+                it = end;
+            }
+        }
+    }
+    assert(objects == 3);
+
+    obj::Importer importer(path);
+    state = importer.load();
+    assert(state.success());
+    assert(importer.objects().size() == 3);
+    importer.clear();
+}
@@ -0,0 +1,135 @@
+#include <aecl/scene/obj/export.hpp>
+#include <fstream>
+#include <oneapi/tbb/task_arena.h>
+#include <sstream>
+#include <string>
+#include "../env.hpp"
+#include "common.hpp"
+
+// Repeat the cube faces so face formatting spans many chunks
+static void create_repeated_cube(acul::vector<umbf::Object> &objects, size_t copies)
+{
+    create_objects(objects);
+    auto mesh = acul::static_pointer_cast<umbf::mesh::Mesh>(objects.front().meta.front());
+    auto &model = mesh->model;
+    auto faces = model.faces;
+    auto indices = model.indices;
+    for (size_t c = 1; c < copies; ++c)
+    {
+        for (auto face : faces)
+        {
+            face.first_vertex += c * indices.size();
+            model.faces.push_back(face);
+        }
+        model.indices.insert(model.indices.end(), indices.begin(), indices.end());
+    }
+}
+
+// Grid with a distinct position, uv and normal per vertex, so its v/vt/vn lines span many chunks
+static void create_grid(acul::vector<umbf::Object> &objects, u32 cells)
+{
+    objects.emplace_back();
+    objects.back().name = "grid";
+    auto mesh = acul::make_shared<umbf::mesh::Mesh>();
+    auto &model = mesh->model;
+    const u32 side = cells + 1;
+    model.vertices.resize(side * side);
+    for (u32 z = 0; z < side; ++z)
+        for (u32 x = 0; x < side; ++x)
+        {
+            const f32 u = static_cast<f32>(x) / cells, v = static_cast<f32>(z) / cells;
+            model.vertices[z * side + x] = {{u, 0.0f, v}, {u, v}, amal::normalize(amal::vec3{u, 1.0f, v})};
+        }
+    for (u32 z = 0; z < cells; ++z)
+        for (u32 x = 0; x < cells; ++x)
+        {
+            const u32 a = z * side + x, b = a + 1, c = a + side + 1, d = a + side;
+            umbf::mesh::Face face;
+            face.vertices = {{a, a}, {b, b}, {c, c}, {d, d}};
+            face.normal = {0, 1, 0};
+            face.first_vertex = static_cast<u32>(model.indices.size());
+            face.count = 6;
+            model.faces.push_back(face);
+            model.indices.insert(model.indices.end(), {a, b, c, a, c, d});
+        }
+    model.group_count = side * side;
+    model.aabb = {{0, 0, 0}, {1, 0, 1}};
+    objects.back().meta.push_back(mesh);
+}
+
+static std::string export_text(const acul::path &path, int concurrency, aecl::scene::MeshExportFlags flags)
+{
+    using namespace aecl::scene;
+    obj::Exporter exporter(path);
+    exporter.material_flags = MaterialExportFlags::none;
+    exporter.mesh_flags = flags;
+    create_repeated_cube(exporter.objects, 4000);
+    oneapi::tbb::task_arena arena(concurrency);
+    auto state = arena.execute([&] { return exporter.save(); });
+    exporter.clear();
+    assert(state.success());
+
+    std::ifstream stream(path.str().c_str(), std::ios::binary);
+    std::stringstream text;
+    text << stream.rdbuf();
+    return text.str();
+}
+
+void test_obj_export_ordered()
+{
+    test_environment env;
+    create_test_environment(env);
+    using namespace aecl::scene;
+    acul::path path = acul::path(env.output_dir) / "export_ordered.obj";
+
+    // Every emit kernel: uv, normals, mirrored winding, triangulated
+    const u32 options[] = {MeshExportFlagBits::export_uv, MeshExportFlagBits::export_normals,
+                           MeshExportFlagBits::transform_reverse_x, MeshExportFlagBits::export_triangulated};
+    for (u32 mask = 0; mask < 16; ++mask)
+    {
+        u32 bits = 0;
+        for (u32 i = 0; i < 4; ++i)
+            if (mask & (1u << i)) bits |= options[i];
+        MeshExportFlags flags(bits);
+        auto serial = export_text(path, 1, flags);
+        auto parallel = export_text(path, oneapi::tbb::task_arena::automatic, flags);
+        assert(!serial.empty());
+        assert(serial == parallel);
+    }
+    // The vertex lines of a large mesh are formatted in ranges, in the same order as a single block
+    const u32 cells = 150, vertex_count = (cells + 1) * (cells + 1);
+    MeshExportFlags flags(MeshExportFlagBits::export_uv | MeshExportFlagBits::export_normals);
+    std::string texts[2];
+    for (int run = 0; run < 2; ++run)
+    {
+        obj::Exporter exporter(path);
+        exporter.material_flags = MaterialExportFlags::none;
+        exporter.obj_flags = obj::ObjExportFlagBits::object_policy_objects;
+        exporter.mesh_flags = flags;
+        create_grid(exporter.objects, cells);
+        oneapi::tbb::task_arena arena(run == 0 ? 1 : oneapi::tbb::task_arena::automatic);
+        assert(arena.execute([&] { return exporter.save(); }).success());
+        exporter.clear();
+        std::ifstream stream(path.str().c_str(), std::ios::binary);
+        std::stringstream text;
+        text << stream.rdbuf();
+        texts[run] = text.str();
+    }
+    assert(texts[0] == texts[1]);
+
+    // One o line, then all v, vt and vn lines in blocks, then the faces
+    std::istringstream lines(texts[0]);
+    std::string line;
+    const char *order[] = {"o", "v", "vt", "vn", "f"};
+    size_t counts[5] = {}, stage = 0;
+    while (std::getline(lines, line))
+    {
+        const std::string token = line.substr(0, line.find(' '));
+        if (token == "#" || token == "mtllib" || token == "usemtl") continue;
+        while (stage < 5 && token != order[stage]) ++stage;
+        assert(stage < 5);
+        ++counts[stage];
+    }
+    assert(counts[0] == 1 && counts[1] == vertex_count && counts[2] == vertex_count && counts[3] == vertex_count);
+    assert(counts[4] == cells * cells);
+}
@@ -0,0 +1,44 @@
+#include <aecl/scene/obj/export.hpp>
+#include <aecl/scene/obj/import.hpp>
+#include <fstream>
+#include <string>
+#include "../env.hpp"
+#include "common.hpp"
+
+void test_obj_export_precision()
+{
+    test_environment env;
+    create_test_environment(env);
+    using namespace aecl::scene;
+    acul::path path = acul::path(env.output_dir) / "export_precision.obj";
+    obj::Exporter exporter(path);
+    exporter.material_flags = MaterialExportFlags::none;
+    exporter.mesh_flags = MeshExportFlagBits::export_uv | MeshExportFlagBits::export_normals;
+    exporter.float_precision = 3;
+    create_objects(exporter.objects);
+    auto state = exporter.save();
+    exporter.clear();
+    assert(state.success());
+
+    // Every coordinate is written with exactly three fractional digits
+    std::ifstream stream(path.str().c_str());
+    std::string line;
+    size_t vertices = 0;
+    while (std::getline(stream, line))
+    {
+        if (line.rfind("v ", 0) != 0) continue;
+        ++vertices;
+        size_t dot = line.find('.');
+        assert(dot != std::string::npos);
+        size_t end = line.find(' ', dot);
+        if (end == std::string::npos) end = line.size();
+        assert(end - dot - 1 == 3);
+    }
+    assert(vertices > 0);
+
+    obj::Importer importer(path);
+    state = importer.load();
+    assert(state.success());
+    assert(!importer.objects().empty());
+    importer.clear();
+}
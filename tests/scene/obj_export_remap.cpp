@@ -0,0 +1,77 @@
+#include <aecl/scene/obj/export.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <string>
+#include "../env.hpp"
+#include "common.hpp"
+
+void test_obj_export_remap()
+{
+    test_environment env;
+    create_test_environment(env);
+    using namespace aecl::scene;
+    acul::path path = acul::path(env.output_dir) / "export_remap.obj";
+    obj::Exporter exporter(path);
+    exporter.material_flags = MaterialExportFlags::none;
+    exporter.mesh_flags = MeshExportFlagBits::export_uv | MeshExportFlagBits::export_normals;
+    create_objects(exporter.objects);
+    auto state = exporter.save();
+    exporter.clear();
+    assert(state.success());
+
+    // The cube has 4 distinct uvs and 6 distinct normals, and every face reference stays in range
+    std::ifstream stream(path.str().c_str());
+    std::string line;
+    size_t vt = 0, vn = 0, faces = 0;
+    while (std::getline(stream, line))
+    {
+        if (line.rfind("vt ", 0) == 0) ++vt;
+        else if (line.rfind("vn ", 0) == 0) ++vn;
+        else if (line.rfind("f ", 0) == 0)
+        {
+            ++faces;
+            const char *it = line.c_str() + 1;
+            while (*it)
+            {
+                char *end;
+                long v = std::strtol(it + 1, &end, 10);
+                long t = std::strtol(end + 1, &end, 10);
+                long n = std::strtol(end + 1, &end, 10);
+                assert(v >= 1 && v <= 8);
+                assert(t >= 1 && t <= 4);
+                assert(n >= 1 && n <= 6);
+                it = end;
+            }
+        }
+    }
+    assert(vt == 4 && vn == 6 && faces == 6);
+
+    // A degenerate top face gets NaN normals from the importers, -0 normals match their +0 counterparts
+    path = acul::path(env.output_dir) / "export_remap_degenerate.obj";
+    obj::Exporter degenerate(path);
+    degenerate.material_flags = MaterialExportFlags::none;
+    degenerate.mesh_flags = MeshExportFlagBits::export_normals;
+    create_objects(degenerate.objects);
+    auto &model = acul::static_pointer_cast<umbf::mesh::Mesh>(degenerate.objects.front().meta.front())->model;
+    const f32 nan = std::numeric_limits<f32>::quiet_NaN();
+    for (int i = 16; i < 20; ++i)
+    {
+        model.vertices[i].pos = model.vertices[16].pos;
+        model.vertices[i].normal = amal::vec3(nan, i == 17 ? -nan : nan, nan);
+    }
+    model.vertices[20].normal = amal::vec3(-0.0f, -1.0f, -0.0f);
+    state = degenerate.save();
+    degenerate.clear();
+    assert(state.success());
+
+    std::ifstream degenerate_stream(path.str().c_str());
+    vn = 0;
+    faces = 0;
+    while (std::getline(degenerate_stream, line))
+    {
+        if (line.rfind("vn ", 0) == 0) ++vn;
+        else if (line.rfind("f ", 0) == 0) ++faces;
+    }
+    assert(vn == 6 && faces == 6);
+}
@@ -0,0 +1,49 @@
+#include <aecl/scene/obj/export.hpp>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "../env.hpp"
+#include "common.hpp"
+
+static std::string read_file(const acul::path &path)
+{
+    std::ifstream stream(path.str().c_str(), std::ios::binary);
+    assert(stream.good());
+    std::stringstream ss;
+    ss << stream.rdbuf();
+    return ss.str();
+}
+
+static void setup(aecl::scene::obj::Exporter &exporter)
+{
+    using namespace aecl::scene;
+    exporter.material_flags = MaterialExportFlags::texture_none;
+    exporter.mesh_flags = MeshExportFlagBits::export_uv | MeshExportFlagBits::export_normals;
+    create_objects(exporter.objects);
+}
+
+void test_obj_export_sink()
+{
+    test_environment env;
+    create_test_environment(env);
+    using namespace aecl::scene;
+    acul::path path = acul::path(env.output_dir) / "export_sink.obj";
+
+    obj::Exporter file_exporter(path);
+    setup(file_exporter);
+    assert(file_exporter.save().success());
+    file_exporter.clear();
+
+    // The sink export names the same mtllib, so both outputs must match byte for byte
+    aecl::MemorySink obj_sink, mtl_sink;
+    obj::Exporter sink_exporter(path);
+    setup(sink_exporter);
+    assert(sink_exporter.save(obj_sink, &mtl_sink).success());
+    sink_exporter.clear();
+
+    std::string obj_text(obj_sink.data.data(), obj_sink.data.size());
+    std::string mtl_text(mtl_sink.data.data(), mtl_sink.data.size());
+    assert(obj_text == read_file(path));
+    assert(mtl_text == read_file(acul::path(env.output_dir) / "export_sink.mtl"));
+    assert(mtl_text.find("newmtl") != std::string::npos);
+}
@@ -0,0 +1,81 @@
+#include <aecl/scene/obj/export.hpp>
+#include <fstream>
+#include <string>
+#include <umbf/version.h>
+#include "../env.hpp"
+#include "common.hpp"
+
+static void add_material(acul::vector<umbf::File> &materials, u64 id, const char *name)
+{
+    auto mat = acul::make_shared<umbf::Material>();
+    mat->albedo.rgb = amal::vec3(1.0f, 0.5f, 0.0f);
+    mat->albedo.textured = false;
+    mat->albedo.texture_id = -1;
+    auto meta = acul::make_shared<umbf::MaterialInfo>();
+    meta->name = name;
+    meta->id = id;
+    materials.emplace_back();
+    auto &file = materials.back();
+    file.header.vendor_sign = UMBF_VENDOR_ID;
+    file.header.vendor_version = UMBF_VERSION;
+    file.header.spec_version = UMBF_VERSION;
+    file.header.type_sign = umbf::sign_block::format::material;
+    file.blocks.push_back(mat);
+    file.blocks.push_back(meta);
+}
+
+static size_t count_lines(const acul::string &path, const char *prefix)
+{
+    std::ifstream stream(path.c_str());
+    std::string line;
+    size_t count = 0;
+    while (std::getline(stream, line)) count += line.rfind(prefix, 0) == 0;
+    return count;
+}
+
+void test_obj_export_split()
+{
+    test_environment env;
+    create_test_environment(env);
+    using namespace aecl::scene;
+    obj::Exporter exporter(acul::path(env.output_dir) / "split.obj");
+    exporter.split_objects = true;
+    exporter.material_flags = MaterialExportFlags::texture_none;
+    exporter.mesh_flags = MeshExportFlagBits::export_uv | MeshExportFlagBits::export_normals;
+    exporter.obj_flags = obj::ObjExportFlagBits::object_policy_objects;
+
+    // Two materials share a name, the third object has no material range and uses the default one
+    const char *names[] = {"cube", "cube", "a/b"};
+    for (int i = 0; i < 3; ++i)
+    {
+        acul::vector<umbf::Object> objects;
+        create_objects(objects);
+        exporter.objects.push_back(objects.front());
+        auto &object = exporter.objects.back();
+        object.id = i + 1;
+        object.name = names[i];
+        if (i == 2) continue;
+        auto range = acul::make_shared<umbf::MaterialRange>();
+        range->mat_id = 100 + i;
+        object.meta.push_back(range);
+        add_material(exporter.materials, range->mat_id, "shared");
+    }
+    auto state = exporter.save();
+    assert(state.success() && state.code == 0);
+
+    auto &paths = exporter.split_paths();
+    assert(paths.size() == 3);
+    const char *files[] = {"cube.obj", "cube_1.obj", "a_b.obj"};
+    for (size_t i = 0; i < 3; ++i)
+    {
+        assert(paths[i] == (acul::path(env.output_dir) / files[i]).str());
+        assert(count_lines(paths[i], "mtllib ./split.mtl") == 1);
+        assert(count_lines(paths[i], "o ") == 1);
+        assert(count_lines(paths[i], "v ") == 8 && count_lines(paths[i], "f ") == 6);
+        assert(count_lines(paths[i], i == 2 ? "usemtl default" : "usemtl shared") == 1);
+    }
+
+    const acul::string mtl_path = (acul::path(env.output_dir) / "split.mtl").str();
+    assert(count_lines(mtl_path, "newmtl shared") == 1);
+    assert(count_lines(mtl_path, "newmtl default") == 1);
+}
@@ -0,0 +1,103 @@
+#include <aecl/scene/obj/export.hpp>
+#include <fstream>
+#include <string>
+#include <umbf/version.h>
+#include "../env.hpp"
+#include "common.hpp"
+
+static void create_textured_material(umbf::File &file, const char *name, u64 id, u64 object_id,
+                                     u32 texture_id = 0)
+{
+    auto mat = acul::make_shared<umbf::Material>();
+    mat->albedo.textured = true;
+    mat->albedo.texture_id = texture_id;
+    auto meta = acul::make_shared<umbf::MaterialInfo>();
+    meta->name = name;
+    meta->id = id;
+    meta->assignments.push_back(object_id);
+    file.header.vendor_sign = UMBF_VENDOR_ID;
+    file.header.vendor_version = UMBF_VERSION;
+    file.header.spec_version = UMBF_VERSION;
+    file.header.type_sign = umbf::sign_block::format::material;
+    file.blocks.push_back(mat);
+    file.blocks.push_back(meta);
+}
+
+void test_obj_export_texture_shared()
+{
+    using namespace aecl::scene;
+    test_environment env;
+    create_test_environment(env);
+    acul::path path = acul::path(env.output_dir) / "export_shared.obj";
+    obj::Exporter exporter(path);
+    exporter.mesh_flags = MeshExportFlagBits::export_normals | MeshExportFlagBits::export_uv;
+    exporter.material_flags = MaterialExportFlags::texture_copy;
+
+    create_objects(exporter.objects);
+    auto &object = exporter.objects.front();
+    object.id = 1;
+    exporter.materials.resize(2);
+    create_textured_material(exporter.materials[0], "ecl:test:shared_a", 10, object.id);
+    create_textured_material(exporter.materials[1], "ecl:test:shared_b", 11, object.id);
+    auto first = acul::make_shared<umbf::MaterialRange>();
+    first->mat_id = 10;
+    first->faces = {0, 1, 2};
+    auto second = acul::make_shared<umbf::MaterialRange>();
+    second->mat_id = 11;
+    second->faces = {3, 4, 5};
+    object.meta.push_back(first);
+    object.meta.push_back(second);
+
+    acul::string texture;
+    create_default_texture(texture, env.data_dir);
+    exporter.textures.push_back(texture);
+
+    auto state = exporter.save();
+    exporter.clear();
+    assert(state.success());
+
+    // Both materials reference the single copy
+    std::ifstream mtl((acul::path(env.output_dir) / "export_shared.mtl").str().c_str());
+    std::string line;
+    size_t maps = 0;
+    while (std::getline(mtl, line))
+        if (line.rfind("map_Kd ", 0) == 0)
+        {
+            assert(line == "map_Kd ./tex/devCheck.jpg");
+            ++maps;
+        }
+    assert(maps == 2);
+    std::ifstream copy((acul::path(env.output_dir) / "tex" / "devCheck.jpg").str().c_str());
+    assert(copy.good());
+
+    // Sources sharing a file name get distinct copies in texture order, also when a renamed copy would take the
+    // name of another source
+    obj::Exporter names_exporter(acul::path(env.output_dir) / "export_names.obj");
+    names_exporter.material_flags = MaterialExportFlags::texture_copy;
+    create_objects(names_exporter.objects);
+    names_exporter.objects.front().id = 1;
+    names_exporter.textures.push_back(texture);
+    for (const char *name : {"devCheck.jpg", "devCheck_1.jpg"})
+    {
+        acul::string source = (acul::path(env.output_dir) / name).str();
+        std::ofstream(source.c_str()) << name;
+        names_exporter.textures.push_back(source);
+    }
+    names_exporter.materials.resize(3);
+    const char *material_names[] = {"ecl:test:names_a", "ecl:test:names_b", "ecl:test:names_c"};
+    for (u32 i = 0; i < 3; ++i)
+        create_textured_material(names_exporter.materials[i], material_names[i], 20 + i, 1, i);
+    assert(names_exporter.save().success());
+    names_exporter.clear();
+
+    std::ifstream names_mtl((acul::path(env.output_dir) / "export_names.mtl").str().c_str());
+    std::string maps_found;
+    while (std::getline(names_mtl, line))
+        if (line.rfind("map_Kd ", 0) == 0) maps_found += line.substr(7) + ";";
+    for (const char *ref : {"./tex/devCheck.jpg;", "./tex/devCheck_1.jpg;", "./tex/devCheck_1_1.jpg;"})
+        assert(maps_found.find(ref) != std::string::npos);
+    std::ifstream renamed((acul::path(env.output_dir) / "tex" / "devCheck_1_1.jpg").str().c_str());
+    std::string content;
+    std::getline(renamed, content);
+    assert(content == "devCheck_1.jpg");
+}
@@ -0,0 +1,48 @@
+#include <aecl/scene/obj/export.hpp>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "../env.hpp"
+#include "common.hpp"
+
+static std::string read_text(const acul::path &path)
+{
+    std::ifstream stream(path.str().c_str(), std::ios::binary);
+    std::stringstream text;
+    text << stream.rdbuf();
+    return text.str();
+}
+
+void test_obj_export_transform()
+{
+    test_environment env;
+    create_test_environment(env);
+    using namespace aecl::scene;
+    acul::path path = acul::path(env.output_dir) / "export_transform.obj";
+    obj::Exporter exporter(path);
+    exporter.material_flags = MaterialExportFlags::none;
+    exporter.mesh_flags = MeshExportFlagBits::export_uv | MeshExportFlagBits::export_normals |
+                          MeshExportFlagBits::transform_reverse_y | MeshExportFlagBits::transform_swap_xz;
+    create_objects(exporter.objects);
+    auto mesh = acul::static_pointer_cast<umbf::mesh::Mesh>(exporter.objects.front().meta.front());
+    auto vertices = mesh->model.vertices;
+    auto first_face = mesh->model.faces.front().vertices;
+
+    // Exporting twice gives the same file and leaves the source mesh untouched
+    assert(exporter.save().success());
+    auto first = read_text(path);
+    assert(exporter.save().success());
+    auto second = read_text(path);
+    assert(!first.empty() && first == second);
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        assert(mesh->model.vertices[i].pos == vertices[i].pos);
+        assert(mesh->model.vertices[i].normal == vertices[i].normal);
+    }
+    auto &face = mesh->model.faces.front().vertices;
+    for (size_t i = 0; i < face.size(); ++i) assert(face[i].vertex == first_face[i].vertex);
+
+    // Position (100, -100, 100) becomes (100, 100, 100)
+    assert(first.find("\nv 100 100 100\n") != std::string::npos);
+    exporter.clear();
+}
@@ -1,6 +1,27 @@
 #include <aecl/scene/obj/import.hpp>
+#include <fstream>
 #include "../env.hpp"
 
+static const umbf::MaterialInfo &get_material_info(aecl::scene::obj::Importer &importer, const char *name)
+{
+    for (auto &material : importer.materials())
+    {
+        auto &info = static_cast<const umbf::MaterialInfo &>(*material->blocks.back());
+        if (info.name == name) return info;
+    }
+    assert(false);
+    abort();
+}
+
+static acul::vector<const umbf::MaterialRange *> get_ranges(const umbf::Object &object)
+{
+    acul::vector<const umbf::MaterialRange *> ranges;
+    for (auto &block : object.meta)
+        if (block->signature() == umbf::sign_block::material_range)
+            ranges.push_back(static_cast<const umbf::MaterialRange *>(block.get()));
+    return ranges;
+}
+
 void test_obj_import()
 {
     test_environment env;
@@ -10,4 +31,38 @@ void test_obj_import()
     auto state = importer.load();
     importer.clear();
     assert(state.success());
+
+    // Material switches inside a group and a group with a single material
+    acul::path dir(env.output_dir);
+    {
+        std::ofstream mtl((dir / "switches.mtl").str().c_str());
+        mtl << "newmtl red\nKd 1 0 0\nnewmtl blue\nKd 0 0 1\n";
+        std::ofstream obj((dir / "switches.obj").str().c_str());
+        obj << "mtllib switches.mtl\nv 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+               "g mixed\nusemtl red\nf 1 2 3\nusemtl blue\nf 1 3 4\nusemtl red\nf 1 2 4\n"
+               "g single\nusemtl blue\nf 1 2 3\nf 1 3 4\n";
+    }
+    aecl::scene::obj::Importer switches(dir / "switches.obj");
+    assert(switches.load().success());
+    auto &objects = switches.objects();
+    assert(objects.size() == 2 && objects[0].name == "mixed" && objects[1].name == "single");
+    auto &red = get_material_info(switches, "red");
+    auto &blue = get_material_info(switches, "blue");
+
+    // One range per material in order of first use, the range ids are the material info ids
+    auto mixed = get_ranges(objects[0]);
+    assert(mixed.size() == 2);
+    assert(mixed[0]->mat_id == red.id && mixed[0]->faces.size() == 2);
+    assert(mixed[0]->faces[0] == 0 && mixed[0]->faces[1] == 2);
+    assert(mixed[1]->mat_id == blue.id && mixed[1]->faces.size() == 1 && mixed[1]->faces[0] == 1);
+
+    // A material covering the whole group is stored without faces
+    auto single = get_ranges(objects[1]);
+    assert(single.size() == 1 && single[0]->mat_id == blue.id && single[0]->faces.empty());
+
+    // Assignments hold the ids of the objects using the material
+    assert(red.assignments.size() == 1 && red.assignments[0] == objects[0].id);
+    assert(blue.assignments.size() == 2 && blue.assignments[0] == objects[0].id &&
+           blue.assignments[1] == objects[1].id);
+    switches.clear();
 }
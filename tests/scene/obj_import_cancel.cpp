@@ -0,0 +1,50 @@
+#include <aecl/scene/obj/import.hpp>
+#include <aecl/status.hpp>
+#include <fstream>
+#include "../env.hpp"
+
+void test_obj_import_cancel()
+{
+    test_environment env;
+    create_test_environment(env);
+    acul::path path = acul::path(env.data_dir) / "cube.obj";
+
+    // Progress reaches the end of a completed import
+    aecl::ProgressToken token;
+    aecl::scene::obj::Importer importer(path);
+    importer.progress(&token);
+    assert(importer.load().success());
+    assert(token.progress() == 1.0f);
+    importer.clear();
+
+    // A cancelled import fails and keeps no partial results
+    token.reset();
+    token.cancel();
+    aecl::scene::obj::Importer cancelled(path);
+    cancelled.progress(&token);
+    assert(!cancelled.load().success());
+    assert(cancelled.objects().empty());
+    assert(!cancelled.error().empty());
+
+    // Cancelled from the progress callback once the first groups are built
+    acul::path groups_path = acul::path(env.output_dir) / "cancel_groups.obj";
+    {
+        std::ofstream stream(groups_path.str().c_str());
+        for (int g = 0; g < 64; ++g)
+        {
+            stream << "g group" << g << '\n';
+            for (int k = 0; k < 3; ++k) stream << "v " << g << ' ' << k << " 0\n";
+            stream << "f " << g * 3 + 1 << ' ' << g * 3 + 2 << ' ' << g * 3 + 3 << '\n';
+        }
+    }
+    token.reset();
+    token.callback = [&token](f32 value) {
+        if (value > 0.5f) token.cancel();
+    };
+    aecl::scene::obj::Importer mid(groups_path);
+    mid.progress(&token);
+    auto state = mid.load();
+    assert(!state.success() && state.code == AECL_OP_CODE_CANCELLED);
+    assert(token.progress() > 0.5f && token.progress() < 1.0f);
+    assert(mid.objects().empty() && mid.materials().empty());
+}
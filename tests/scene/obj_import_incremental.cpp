@@ -0,0 +1,73 @@
+#include <aecl/scene/obj/import.hpp>
+#include <fstream>
+#include "../env.hpp"
+
+// Three self-contained groups. Group b can be edited and can carry normals.
+static void write_groups(const acul::path &path, const char *b_vertex, bool b_normals)
+{
+    std::ofstream stream(path.str().c_str());
+    stream << "g a\nv 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+    stream << "g b\nv 0 0 1\n" << b_vertex << "\nv 0 1 1\n";
+    if (b_normals) stream << "vn 0 0 1\nf 4//1 5//1 6//1\n";
+    else stream << "f 4 5 6\n";
+    stream << "g c\nv 0 0 2\nv 1 0 2\nv 0 1 2\nf 7 8 9\n";
+}
+
+static const umbf::mesh::Mesh *get_mesh(const umbf::Object &object)
+{
+    return static_cast<const umbf::mesh::Mesh *>(object.meta.front().get());
+}
+
+void test_obj_import_incremental()
+{
+    test_environment env;
+    create_test_environment(env);
+    acul::path path = acul::path(env.data_dir) / "cube.obj";
+    aecl::scene::obj::ImportManifest manifest;
+
+    aecl::scene::obj::Importer first(path);
+    first.manifest(&manifest);
+    assert(first.load().success());
+    assert(manifest.reused == 0);
+    assert(manifest.groups.size() == first.objects().size());
+    auto mesh = manifest.groups.front().mesh;
+    assert(mesh);
+
+    // Unchanged groups reuse the previous meshes and object ids
+    aecl::scene::obj::Importer second(path);
+    second.manifest(&manifest);
+    assert(second.load().success());
+    assert(manifest.reused == manifest.groups.size());
+    assert(manifest.groups.front().mesh == mesh);
+    assert(second.objects().front().id == first.objects().front().id);
+
+    // Only the edited group is rebuilt
+    acul::path groups_path = acul::path(env.output_dir) / "incremental.obj";
+    aecl::scene::obj::ImportManifest groups_manifest;
+    write_groups(groups_path, "v 1 0 1", false);
+    aecl::scene::obj::Importer original(groups_path);
+    original.manifest(&groups_manifest);
+    assert(original.load().success());
+    assert(original.objects().size() == 3);
+
+    write_groups(groups_path, "v 2 0 1", false);
+    aecl::scene::obj::Importer edited(groups_path);
+    edited.manifest(&groups_manifest);
+    assert(edited.load().success());
+    assert(groups_manifest.reused == 2);
+    auto &before = original.objects();
+    auto &after = edited.objects();
+    assert(after.size() == 3);
+    assert(get_mesh(after[0]) == get_mesh(before[0]) && after[0].id == before[0].id);
+    assert(get_mesh(after[1]) != get_mesh(before[1]) && after[1].id != before[1].id);
+    assert(get_mesh(after[2]) == get_mesh(before[2]) && after[2].id == before[2].id);
+    assert(get_mesh(after[1])->model.aabb.max.x == 2.0f);
+
+    // Normals in one group change how every group is indexed, so nothing is reused
+    write_groups(groups_path, "v 2 0 1", true);
+    aecl::scene::obj::Importer with_normals(groups_path);
+    with_normals.manifest(&groups_manifest);
+    assert(with_normals.load().success());
+    assert(groups_manifest.reused == 0);
+    for (size_t i = 0; i < 3; ++i) assert(get_mesh(with_normals.objects()[i]) != get_mesh(after[i]));
+}
@@ -0,0 +1,62 @@
+#include <aecl/scene/obj/import.hpp>
+#include <fstream>
+#include "../env.hpp"
+
+static aecl::scene::obj::Preview load_preview(const acul::path &path, size_t max_points)
+{
+    aecl::scene::obj::Importer importer(path);
+    aecl::scene::obj::Preview preview;
+    assert(importer.load_preview(preview, max_points).success());
+    return preview;
+}
+
+void test_obj_import_preview()
+{
+    test_environment env;
+    create_test_environment(env);
+    aecl::scene::obj::Importer importer(acul::path(env.data_dir) / "cube.obj");
+    aecl::scene::obj::Preview preview;
+    assert(importer.load_preview(preview).success());
+    assert(preview.points.size() == 8);
+    assert(!preview.groups.empty());
+    auto &group = preview.groups.front();
+    assert(group.min.x == -100.0f && group.max.x == 100.0f);
+
+    // Full import in the background replaces the preview
+    auto future = importer.load_async();
+    assert(future.get().success());
+    assert(!importer.objects().empty());
+    importer.clear();
+
+    // The last line has no newline and is parsed within the file
+    acul::path path = acul::path(env.output_dir) / "preview_tail.obj";
+    {
+        std::ofstream stream(path.str().c_str(), std::ios::binary);
+        stream << "g tail\nv 1 2 3";
+    }
+    auto tail = load_preview(path, 16);
+    assert(tail.points.size() == 1 && tail.points.front() == amal::vec3(1.0f, 2.0f, 3.0f));
+
+    // Two groups over several chunks: group a continues across the chunk boundaries, the points are strided
+    // and the overshoot of the stride estimate is thinned to max_points
+    path = acul::path(env.output_dir) / "preview_large.obj";
+    constexpr int half = 150000;
+    {
+        std::ofstream stream(path.str().c_str(), std::ios::binary);
+        stream << "g a\n";
+        for (int i = 0; i < half; ++i) stream << "v " << i << " 1 2\n";
+        stream << "g b\n";
+        for (int i = 1; i <= half; ++i) stream << "v " << -i << " 1 2\n";
+    }
+    constexpr size_t max_points = 1000;
+    auto large = load_preview(path, max_points);
+    assert(large.points.size() == max_points);
+    for (auto &point : large.points) assert(point.y == 1.0f && point.z == 2.0f);
+    for (size_t i = 1; i < max_points / 3; ++i) assert(large.points[i].x > large.points[i - 1].x);
+    assert(large.groups.size() == 2);
+    auto &a = large.groups[0];
+    auto &b = large.groups[1];
+    assert(a.name == "a" && b.name == "b");
+    assert(a.min.x == 0.0f && a.max.x > half * 0.9f && a.max.x < half);
+    assert(b.max.x < 0.0f && b.min.x < -half * 0.9f);
+}
@@ -0,0 +1,21 @@
+#include <aecl/scene/obj/import.hpp>
+#include "../env.hpp"
+
+void test_obj_import_stats()
+{
+    test_environment env;
+    create_test_environment(env);
+    aecl::ImportStats stats;
+    aecl::scene::obj::Importer importer(acul::path(env.data_dir) / "cube.obj");
+    importer.stats(&stats);
+    auto state = importer.load();
+    importer.clear();
+    assert(state.success());
+    assert(stats.bytes_read > 0 && stats.lines > 0);
+    assert(stats.faces == 6 && stats.vertices == 8);
+    assert(stats.unique_vertices >= stats.vertices);
+    assert(!stats.events.empty());
+    assert(stats.peak_memory > 0);
+    auto trace = stats.to_chrome_trace();
+    assert(trace.find("\"name\":\"parse\"") != acul::string::npos);
+}
@@ -0,0 +1,82 @@
+#include <aecl/scene/ply/export.hpp>
+#include <aecl/scene/ply/import.hpp>
+#include <fstream>
+#include "../env.hpp"
+#include "common.hpp"
+
+static void check_cube(const umbf::mesh::Model &model, const umbf::mesh::Model &src, bool points)
+{
+    assert(model.vertices.size() == src.vertices.size());
+    for (size_t i = 0; i < model.vertices.size(); ++i)
+    {
+        assert(model.vertices[i].pos == src.vertices[i].pos);
+        assert(model.vertices[i].normal == src.vertices[i].normal);
+        assert(model.vertices[i].uv == src.vertices[i].uv);
+    }
+    assert(model.aabb.min == amal::vec3(-100.0f) && model.aabb.max == amal::vec3(100.0f));
+    if (points)
+    {
+        assert(model.faces.empty() && model.indices.empty());
+        return;
+    }
+    assert(model.faces.size() == src.indices.size() / 3);
+    assert(model.indices == src.indices);
+}
+
+void test_ply()
+{
+    test_environment env;
+    create_test_environment(env);
+    using namespace aecl::scene;
+    acul::vector<umbf::Object> source;
+    create_objects(source);
+    auto &src = static_cast<umbf::mesh::Mesh &>(*source.front().meta.front()).model;
+
+    const ply::Format formats[] = {ply::Format::ascii, ply::Format::binary_little_endian,
+                                   ply::Format::binary_big_endian};
+    for (auto format : formats)
+    {
+        for (bool points : {false, true})
+        {
+            acul::path path = acul::path(env.output_dir) / (points ? "points.ply" : "export.ply");
+            ply::Exporter exporter(path);
+            exporter.format = format;
+            exporter.material_flags = MaterialExportFlags::none;
+            exporter.mesh_flags = MeshExportFlagBits::export_uv | MeshExportFlagBits::export_normals |
+                                  MeshExportFlagBits::export_triangulated;
+            exporter.objects = source;
+            if (points)
+            {
+                // Vertex-only object
+                auto mesh = acul::make_shared<umbf::mesh::Mesh>();
+                mesh->model.vertices = src.vertices;
+                exporter.objects.front().meta.front() = mesh;
+            }
+            assert(exporter.save().success());
+
+            ply::Importer importer(path);
+            assert(importer.load().success());
+            assert(importer.objects().size() == 1);
+            auto &object = importer.objects().front();
+            assert(object.name == (points ? "points" : "export"));
+            check_cube(static_cast<umbf::mesh::Mesh &>(*object.meta.front()).model, src, points);
+        }
+    }
+
+    // Element counts beyond the data size are rejected before the records are allocated
+    const char *headers[] = {"ply\nformat binary_little_endian 1.0\nelement vertex 4000000000\nproperty float x\n"
+                             "property float y\nproperty float z\nend_header\n",
+                             "ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\nelement face 4000000000\n"
+                             "property list uchar int vertex_indices\nend_header\n0\n"};
+    acul::path path = acul::path(env.output_dir) / "oversized.ply";
+    for (auto *header : headers)
+    {
+        {
+            std::ofstream stream(path.str().c_str(), std::ios::binary);
+            stream << header << "0 0 0 0 0 0 0 0 0 0 0 0\n";
+        }
+        ply::Importer importer(path);
+        assert(!importer.load().success());
+        assert(!importer.error().empty());
+    }
+}
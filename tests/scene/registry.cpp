@@ -0,0 +1,93 @@
+#include <aecl/image/import.hpp>
+#include <aecl/scene/gltf/export.hpp>
+#include <aecl/scene/ply/export.hpp>
+#include <aecl/scene/ply/import.hpp>
+#include <aecl/scene/registry.hpp>
+#include <aecl/scene/stl/import.hpp>
+#include <cstring>
+#include <fstream>
+#include "../env.hpp"
+#include "common.hpp"
+
+namespace
+{
+    class XYZLoader final : public aecl::scene::ILoader
+    {
+    public:
+        XYZLoader(const acul::string &path) : ILoader(path) {}
+
+        acul::op_result read_source() override { return acul::make_op_success(); }
+        void build_geometry() override {}
+        acul::op_result load_materials() override { return acul::make_op_success(); }
+    };
+
+    aecl::scene::ILoader *create_xyz(const acul::string &path) { return acul::alloc<XYZLoader>(path); }
+
+    bool sniff_xyz(const u8 *data, size_t size) { return size >= 4 && memcmp(data, "XYZ1", 4) == 0; }
+
+    void write_text(const acul::path &path, const char *text)
+    {
+        std::ofstream stream(path.str().c_str(), std::ios::binary);
+        stream << text;
+    }
+} // namespace
+
+void test_codec_registry()
+{
+    test_environment env;
+    create_test_environment(env);
+
+    // Built-in image formats are found by extension in any case and by signature
+    using aecl::image::Type;
+    static_assert(aecl::image::get_type_by_extension(".jpeg") == Type::jpeg);
+    assert(aecl::image::get_type_by_extension(".TIF") == Type::tiff);
+    assert(aecl::image::get_type_by_extension(".obj") == Type::unknown);
+    const u8 png[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    assert(aecl::image::get_type_by_signature(png, sizeof(png)) == Type::png);
+    const u8 webp[] = {'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'E', 'B', 'P'};
+    assert(aecl::image::get_type_by_signature(webp, sizeof(webp)) == Type::webp);
+    assert(aecl::image::get_type_by_signature(png, 4) == Type::unknown);
+
+    // A PLY file with a wrong extension is identified by its header
+    acul::vector<umbf::Object> objects;
+    create_objects(objects);
+    acul::path ply_path = acul::path(env.output_dir) / "misnamed.obj";
+    {
+        aecl::scene::ply::Exporter exporter(ply_path);
+        exporter.objects = objects;
+        assert(exporter.save().success());
+    }
+    auto *loader = aecl::scene::get_importer_by_path(ply_path);
+    assert(dynamic_cast<aecl::scene::ply::Importer *>(loader));
+    assert(loader->load().success() && loader->objects().size() == 1);
+    acul::release(loader);
+
+    acul::path stl_path = acul::path(env.output_dir) / "triangle";
+    write_text(stl_path, "solid t\n facet normal 0 0 1\n  outer loop\n   vertex 0 0 0\n   vertex 1 0 0\n"
+                         "   vertex 0 1 0\n  endloop\n endfacet\nendsolid t\n");
+    loader = aecl::scene::get_importer_by_path(stl_path);
+    assert(dynamic_cast<aecl::scene::stl::Importer *>(loader));
+    acul::release(loader);
+
+    auto *exporter = aecl::scene::get_exporter_by_path("scene.GLB");
+    assert(dynamic_cast<aecl::scene::gltf::Exporter *>(exporter));
+    acul::release(exporter);
+    assert(!aecl::scene::get_exporter_by_path("scene.stl"));
+
+    // Runtime codecs are found by extension and by their sniffer
+    acul::path xyz_path = acul::path(env.output_dir) / "points.bin";
+    write_text(xyz_path, "XYZ1 0 0 0\n");
+    assert(!aecl::scene::get_importer_by_path(xyz_path));
+    aecl::scene::Codec codec;
+    codec.name = "xyz";
+    codec.extensions = {".xyz"};
+    codec.sniff = sniff_xyz;
+    codec.create_loader = create_xyz;
+    aecl::scene::register_codec(codec);
+    loader = aecl::scene::get_importer_by_path(xyz_path);
+    assert(dynamic_cast<XYZLoader *>(loader));
+    acul::release(loader);
+    loader = aecl::scene::get_importer_by_path("missing.XYZ");
+    assert(dynamic_cast<XYZLoader *>(loader));
+    acul::release(loader);
+}
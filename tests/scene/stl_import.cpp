@@ -0,0 +1,72 @@
+#include <aecl/scene/stl/import.hpp>
+#include <amal/geometric.hpp>
+#include <cstring>
+#include <fstream>
+#include "../env.hpp"
+#include "common.hpp"
+
+static void check_cube(aecl::scene::stl::Importer &importer, const char *name)
+{
+    assert(importer.load().success());
+    assert(importer.objects().size() == 1);
+    auto &object = importer.objects().front();
+    assert(object.name == name);
+    auto &model = static_cast<umbf::mesh::Mesh &>(*object.meta.front()).model;
+    // Corners shared by the two triangles of a side are welded, sides keep their own normals
+    assert(model.faces.size() == 12 && model.indices.size() == 36);
+    assert(model.group_count == 8 && model.vertices.size() == 24);
+    assert(model.aabb.min == amal::vec3(-100.0f) && model.aabb.max == amal::vec3(100.0f));
+    for (auto &face : model.faces)
+        for (auto &ref : face.vertices) assert(model.vertices[ref.vertex].normal == face.normal);
+}
+
+void test_stl_import()
+{
+    test_environment env;
+    create_test_environment(env);
+    acul::vector<umbf::Object> objects;
+    create_objects(objects);
+    auto &src = static_cast<umbf::mesh::Mesh &>(*objects.front().meta.front()).model;
+    const size_t count = src.indices.size() / 3;
+
+    acul::path binary_path = acul::path(env.output_dir) / "cube.stl";
+    {
+        std::ofstream stream(binary_path.str().c_str(), std::ios::binary);
+        char header[80] = "solid binary header";
+        const u32 triangles = count;
+        stream.write(header, sizeof(header));
+        stream.write(reinterpret_cast<const char *>(&triangles), sizeof(triangles));
+        for (size_t t = 0; t < count; ++t)
+        {
+            f32 values[12];
+            const amal::vec3 normal = src.vertices[src.indices[t * 3]].normal;
+            memcpy(values, &normal, sizeof(f32) * 3);
+            for (int k = 0; k < 3; ++k) memcpy(values + 3 + k * 3, &src.vertices[src.indices[t * 3 + k]].pos, 12);
+            const u16 attributes = 0;
+            stream.write(reinterpret_cast<const char *>(values), sizeof(values));
+            stream.write(reinterpret_cast<const char *>(&attributes), sizeof(attributes));
+        }
+    }
+    aecl::scene::stl::Importer binary(binary_path);
+    check_cube(binary, "cube");
+
+    acul::path text_path = acul::path(env.output_dir) / "cube_text.stl";
+    {
+        std::ofstream stream(text_path.str().c_str());
+        stream << "solid box\n";
+        for (size_t t = 0; t < count; ++t)
+        {
+            auto &n = src.vertices[src.indices[t * 3]].normal;
+            stream << "  facet normal " << n.x << ' ' << n.y << ' ' << n.z << "\n    outer loop\n";
+            for (int k = 0; k < 3; ++k)
+            {
+                auto &p = src.vertices[src.indices[t * 3 + k]].pos;
+                stream << "      vertex " << p.x << ' ' << p.y << ' ' << p.z << '\n';
+            }
+            stream << "    endloop\n  endfacet\n";
+        }
+        stream << "endsolid box\n";
+    }
+    aecl::scene::stl::Importer text(text_path);
+    check_cube(text, "box");
+}